@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -9,9 +9,12 @@
 #include "failure.hpp"
 #include "pipeline.hpp"
 
+#include "dep0/arena.hpp"
 #include "dep0/match.hpp"
 #include "dep0/ast/pretty_print.hpp"
+#include "dep0/jit/run.hpp"
 #include "dep0/link/link.hpp"
+#include "dep0/llvmgen/func_cache.hpp"
 
 #include <llvm/ADT/Triple.h>
 #include <llvm/IR/LLVMContext.h>
@@ -19,166 +22,449 @@
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Support/TargetRegistry.h>
 #include <llvm/Support/WithColor.h>
 #include <llvm/Support/ToolOutputFile.h>
+#include <llvm/Target/TargetMachine.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <sstream>
+#include <thread>
+#include <type_traits>
 
 static std::filesystem::path append_extension(std::filesystem::path f, std::string_view const extension)
 {
     return extension.starts_with('.') ? f.concat(extension) : f.concat(".").concat(extension);
 }
 
-int run(job_t const& job)
+/**
+ * Private LLVM state of a worker thread.
+ * Neither `llvm::LLVMContext` nor `llvm::TargetMachine` can be shared between threads,
+ * so every worker other than the main thread runs on its own copy of the target machine.
+ */
+struct llvm_worker_t
+{
+    llvm::LLVMContext llvm_context;
+    std::unique_ptr<llvm::TargetMachine> owned_machine;
+    std::reference_wrapper<llvm::TargetMachine> machine;
+
+    llvm_worker_t(llvm::TargetMachine& main_machine, std::size_t const worker_id) :
+        owned_machine(
+            worker_id == 0ul
+            ? nullptr
+            : std::unique_ptr<llvm::TargetMachine>(main_machine.getTarget().createTargetMachine(
+                main_machine.getTargetTriple().getTriple(),
+                main_machine.getTargetCPU(),
+                main_machine.getTargetFeatureString(),
+                main_machine.Options,
+                main_machine.getRelocationModel(),
+                main_machine.getCodeModel(),
+                main_machine.getOptLevel()))),
+        machine(owned_machine ? *owned_machine : main_machine)
+    { }
+};
+
+/**
+ * Runs `process(state, file)` for each input file on up to `jobs` worker threads, including the calling thread,
+ * and returns the results in input order.
+ * If `ast_arena` is set, each file is processed with its own `dep0::arena_t` active.
+ *
+ * Each worker builds its own private state by calling `make_state(worker_id)` once,
+ * where the calling thread is always worker 0.
+ * Files are picked up in input order and, as soon as one fails, no further file is picked up;
+ * this guarantees that every file before the first failure (in input order) has been processed,
+ * so the caller can report diagnostics exactly as if all files had been processed one after the other.
+ * Entries after the first failure may be empty.
+ */
+template <typename MakeState, typename Process>
+static auto process_files(
+    std::size_t const jobs,
+    bool const ast_arena,
+    std::vector<std::filesystem::path> const& input_files,
+    MakeState const& make_state,
+    Process const& process)
+{
+    using state_t = std::invoke_result_t<MakeState const&, std::size_t>;
+    using result_t = std::invoke_result_t<Process const&, state_t&, std::filesystem::path const&>;
+    std::vector<std::optional<result_t>> results(input_files.size());
+    std::atomic<std::size_t> next_file = 0ul;
+    std::atomic<bool> failed = false;
+    auto const work = [&] (std::size_t const worker_id)
+    {
+        auto state = make_state(worker_id);
+        // check for failures before picking up the next file, so that every file picked up is also processed
+        while (not failed)
+        {
+            auto const i = next_file++;
+            if (i >= input_files.size())
+                break;
+            auto arena = std::optional<dep0::arena_t>{};
+            auto const scope = ast_arena ? dep0::arena_scope_t(arena.emplace()) : dep0::arena_scope_t(nullptr);
+            if (not results[i].emplace(process(state, input_files[i])))
+                failed = true;
+        }
+    };
+    auto const max_jobs = jobs == 0ul ? std::max(1u, std::thread::hardware_concurrency()) : jobs;
+    auto const num_workers = std::min(max_jobs, input_files.size());
+    {
+        std::vector<std::jthread> workers;
+        for (auto const worker_id: std::views::iota(1ul, std::max(num_workers, 1ul)))
+            workers.emplace_back(work, worker_id);
+        work(0ul);
+    } // joins all workers, so from now on the results are only accessed by the calling thread
+    return results;
+}
+
+/**
+ * Reports the results of `process_files()` in input order, calling `report(file, value)` on each success,
+ * until the first failure, which is printed to stderr.
+ *
+ * @return 0 if all files were processed successfully; 1 otherwise.
+ */
+template <typename T, typename Report>
+static int report_in_order(
+    std::vector<std::filesystem::path> const& input_files,
+    std::vector<std::optional<dep0::expected<T>>>& results,
+    Report const& report)
+{
+    for (auto const i: std::views::iota(0ul, input_files.size()))
+    {
+        assert(results[i] and "all files before the first failure must have been processed");
+        if (*results[i])
+            report(input_files[i], std::move(**results[i]));
+        else
+            return failure(input_files[i], results[i]->error());
+    }
+    return 0;
+}
+
+static int run_pipelines(job_t const& job)
 {
+    // shared by all workers, which is safe because each cache entry is written to a temporary file first
+    auto const func_cache =
+        job.cache_dir ? std::optional<dep0::llvmgen::func_cache_t>(*job.cache_dir) : std::nullopt;
+    // the prediction cache of the parser is shared by all threads, so warm it up before they start
+    if (job.jobs != 1ul)
+        dep0::parser::warm_up(job.parse_options);
     return dep0::match(
         job.value,
-        [] (job_t::typecheck_t const& job)
+        [&] (job_t::typecheck_t const& x)
         {
-            auto const pipeline =
-                build_pipeline(
-                    parser_stage_t{},
-                    typecheck_stage_t{
-                        .no_prelude = job.no_prelude
+            auto results =
+                process_files(
+                    job.jobs,
+                    job.ast_arena,
+                    x.input_files,
+                    [&] (std::size_t)
+                    {
+                        return build_pipeline(
+                            parser_stage_t{job.parse_options},
+                            typecheck_stage_t{
+                                .no_prelude = x.no_prelude,
+                                .check_options = job.check_options,
+                                .profile = job.typecheck_profile
+                            });
+                    },
+                    [] (typecheck_pipeline_t const& pipeline, std::filesystem::path const& f)
+                    -> dep0::expected<std::true_type>
+                    {
+                        if (auto result = pipeline.run(f))
+                            return std::true_type{};
+                        else
+                            return std::move(result.error());
                     });
-            for (auto const& f: job.input_files)
-                if (auto const result = pipeline.run(f))
+            return report_in_order(
+                x.input_files,
+                results,
+                [] (std::filesystem::path const& f, std::true_type)
+                {
                     llvm::WithColor::note(llvm::outs(), f.native()) << "typechecks correctly" << '\n';
-                else
-                    return failure(f, result.error());
-            return 0;
+                });
         },
-        [] (job_t::print_ast_t const& job)
+        [&] (job_t::print_ast_t const& x)
         {
-            auto const pipeline =
-                build_pipeline(
-                    parser_stage_t{},
-                    typecheck_stage_t{
-                        .no_prelude = job.no_prelude
+            auto results =
+                process_files(
+                    job.jobs,
+                    job.ast_arena,
+                    x.input_files,
+                    [&] (std::size_t)
+                    {
+                        return build_pipeline(
+                            parser_stage_t{job.parse_options},
+                            typecheck_stage_t{
+                                .no_prelude = x.no_prelude,
+                                .check_options = job.check_options,
+                                .profile = job.typecheck_profile
+                            },
+                            transform_stage_t{
+                                .skip = x.skip_transformations
+                            });
                     },
-                    transform_stage_t{
-                        .skip = job.skip_transformations
+                    [] (transform_pipeline_t const& pipeline, std::filesystem::path const& f)
+                    -> dep0::expected<std::string>
+                    {
+                        // print into a string, so that ASTs are printed to screen in input order
+                        if (auto result = pipeline.run(f))
+                        {
+                            std::ostringstream os;
+                            dep0::ast::pretty_print(os, *result);
+                            return os.str();
+                        }
+                        else
+                            return std::move(result.error());
                     });
-            for (auto const& f: job.input_files)
-                if (auto const result = pipeline.run(f))
-                    dep0::ast::pretty_print(std::cout, *result) << std::endl;
-                else
-                    return failure(f, result.error());
-            return 0;
+            return report_in_order(
+                x.input_files,
+                results,
+                [] (std::filesystem::path const&, std::string const& ast)
+                {
+                    std::cout << ast << std::endl;
+                });
         },
-        [] (job_t::emit_llvm_t const& job)
+        [&] (job_t::emit_llvm_t const& x)
         {
-            if (job.out_file_name and job.input_files.size() > 1)
+            if (x.out_file_name and x.input_files.size() > 1)
                 return failure("cannot have multiple input files with a single output file name");
-            llvm::LLVMContext llvm_context;
-            auto const pipeline =
-                build_pipeline(
-                    parser_stage_t{},
-                    typecheck_stage_t{
-                        .no_prelude = job.no_prelude
-                    },
-                    transform_stage_t{
-                        .skip = job.skip_transformations
+            auto results =
+                process_files(
+                    job.jobs,
+                    job.ast_arena,
+                    x.input_files,
+                    [&] (std::size_t const worker_id)
+                    {
+                        return std::make_unique<llvm_worker_t>(x.machine.get(), worker_id);
                     },
-                    llvmgen_stage_t{
-                        .machine = job.machine,
-                        .llvm_context = std::ref(llvm_context),
-                        .unverified = job.unverified
+                    [&] (std::unique_ptr<llvm_worker_t> const& worker, std::filesystem::path const& f)
+                    -> dep0::expected<std::true_type>
+                    {
+                        auto const pipeline =
+                            build_pipeline(
+                                parser_stage_t{job.parse_options},
+                                typecheck_stage_t{
+                                    .no_prelude = x.no_prelude,
+                                    .check_options = job.check_options,
+                                    .profile = job.typecheck_profile
+                                },
+                                transform_stage_t{
+                                    .skip = x.skip_transformations
+                                },
+                                llvmgen_stage_t{
+                                    .machine = worker->machine,
+                                    .llvm_context = std::ref(worker->llvm_context),
+                                    .unverified = x.unverified,
+                                    .func_cache = func_cache ? &*func_cache : nullptr
+                                },
+                                optimize_stage_t{
+                                    .machine = worker->machine,
+                                    // unverified IR code might crash LLVM, so better not to optimize it
+                                    .level = x.unverified ? dep0::compile::opt_level_t::O0 : x.opt_level
+                                });
+                        auto result = pipeline.run(f);
+                        if (not result)
+                            return std::move(result.error());
+                        std::error_code ec;
+                        auto const output_file = x.out_file_name ? *x.out_file_name : append_extension(f, ".ll");
+                        auto out = llvm::ToolOutputFile(output_file.native(), ec, llvm::sys::fs::OF_Text);
+                        if (ec)
+                            return dep0::error_t("error opening output file");
+                        llvm::legacy::PassManager pass_manager;
+                        pass_manager.add(llvm::createPrintModulePass(out.os()));
+                        pass_manager.run(result->get());
+                        out.keep();
+                        return std::true_type{};
                     });
-            for (auto const& f: job.input_files)
-                if (auto result = pipeline.run(f))
-                {
-                    std::error_code ec;
-                    auto const output_file = job.out_file_name ? *job.out_file_name : append_extension(f, ".ll");
-                    auto out = llvm::ToolOutputFile(output_file.native(), ec, llvm::sys::fs::OF_Text);
-                    if (ec)
-                        return failure(f, "error opening output file");
-                    llvm::legacy::PassManager pass_manager;
-                    pass_manager.add(llvm::createPrintModulePass(out.os()));
-                    pass_manager.run(result->get());
-                    out.keep();
-                }
-                else
-                    return failure(f, result.error());
-            return 0;
+            return report_in_order(x.input_files, results, [] (std::filesystem::path const&, std::true_type) { });
         },
-        [] (job_t::compile_only_t const& job)
+        [&] (job_t::compile_only_t const& x)
         {
-            if (job.out_file_name and job.input_files.size() > 1)
+            if (x.out_file_name and x.input_files.size() > 1)
                 return failure("cannot have multiple input files with a single output file name");
-            llvm::LLVMContext llvm_context;
-            auto const pipeline =
-                build_pipeline(
-                    parser_stage_t{},
-                    typecheck_stage_t{
-                        .no_prelude = job.no_prelude
-                    },
-                    transform_stage_t{
-                        .skip = job.skip_transformations
+            auto results =
+                process_files(
+                    job.jobs,
+                    job.ast_arena,
+                    x.input_files,
+                    [&] (std::size_t const worker_id)
+                    {
+                        return std::make_unique<llvm_worker_t>(x.machine.get(), worker_id);
                     },
-                    llvmgen_stage_t{
-                        .machine = job.machine,
-                        .llvm_context = std::ref(llvm_context),
-                        .unverified = false
-                    },
-                    compile_stage_t{
-                        .machine = job.machine,
-                        .out_file_type = job.file_type
+                    [&] (std::unique_ptr<llvm_worker_t> const& worker, std::filesystem::path const& f)
+                    -> dep0::expected<std::true_type>
+                    {
+                        auto const pipeline =
+                            build_pipeline(
+                                parser_stage_t{job.parse_options},
+                                typecheck_stage_t{
+                                    .no_prelude = x.no_prelude,
+                                    .check_options = job.check_options,
+                                    .profile = job.typecheck_profile
+                                },
+                                transform_stage_t{
+                                    .skip = x.skip_transformations
+                                },
+                                llvmgen_stage_t{
+                                    .machine = worker->machine,
+                                    .llvm_context = std::ref(worker->llvm_context),
+                                    .unverified = false,
+                                    .func_cache = func_cache ? &*func_cache : nullptr
+                                },
+                                optimize_stage_t{
+                                    .machine = worker->machine,
+                                    .level = x.opt_level,
+                                    .dump_ir = x.dump_optimized_ir
+                                },
+                                compile_stage_t{
+                                    .machine = worker->machine,
+                                    .out_file_type = x.file_type
+                                });
+                        auto obj = pipeline.run(f);
+                        if (not obj)
+                            return std::move(obj.error());
+                        auto const dest =
+                            x.out_file_name
+                            ? *x.out_file_name
+                            : append_extension(f, x.file_type == llvm::CGFT_AssemblyFile ? ".s" : ".o");
+                        return obj->rename_and_keep(dest);
                     });
-            for (auto const& f: job.input_files)
-                if (auto obj = pipeline.run(f))
-                {
-                    auto const dest =
-                        job.out_file_name
-                        ? *job.out_file_name
-                        : append_extension(f, job.file_type == llvm::CGFT_AssemblyFile ? ".s" : ".o");
-                    if (auto const rename = obj->rename_and_keep(dest); not rename)
-                        return failure(f, rename.error());
-                }
-                else
-                    return failure(f, obj.error());
-            return 0;
+            return report_in_order(x.input_files, results, [] (std::filesystem::path const&, std::true_type) { });
         },
-        [] (job_t::compile_and_link_t const& job)
+        [&] (job_t::compile_and_link_t const& x)
         {
-            llvm::LLVMContext llvm_context;
-            auto const pipeline =
-                build_pipeline(
-                    parser_stage_t{},
-                    typecheck_stage_t{
-                        .no_prelude = job.no_prelude
-                    },
-                    transform_stage_t{
-                        .skip = job.skip_transformations
-                    },
-                    llvmgen_stage_t{
-                        .machine = job.machine,
-                        .llvm_context = std::ref(llvm_context),
-                        .unverified = false
+            auto results =
+                process_files(
+                    job.jobs,
+                    job.ast_arena,
+                    x.input_files,
+                    [&] (std::size_t const worker_id)
+                    {
+                        return std::make_unique<llvm_worker_t>(x.machine.get(), worker_id);
                     },
-                    compile_stage_t{
-                        .machine = job.machine
+                    [&] (std::unique_ptr<llvm_worker_t> const& worker, std::filesystem::path const& f)
+                    {
+                        auto const pipeline =
+                            build_pipeline(
+                                parser_stage_t{job.parse_options},
+                                typecheck_stage_t{
+                                    .no_prelude = x.no_prelude,
+                                    .check_options = job.check_options,
+                                    .profile = job.typecheck_profile
+                                },
+                                transform_stage_t{
+                                    .skip = x.skip_transformations
+                                },
+                                llvmgen_stage_t{
+                                    .machine = worker->machine,
+                                    .llvm_context = std::ref(worker->llvm_context),
+                                    .unverified = false,
+                                    .func_cache = func_cache ? &*func_cache : nullptr
+                                },
+                                optimize_stage_t{
+                                    .machine = worker->machine,
+                                    .level = x.opt_level,
+                                    .dump_ir = x.dump_optimized_ir
+                                },
+                                compile_stage_t{
+                                    .machine = worker->machine
+                                });
+                        return pipeline.run(f);
                     });
             std::vector<dep0::temp_file_t> obj_files; // automatically delete object files after linking
             std::vector<std::filesystem::path> obj_file_paths;
-            for (auto const& f: job.input_files)
-                if (auto obj = pipeline.run(f))
-                {
-                    obj_file_paths.push_back(obj->path());
-                    obj_files.push_back(std::move(*obj));
-                }
-                else
-                    return failure(f, obj.error());
+            if (auto const ok =
+                    report_in_order(
+                        x.input_files,
+                        results,
+                        [&] (std::filesystem::path const&, dep0::temp_file_t obj)
+                        {
+                            obj_file_paths.push_back(obj.path());
+                            obj_files.push_back(std::move(obj));
+                        });
+                ok != 0)
+                return ok;
             auto const host_triple = llvm::Triple(llvm::sys::getProcessTriple());
             auto result =
                 dep0::link::link(
                     obj_file_paths,
-                    job.machine.get().getTargetTriple(),
-                    host_triple);
+                    x.machine.get().getTargetTriple(),
+                    host_triple,
+                    x.linker);
             if (not result)
-                return failure(job.out_file_name, "link error", result.error());
-            if (auto const rename = result->rename_and_keep(job.out_file_name); not rename)
-                return failure(job.out_file_name, "link error", rename.error());
+                return failure(x.out_file_name, "link error", result.error());
+            if (auto const rename = result->rename_and_keep(x.out_file_name); not rename)
+                return failure(x.out_file_name, "link error", rename.error());
             return 0;
+        },
+        [&] (job_t::run_t const& x)
+        {
+            auto results =
+                process_files(
+                    job.jobs,
+                    job.ast_arena,
+                    x.input_files,
+                    [&] (std::size_t const worker_id)
+                    {
+                        return std::make_unique<llvm_worker_t>(x.machine.get(), worker_id);
+                    },
+                    [&] (std::unique_ptr<llvm_worker_t> const& worker, std::filesystem::path const& f)
+                    -> dep0::expected<dep0::jit::module_t>
+                    {
+                        // the JIT takes ownership of the context of each module, so it cannot be the worker's one
+                        auto context = std::make_unique<llvm::LLVMContext>();
+                        auto const pipeline =
+                            build_pipeline(
+                                parser_stage_t{job.parse_options},
+                                typecheck_stage_t{
+                                    .no_prelude = x.no_prelude,
+                                    .check_options = job.check_options,
+                                    .profile = job.typecheck_profile
+                                },
+                                transform_stage_t{
+                                    .skip = x.skip_transformations
+                                },
+                                llvmgen_stage_t{
+                                    .machine = worker->machine,
+                                    .llvm_context = std::ref(*context),
+                                    .unverified = false,
+                                    .func_cache = func_cache ? &*func_cache : nullptr
+                                },
+                                optimize_stage_t{
+                                    .machine = worker->machine,
+                                    .level = x.opt_level
+                                });
+                        auto module = pipeline.run(f);
+                        if (not module)
+                            return std::move(module.error());
+                        return dep0::jit::module_t{std::move(context), std::move(*module)};
+                    });
+            std::vector<dep0::jit::module_t> modules;
+            if (auto const ok =
+                    report_in_order(
+                        x.input_files,
+                        results,
+                        [&] (std::filesystem::path const&, dep0::jit::module_t m)
+                        {
+                            modules.push_back(std::move(m));
+                        });
+                ok != 0)
+                return ok;
+            auto const exit_code = dep0::jit::run(std::move(modules), x.machine.get(), x.args);
+            if (not exit_code)
+                return failure(x.input_files.front(), "JIT error", exit_code.error());
+            return *exit_code;
         });
 }
+
+int run(job_t const& job)
+{
+    auto const result = run_pipelines(job);
+    if (job.typecheck_profile)
+        job.typecheck_profile->print(llvm::errs());
+    return result;
+}
@@ -1,17 +1,26 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
  */
 #pragma once
 
+#include "typecheck_profile.hpp"
+
+#include "dep0/compile/optimize.hpp"
+#include "dep0/link/link.hpp"
+#include "dep0/parser/parse.hpp"
+#include "dep0/typecheck/check.hpp"
+
 #include <llvm/Support/CodeGen.h>
 #include <llvm/Target/TargetMachine.h>
 
 #include <filesystem>
+#include <cstddef>
 #include <functional>
 #include <optional>
+#include <string>
 #include <variant>
 #include <vector>
 
@@ -48,12 +57,12 @@ struct job_t
     };
 
     /**
-     * Runs the parse, typecheck and transform pipeline stages on each input file and
+     * Runs the parse, typecheck, transform and optimize pipeline stages on each input file and
      * writes a new file with the LLVM IR code of the result.
      * An optional output file name can be specified but only if there is a single input file.
      * If `no_prelude` is set, typechecking will be performed without importing the prelude module.
      * If `skip_transformations` is set, the transform stage will not be run.
-     * If `unverified` is set, the LLVM IR code generated will not be verified;
+     * If `unverified` is set, the LLVM IR code generated will not be verified, nor optimized;
      * this is useful when debugging the llvmgen module.
      */
     struct emit_llvm_t
@@ -63,16 +72,18 @@ struct job_t
         bool no_prelude;
         bool skip_transformations;
         bool unverified;
+        dep0::compile::opt_level_t opt_level;
         std::reference_wrapper<llvm::TargetMachine> machine;
     };
 
     /**
-     * Runs the parse, typecheck, transform and compile pipeline stages on each input file but
+     * Runs the parse, typecheck, transform, optimize and compile pipeline stages on each input file but
      * does not perform linking into a final executable.
      * It writes either object or assembly files depending on the value of `file_type`.
      * An optional output file name can be specified but only if there is a single input file.
      * If `no_prelude` is set, typechecking will be performed without importing the prelude module.
      * If `skip_transformations` is set, the transform stage will not be run.
+     * If `dump_optimized_ir` is set, the optimized LLVM IR code of each input file is also written to disk.
      */
     struct compile_only_t
     {
@@ -80,6 +91,8 @@ struct job_t
         std::optional<std::filesystem::path> out_file_name;
         bool no_prelude;
         bool skip_transformations;
+        dep0::compile::opt_level_t opt_level;
+        bool dump_optimized_ir;
         std::reference_wrapper<llvm::TargetMachine> machine;
         llvm::CodeGenFileType file_type;
     };
@@ -88,6 +101,8 @@ struct job_t
      * Runs the full pipeline, including linking to produce the final executable.
      * If `no_prelude` is set, typechecking will be performed without importing the prelude module.
      * If `skip_transformations` is set, the transform stage will not be run.
+     * If `dump_optimized_ir` is set, the optimized LLVM IR code of each input file is also written to disk.
+     * The `linker` selects whether to link inside the compiler process or by spawning the system linker.
      */
     struct compile_and_link_t
     {
@@ -95,10 +110,62 @@ struct job_t
         std::filesystem::path out_file_name;
         bool no_prelude;
         bool skip_transformations;
+        dep0::compile::opt_level_t opt_level;
+        bool dump_optimized_ir;
+        std::reference_wrapper<llvm::TargetMachine> machine;
+        dep0::link::linker_t linker;
+    };
+
+    /**
+     * Runs the parse, typecheck, transform, llvmgen and optimize pipeline stages on each input file and then,
+     * rather than compiling and linking them into an executable, JIT-compiles the result inside the compiler process
+     * and calls its `main` function with the given arguments; the exit code is the value returned by `main`.
+     * If `no_prelude` is set, typechecking will be performed without importing the prelude module.
+     * If `skip_transformations` is set, the transform stage will not be run.
+     * The `machine` must describe the host, because that is where the programme runs.
+     */
+    struct run_t
+    {
+        std::vector<std::filesystem::path> input_files;
+        bool no_prelude;
+        bool skip_transformations;
+        dep0::compile::opt_level_t opt_level;
         std::reference_wrapper<llvm::TargetMachine> machine;
+        std::vector<std::string> args;
     };
-    using value_t = std::variant<typecheck_t, print_ast_t, emit_llvm_t, compile_only_t, compile_and_link_t>;
+    using value_t = std::variant<typecheck_t, print_ast_t, emit_llvm_t, compile_only_t, compile_and_link_t, run_t>;
     value_t value;
+
+    /**
+     * Maximum number of input files to process concurrently; 0 means one per hardware thread.
+     * Input files are independent of each other, so each one runs through the pipeline on its own worker,
+     * but diagnostics are always reported in input order, as if the files had been processed one after the other.
+     */
+    std::size_t jobs = 1ul;
+
+    /**
+     * If set, the AST nodes of each input file are allocated from their own `dep0::arena_t`,
+     * which is released in one shot once the file has been processed, rather than one by one from the heap.
+     */
+    bool ast_arena = true;
+
+    /** Options passed to the typecheck stage of each input file, for example the Proof Search budget. */
+    dep0::typecheck::check_options_t check_options = {};
+
+    /**
+     * If set, the LLVM IR code generated for each function is stored in this directory and
+     * reused by later runs, for as long as neither the function nor anything it depends on changes.
+     */
+    std::optional<std::filesystem::path> cache_dir = std::nullopt;
+
+    /** Options passed to the parser stage of each input file, for example which front end to use. */
+    dep0::parser::parse_options_t parse_options = {};
+
+    /**
+     * If set, collects the profile of each function typechecked, which is printed to `stderr` once the job is done,
+     * whether it succeeds or not, from the function that took longest to typecheck.
+     */
+    typecheck_profile_t* typecheck_profile = nullptr;
 };
 
 /** Runs the given job and returns 0 if it succeeds. */
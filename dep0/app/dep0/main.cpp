@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -7,7 +7,14 @@
 #include "failure.hpp"
 #include "job.hpp"
 #include "pipeline.hpp"
+#include "server.hpp"
 
+#include "dep0/link/link.hpp"
+#include "dep0/parser/parse.hpp"
+#include "dep0/typecheck/beta_delta_reduction.hpp"
+#include "dep0/typecheck/check.hpp"
+
+#include "dep0/stats.hpp"
 #include "dep0/tracing.hpp"
 
 #include <llvm/CodeGen/CommandFlags.h>
@@ -19,9 +26,14 @@
 #include <llvm/Support/WithColor.h>
 #include <llvm/Target/TargetMachine.h>
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <filesystem>
 #include <functional>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -46,6 +58,10 @@ int main(int argc, char** argv)
 {
     namespace cl = llvm::cl;
 
+    // a client only forwards its command line to a server, so it must not pay for any of the initialization below
+    if (auto const exit_code = run_client(argc, argv))
+        return *exit_code;
+
     llvm::InitLLVM LLVM(argc, argv);
     llvm::InitializeAllTargets();
     llvm::InitializeAllTargetMCs();
@@ -64,6 +80,14 @@ int main(int argc, char** argv)
 
     // main options - sorted by the actual command line argument, i.e. `--a` before `--b`
     cl::OptionCategory mainCat("Main Options", "These options are the most commonly used ones");
+    auto const opt_level =
+        cl::opt<unsigned>(
+            "O",
+            cl::Prefix,
+            cl::init(0u),
+            cl::cat(mainCat),
+            cl::desc("Optimization level: -O0 (default), -O1, -O2 or -O3"),
+            cl::value_desc("level"));
     auto const compile_only =
         cl::opt<bool>(
             "S",
@@ -90,11 +114,28 @@ int main(int argc, char** argv)
             cl::desc(
                 "Compile only and emit unverified LLVM IR code; but do not assemble or link.\n"
                 "This is only useful when debugging the llvmgen module"));
+    auto const jobs =
+        cl::opt<std::size_t>(
+            "j",
+            cl::init(1ul),
+            cl::cat(mainCat),
+            cl::desc(
+                "Process up to N input files in parallel; 0 means one per hardware thread.\n"
+                "Diagnostics are still reported in input order"),
+            cl::value_desc("N"));
     auto const out_file_name =
         cl::opt<std::string>(
             "o",
             cl::cat(mainCat),
             cl::desc("Specify an output file name. If missing a default one will be used"));
+    auto const run_programme =
+        cl::opt<bool>(
+            "run",
+            cl::init(false),
+            cl::cat(mainCat),
+            cl::desc(
+                "JIT-compile the input files inside the compiler and run them, rather than producing an executable.\n"
+                "All arguments after `--` are passed to `main` and the exit code is the value that `main` returns"));
     auto const typecheck_only =
         cl::opt<bool>(
             "t",
@@ -104,17 +145,101 @@ int main(int argc, char** argv)
 
     // extra options - also sorted as above
     cl::OptionCategory extraCat("Secondary Options", "These are extra options that can be useful occasionally");
+    auto const cache_dir =
+        cl::opt<std::string>(
+            "cache-dir",
+            cl::cat(extraCat),
+            cl::desc(
+                "Store the LLVM IR code generated for each function in this directory and reuse it in later runs, "
+                "unless the function or anything it depends on has changed"),
+            cl::value_desc("dir"));
+    auto const connect_socket =
+        cl::opt<std::string>(
+            "connect",
+            cl::cat(extraCat),
+            cl::desc(
+                "Send this invocation to the server listening on the given socket, started via --server, "
+                "and wait for it to complete"),
+            cl::value_desc("socket"));
+    auto const dump_optimized_ir =
+        cl::opt<bool>(
+            "dump-optimized-ir",
+            cl::init(false),
+            cl::cat(extraCat),
+            cl::desc(
+                "When compiling, also write the LLVM IR code after the optimization stage "
+                "to a file named like the input file with the extension '.opt.ll' appended"));
+    auto const linker =
+        cl::opt<dep0::link::linker_t>(
+            "linker",
+            cl::init(dep0::link::default_linker()),
+            cl::cat(extraCat),
+            cl::desc("How to link the final executable"),
+            cl::values(
+                clEnumValN(
+                    dep0::link::linker_t::in_process, "in-process",
+                    "Link inside the compiler process, using LLD (default if the compiler was built with LLD)"),
+                clEnumValN(
+                    dep0::link::linker_t::external, "external",
+                    "Spawn the system linker `ld` (default if the compiler was built without LLD)")));
     auto const mtriple =
         cl::opt<std::string>(
             "mtriple",
             cl::cat(extraCat),
             cl::desc("Override the target triple used during compilation and assembly stages"));
+    auto const no_ast_arena =
+        cl::opt<bool>(
+            "no-ast-arena",
+            cl::init(false),
+            cl::cat(extraCat),
+            cl::desc(
+                "Allocate AST nodes individually from the heap, "
+                "rather than from a memory arena for each input file that is released in one go"));
     auto const no_prelude =
         cl::opt<bool>(
             "no-prelude",
             cl::init(false),
             cl::cat(extraCat),
             cl::desc("Do not pre-import the prelude module"));
+    auto const normalizer =
+        cl::opt<dep0::typecheck::normalizer_t>(
+            "normalizer",
+            cl::init(dep0::typecheck::normalizer_t::substitution),
+            cl::cat(extraCat),
+            cl::desc("Algorithm used for beta-delta normalization, both whilst typechecking and when transforming"),
+            cl::values(
+                clEnumValN(
+                    dep0::typecheck::normalizer_t::substitution, "substitution",
+                    "Alternate beta-reduction, by substitution, and delta-unfolding (default)"),
+                clEnumValN(
+                    dep0::typecheck::normalizer_t::evaluation, "evaluation",
+                    "Normalization by evaluation, in a single pass")));
+    auto const parser =
+        cl::opt<dep0::parser::front_end_t>(
+            "parser",
+            cl::init(dep0::parser::front_end_t::antlr),
+            cl::cat(extraCat),
+            cl::desc("Implementation used to parse input files; both produce the same AST"),
+            cl::values(
+                clEnumValN(
+                    dep0::parser::front_end_t::antlr, "antlr",
+                    "The parser generated by ANTLR4 from the grammar of the language (default)"),
+                clEnumValN(
+                    dep0::parser::front_end_t::recursive_descent, "recursive-descent",
+                    "A faster, hand-written, recursive-descent parser")));
+    auto const parser_prediction =
+        cl::opt<dep0::parser::prediction_mode_t>(
+            "parser-prediction",
+            cl::init(dep0::parser::prediction_mode_t::two_stage),
+            cl::cat(extraCat),
+            cl::desc("Prediction mode used by the ANTLR4 parser; both produce the same AST"),
+            cl::values(
+                clEnumValN(
+                    dep0::parser::prediction_mode_t::two_stage, "two-stage",
+                    "Try the faster SLL prediction first and fall back to full LL only if that fails (default)"),
+                clEnumValN(
+                    dep0::parser::prediction_mode_t::ll, "ll",
+                    "Always use full LL prediction")));
     auto const print_ast =
         cl::opt<bool>(
             "print-ast",
@@ -123,12 +248,86 @@ int main(int argc, char** argv)
             cl::desc(
                 "When using -t, print the resulting AST.\n"
                 "The AST is printed after the transformation stage, unless --skip-transformations is also set"));
+    auto const server_socket =
+        cl::opt<std::string>(
+            "server",
+            cl::cat(extraCat),
+            cl::desc(
+                "Run as a server listening on the given Unix domain socket, for clients started via --connect.\n"
+                "The server initializes LLVM targets and the prelude module only once; "
+                "then each request runs in its own forked process, so it cannot affect the next ones"),
+            cl::value_desc("socket"));
     auto const skip_transformations =
         cl::opt<bool>(
             "skip-transformations",
             cl::init(false),
             cl::cat(extraCat),
             cl::desc("Skip the transformations pipeline stage, for example beta-delta normalization"));
+    auto const stats_file_name =
+        cl::opt<std::string>(
+            "stats",
+            cl::cat(extraCat),
+            cl::desc(
+                "Write statistics collected by all stages of the compiler to the given file in JSON format, "
+                "for example the number of AST nodes allocated, proof search tasks run and LLVM instructions generated"),
+            cl::value_desc("file.json"));
+    auto const enable_typecheck_profile =
+        cl::opt<bool>(
+            "typecheck-profile",
+            cl::init(false),
+            cl::cat(extraCat),
+            cl::desc(
+                "Once done, print to stderr how long it took to typecheck each function, from the slowest one, "
+                "and how much of that time was spent in proof search and normalization"));
+
+    // proof search options - also sorted as above
+    cl::OptionCategory proofSearchCat(
+        "Proof Search Options",
+        "Use these options to control how much work the typechecker can do to find values automatically, "
+        "for example for `auto` arguments");
+    auto const proof_search_fuel =
+        cl::opt<std::size_t>(
+            "proof-search-fuel",
+            cl::init(dep0::typecheck::proof_search_budget_t{}.fuel),
+            cl::cat(proofSearchCat),
+            cl::desc("Maximum number of steps that each individual proof search can take before giving up"),
+            cl::value_desc("N"));
+    auto const proof_search_fuel_overrides =
+        cl::list<std::string>(
+            "proof-search-fuel-override",
+            cl::CommaSeparated,
+            cl::cat(proofSearchCat),
+            cl::desc(
+                "Override the value of --proof-search-fuel for the given functions only; "
+                "can be repeated or given as a comma separated list"),
+            cl::value_desc("function=N"));
+    auto const proof_search_max_depth =
+        cl::opt<std::size_t>(
+            "proof-search-max-depth",
+            cl::init(dep0::typecheck::proof_search_budget_t{}.max_depth),
+            cl::cat(proofSearchCat),
+            cl::desc("Maximum depth of the search tree explored by each individual proof search"),
+            cl::value_desc("N"));
+    auto const proof_search_threads =
+        cl::opt<std::size_t>(
+            "proof-search-threads",
+            cl::init(dep0::typecheck::proof_search_budget_t{}.threads),
+            cl::cat(proofSearchCat),
+            cl::desc(
+                "Maximum number of threads that each individual proof search can use to explore alternative proofs; "
+                "any value above 1 finds the same proofs, but splits the fuel across alternatives, "
+                "so a file that typechecks with 1 thread may fail with more"),
+            cl::value_desc("N"));
+    auto const proof_search_timeout =
+        cl::opt<unsigned>(
+            "proof-search-timeout",
+            cl::init(0u),
+            cl::cat(proofSearchCat),
+            cl::desc(
+                "Also give up each individual proof search after the given number of milliseconds; "
+                "0 (default) means no time limit.\n"
+                "This is only meant as a safety net, since typechecking may then depend on machine load"),
+            cl::value_desc("ms"));
 
     // tracing options
     cl::OptionCategory tracingCat("Tracing Options", "Use these options to obtain a trace of the programme execution");
@@ -138,80 +337,223 @@ int main(int argc, char** argv)
             cl::init(false),
             cl::cat(tracingCat),
             cl::desc("Write a trace file, by default named 'dep0.trace' unless --trace-file is specified"));
+    auto const trace_buffer_size =
+        cl::opt<std::size_t>(
+            "trace-buffer-size",
+            cl::init(dep0::tracing_options_t{}.buffer_size_kb),
+            cl::cat(tracingCat),
+            cl::desc(
+                "Size of the in-memory buffer holding trace events until they are written to the trace file; "
+                "once full, the oldest events not yet written are overwritten, "
+                "or later events are dropped if --trace-write-period=0"),
+            cl::value_desc("KB"));
+    auto const trace_counters_period =
+        cl::opt<unsigned>(
+            "trace-counters-period",
+            cl::init(dep0::tracing_options_t{}.counters_period.count()),
+            cl::cat(tracingCat),
+            cl::desc(
+                "How often to sample counter tracks, for example memory usage, live AST nodes and cache hit rates; "
+                "0 disables counter tracks"),
+            cl::value_desc("ms"));
     auto const trace_file_name =
         cl::opt<std::string>(
             "trace-file",
             cl::cat(tracingCat),
             cl::desc("Override the default trace file name and implicitly enables tracing"));
+    auto const trace_write_period =
+        cl::opt<unsigned>(
+            "trace-write-period",
+            cl::init(dep0::tracing_options_t{}.write_period.count()),
+            cl::cat(tracingCat),
+            cl::desc(
+                "How often to write buffered trace events to the trace file, "
+                "so that a crash only loses the most recent ones; 0 writes the trace file only at exit"),
+            cl::value_desc("ms"));
 
     auto const input_files = cl::list<std::string>(cl::Positional, cl::desc("<input-files>"));
 
-    cl::ParseCommandLineOptions(
-        argc, argv,
-        "dep0 - DepC Bootstrapping Compiler",
-        /*Errs*/ nullptr,
-        /*EnvVar*/ nullptr,
-        /*LongOptionsUseDoubleDash*/ true);
+    // everything after `--` is not for the compiler but for the programme started via --run
+    auto programme_args = std::vector<std::string>{};
+    auto const parse_command_line = [&] (std::vector<char const*> args)
+    {
+        auto const dash_dash =
+            std::ranges::find_if(args, [] (char const* const x) { return std::string_view(x) == "--"; });
+        programme_args.assign(dash_dash == args.end() ? dash_dash : std::next(dash_dash), args.end());
+        args.erase(dash_dash, args.end());
+        cl::ParseCommandLineOptions(
+            static_cast<int>(args.size()), args.data(),
+            "dep0 - DepC Bootstrapping Compiler",
+            /*Errs*/ nullptr,
+            /*EnvVar*/ nullptr,
+            /*LongOptionsUseDoubleDash*/ true);
+    };
+    parse_command_line(std::vector<char const*>(argv, argv + argc));
+
+    if (not server_socket.empty())
+    {
+        if (not input_files.empty())
+            return failure("--server does not take input files");
+        warm_up_pipelines(dep0::parser::parse_options_t{.front_end = parser, .prediction_mode = parser_prediction});
+        // only returns in the server process if something went wrong, otherwise in the process forked for a request
+        auto const request = serve(server_socket.getValue());
+        if (not request)
+            return failure(fs::path(server_socket.getValue()), "server failed", request.error());
+        auto args = std::vector<char const*>{argv[0]};
+        for (auto const& x: *request)
+            args.push_back(x.c_str());
+        cl::ResetAllOptionOccurrences();
+        parse_command_line(std::move(args));
+        if (not server_socket.empty() or not connect_socket.empty())
+            return failure("--server and --connect cannot be sent to a server");
+    }
 
     if (input_files.empty())
         return failure("no input files");
+    if (not programme_args.empty() and not run_programme)
+        return failure("arguments after `--` can only be used with --run");
+    if (linker == dep0::link::linker_t::in_process and not dep0::link::has_in_process_linker())
+        return failure("--linker=in-process is not available, because the compiler was built without LLD");
 
     auto const input_file_paths = std::vector<fs::path>(input_files.begin(), input_files.end());
 
-    auto const tracing = [&]
+    auto const func_cache_dir =
+        cache_dir.empty() ? std::nullopt : std::optional<fs::path>{cache_dir.getValue()};
+    auto check_options = dep0::typecheck::check_options_t{
+        .proof_search = {
+            .fuel = proof_search_fuel,
+            .max_depth = proof_search_max_depth,
+            .timeout =
+                proof_search_timeout == 0u
+                ? std::nullopt
+                : std::optional{std::chrono::milliseconds(proof_search_timeout.getValue())},
+            .threads = std::max(proof_search_threads.getValue(), 1ul)
+        },
+        .normalizer = normalizer
+    };
+    auto const parse_options = dep0::parser::parse_options_t{
+        .front_end = parser,
+        .prediction_mode = parser_prediction
+    };
+    for (auto const& x: proof_search_fuel_overrides)
+    {
+        auto const separator = x.rfind('=');
+        if (separator == std::string::npos or separator == 0ul)
+            return failure("invalid --proof-search-fuel-override, must be of the form function=N");
+        std::size_t fuel = 0ul;
+        auto const [end, ec] = std::from_chars(x.data() + separator + 1ul, x.data() + x.size(), fuel);
+        if (ec != std::errc{} or end != x.data() + x.size())
+            return failure("invalid --proof-search-fuel-override, must be of the form function=N");
+        check_options.proof_search_fuel_overrides[x.substr(0ul, separator)] = fuel;
+    }
+
+    auto const trace_file = fs::path(trace_file_name.empty() ? "dep0.trace" : trace_file_name.getValue());
+    auto const tracing = [&] () -> dep0::expected<std::shared_ptr<dep0::tracing_session_t>>
+    {
+        if (not enable_tracing and trace_file_name.empty())
+            return std::shared_ptr<dep0::tracing_session_t>{};
+        return dep0::start_tracing_session(
+            trace_file,
+            dep0::tracing_options_t{
+                .buffer_size_kb = trace_buffer_size,
+                .write_period = std::chrono::milliseconds(trace_write_period.getValue()),
+                .counters_period = std::chrono::milliseconds(trace_counters_period.getValue())
+            });
+    }();
+    if (not tracing)
+        return failure(trace_file, "failed to start tracing", tracing.error());
+    auto const stats = [&] () -> dep0::expected<std::shared_ptr<dep0::stats_session_t>>
     {
-        return enable_tracing or not trace_file_name.empty()
-            ? dep0::start_tracing_session(trace_file_name.empty() ? "dep0.trace" : trace_file_name.getValue())
-            : nullptr;
+        if (stats_file_name.empty())
+            return std::shared_ptr<dep0::stats_session_t>{};
+        return dep0::start_stats_session(stats_file_name.getValue());
     }();
+    if (not stats)
+        return failure(fs::path(stats_file_name.getValue()), "failed to collect statistics", stats.error());
+    typecheck_profile_t typecheck_profile_collector;
+    auto const typecheck_profile = enable_typecheck_profile ? &typecheck_profile_collector : nullptr;
+
+    // statistics are written before returning, so that failing to write them also makes the run fail
+    auto const result = [&] () -> int
+    {
+        if (typecheck_only)
+            return print_ast
+                ? run(job_t{job_t::print_ast_t{
+                    .input_files = input_file_paths,
+                    .no_prelude = no_prelude,
+                    .skip_transformations = skip_transformations
+                    }, jobs, not no_ast_arena, check_options, std::nullopt, parse_options, typecheck_profile})
+                : run(job_t{job_t::typecheck_t{
+                    .input_files = input_file_paths,
+                    .no_prelude = no_prelude
+                    }, jobs, not no_ast_arena, check_options, std::nullopt, parse_options, typecheck_profile});
+        if (print_ast)
+            llvm::WithColor::warning() << "--print-ast can only be used with -t; will be ignored\n";
+        if (opt_level > 3u)
+            return failure("invalid optimization level, must be one of -O0, -O1, -O2 or -O3");
+        auto const level = static_cast<dep0::compile::opt_level_t>(opt_level.getValue());
+
+        auto const file_type = llvm::codegen::getExplicitFileType().getValueOr(llvm::CGFT_ObjectFile);
+        auto target_triple =
+            llvm::Triple(
+                mtriple.empty()
+                ? llvm::sys::getDefaultTargetTriple()
+                : llvm::Triple::normalize(mtriple));
+        auto const machine = setup_target_machine(target_triple);
 
-    if (typecheck_only)
-        return print_ast
-            ? run(job_t{job_t::print_ast_t{
+        if (not machine)
+            return failure("failed to create target machine");
+        if (run_programme)
+        {
+            if (not mtriple.empty())
+                return failure("--run always runs on the host machine, so it cannot be used with --mtriple");
+            auto args = std::vector<std::string>{input_file_paths.front().native()};
+            args.insert(args.end(), programme_args.begin(), programme_args.end());
+            return run(job_t{job_t::run_t{
                 .input_files = input_file_paths,
                 .no_prelude = no_prelude,
-                .skip_transformations = skip_transformations
-                }})
-            : run(job_t{job_t::typecheck_t{
+                .skip_transformations = skip_transformations,
+                .opt_level = level,
+                .machine = std::ref(*machine),
+                .args = std::move(args)
+            }, jobs, not no_ast_arena, check_options, func_cache_dir, parse_options, typecheck_profile});
+        }
+        if (emit_llvm or emit_llvm_unverified)
+            return run(job_t{job_t::emit_llvm_t{
                 .input_files = input_file_paths,
-                .no_prelude = no_prelude
-                }});
-    if (print_ast)
-        llvm::WithColor::warning() << "--print-ast can only be used with -t; will be ignored\n";
-
-    auto const file_type = llvm::codegen::getExplicitFileType().getValueOr(llvm::CGFT_ObjectFile);
-    auto target_triple =
-        llvm::Triple(
-            mtriple.empty()
-            ? llvm::sys::getDefaultTargetTriple()
-            : llvm::Triple::normalize(mtriple));
-    auto const machine = setup_target_machine(target_triple);
-
-    if (not machine)
-        return failure("failed to create target machine");
-    if (emit_llvm or emit_llvm_unverified)
-        return run(job_t{job_t::emit_llvm_t{
-            .input_files = input_file_paths,
-            .out_file_name = out_file_name.empty() ? std::nullopt : std::optional<fs::path>{out_file_name.getValue()},
-            .no_prelude =  no_prelude,
-            .skip_transformations = skip_transformations,
-            .unverified = emit_llvm_unverified,
-            .machine = std::ref(*machine),
-        }});
-    if (compile_and_assemble or compile_only or file_type == llvm::CGFT_AssemblyFile)
-        return run(job_t{job_t::compile_only_t{
+                .out_file_name =
+                    out_file_name.empty() ? std::nullopt : std::optional<fs::path>{out_file_name.getValue()},
+                .no_prelude =  no_prelude,
+                .skip_transformations = skip_transformations,
+                .unverified = emit_llvm_unverified,
+                .opt_level = level,
+                .machine = std::ref(*machine),
+            }, jobs, not no_ast_arena, check_options, func_cache_dir, parse_options, typecheck_profile});
+        if (compile_and_assemble or compile_only or file_type == llvm::CGFT_AssemblyFile)
+            return run(job_t{job_t::compile_only_t{
+                .input_files = input_file_paths,
+                .out_file_name =
+                    out_file_name.empty() ? std::nullopt : std::optional<fs::path>{out_file_name.getValue()},
+                .no_prelude = no_prelude,
+                .skip_transformations = skip_transformations,
+                .opt_level = level,
+                .dump_optimized_ir = dump_optimized_ir,
+                .machine = std::ref(*machine),
+                .file_type = compile_and_assemble ? llvm::CGFT_ObjectFile : llvm::CGFT_AssemblyFile
+            }, jobs, not no_ast_arena, check_options, func_cache_dir, parse_options, typecheck_profile});
+        return run(job_t{job_t::compile_and_link_t{
             .input_files = input_file_paths,
-            .out_file_name = out_file_name.empty() ? std::nullopt : std::optional<fs::path>{out_file_name.getValue()},
+            .out_file_name = out_file_name.empty() ? fs::path("a.out") : fs::path(out_file_name.getValue()),
             .no_prelude = no_prelude,
             .skip_transformations = skip_transformations,
+            .opt_level = level,
+            .dump_optimized_ir = dump_optimized_ir,
             .machine = std::ref(*machine),
-            .file_type = compile_and_assemble ? llvm::CGFT_ObjectFile : llvm::CGFT_AssemblyFile
-        }});
-    return run(job_t{job_t::compile_and_link_t{
-        .input_files = input_file_paths,
-        .out_file_name = out_file_name.empty() ? fs::path("a.out") : fs::path(out_file_name.getValue()),
-        .no_prelude = no_prelude,
-        .skip_transformations = skip_transformations,
-        .machine = std::ref(*machine)
-    }});
+            .linker = linker
+        }, jobs, not no_ast_arena, check_options, func_cache_dir, parse_options, typecheck_profile});
+    }();
+    if (*stats)
+        if (auto const ok = dep0::stop_stats_session(**stats); not ok)
+            return failure(fs::path(stats_file_name.getValue()), "failed to write statistics", ok.error());
+    return result;
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -7,23 +7,32 @@
 #include "pipeline.hpp"
 
 #include "dep0/compile/compile.hpp"
+#include "dep0/compile/optimize.hpp"
 #include "dep0/llvmgen/gen.hpp"
 #include "dep0/parser/parse.hpp"
+#include "dep0/typecheck/beta_delta_reduction.hpp"
 #include "dep0/typecheck/check.hpp"
+#include "dep0/typecheck/prelude_image.hpp"
+#include "dep0/typecheck/serialization.hpp"
 #include "dep0/transform/beta_delta_normalization.hpp"
 #include "dep0/transform/run.hpp"
 
+#include "dep0/arena.hpp"
 #include "dep0/tracing.hpp"
 
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/ToolOutputFile.h>
+
 // parser stage
-parser_pipeline_t::pipeline_t(parser_stage_t)
+parser_pipeline_t::pipeline_t(parser_stage_t a) :
+    options(std::move(a))
 {
 }
 
 dep0::expected<dep0::parser::module_t> parser_pipeline_t::run(std::filesystem::path const& f) const
 {
     TRACE_EVENT(TRACE_PARSING, "parser_pipeline_t::run()", "file", f.native());
-    auto result = dep0::parser::parse(f);
+    auto result = dep0::parser::parse(f, options.parse_options);
     if (not result)
         return dep0::error_t("parsing failed", {std::move(result.error())});
     return result;
@@ -36,18 +45,57 @@ typecheck_pipeline_t::pipeline_t(parser_stage_t a, typecheck_stage_t b) :
 {
 }
 
+/**
+ * Return the base environment, with the prelude module pre-imported, or the error that occurred whilst building it.
+ *
+ * It is built only once per process, on first use, by loading the image of the prelude module that was
+ * typechecked when building the compiler, which is much cheaper than parsing and typechecking it again;
+ * if that ever fails, it falls back to typechecking the prelude module from source.
+ * After that, the same environment is shared by all input files, possibly from multiple threads at the same time;
+ * this is safe because it is never modified again and `check()` only ever adds new symbols to an `extend()`ed view.
+ */
+static dep0::expected<dep0::typecheck::env_t> const& get_base_env()
+{
+    static auto const env = [] () -> dep0::expected<dep0::typecheck::env_t>
+    {
+        TRACE_EVENT(TRACE_TYPECHECKING, "prelude");
+        // this environment lives for the whole process, so it must not pin the arena of whichever file comes first
+        auto const heap = dep0::arena_scope_t(nullptr);
+        auto const prelude = dep0::typecheck::deserialize(dep0::typecheck::env_t{}, dep0::typecheck::prelude_image());
+        if (prelude)
+            return dep0::typecheck::make_base_env(*prelude);
+        return dep0::typecheck::make_base_env();
+    }();
+    return env;
+}
+
+void warm_up_pipelines(dep0::parser::parse_options_t const& parse_options)
+{
+    dep0::parser::warm_up(parse_options);
+    get_base_env();
+}
+
 dep0::expected<dep0::typecheck::module_t> typecheck_pipeline_t::run(std::filesystem::path const& f) const
 {
     auto module = parser_pipeline_t::run(f);
     if (not module)
         return std::move(module.error());
-    TRACE_EVENT_BEGIN(TRACE_TYPECHECKING, "prelude");
-    auto const env = options.no_prelude ? dep0::expected<dep0::typecheck::env_t>{} : dep0::typecheck::make_base_env();
-    TRACE_EVENT_END(TRACE_TYPECHECKING);
+    auto const no_prelude_env = dep0::expected<dep0::typecheck::env_t>{};
+    auto const& env = options.no_prelude ? no_prelude_env : get_base_env();
     if (not env)
-        return std::move(env.error());
+        return env.error();
     TRACE_EVENT(TRACE_TYPECHECKING, "typecheck_pipeline_t::run()", "file", f.native());
-    auto result = dep0::typecheck::check(*env, *module);
+    std::vector<dep0::typecheck::func_profile_t> profile;
+    auto result = [&]
+    {
+        if (not options.profile)
+            return dep0::typecheck::check(*env, *module, options.check_options);
+        auto check_options = options.check_options;
+        check_options.profile = &profile;
+        return dep0::typecheck::check(*env, *module, check_options);
+    }();
+    if (options.profile)
+        options.profile->add(f, std::move(profile));
     if (not result)
         return dep0::error_t("typechecking failed", {std::move(result.error())});
     return result;
@@ -66,6 +114,9 @@ dep0::expected<dep0::typecheck::module_t> transform_pipeline_t::run(std::filesys
     if (module and not options.skip)
     {
         TRACE_EVENT(TRACE_TRANSFORM, "transform_pipeline_t::run()", "file", f.native());
+        // normalize with the same algorithm used during typechecking
+        auto const normalizer_scope =
+            dep0::typecheck::normalizer_scope_t(typecheck_pipeline_t::options.check_options.normalizer);
         auto const result =
             dep0::transform::run(
                 *module,
@@ -92,27 +143,62 @@ dep0::expected<dep0::unique_ref<llvm::Module>> llvmgen_pipeline_t::run(std::file
     TRACE_EVENT(TRACE_LLVMGEN, "llvmgen_pipeline_t::run()", "file", f.native());
     auto result = options.unverified
         ? dep0::llvmgen::gen_unverified(options.llvm_context.get(), f.filename().native(), *module, options.machine)
-        : dep0::llvmgen::gen(options.llvm_context.get(), f.filename().native(), *module, options.machine);
+        : dep0::llvmgen::gen(
+            options.llvm_context.get(), f.filename().native(), *module, options.machine, options.func_cache);
     if (not result)
         return dep0::error_t("llvmgen failed", {std::move(result.error())});
     return result;
 }
 
-// compile
-compile_pipeline_t::pipeline_t(
+// optimize
+optimize_pipeline_t::pipeline_t(
     parser_stage_t a,
     typecheck_stage_t b,
     transform_stage_t c,
     llvmgen_stage_t d,
-    compile_stage_t e
+    optimize_stage_t e
 ) : llvmgen_pipeline_t(std::move(a), std::move(b), std::move(c), std::move(d)),
     options(std::move(e))
 {
 }
 
-dep0::expected<dep0::temp_file_t> compile_pipeline_t::run(std::filesystem::path const& f) const
+dep0::expected<dep0::unique_ref<llvm::Module>> optimize_pipeline_t::run(std::filesystem::path const& f) const
 {
     auto module = llvmgen_pipeline_t::run(f);
+    if (not module)
+        return module.error();
+    {
+        TRACE_EVENT(TRACE_OPTIMIZE, "optimize_pipeline_t::run()", "file", f.native());
+        dep0::compile::optimize(module->get(), options.machine, options.level);
+    }
+    if (options.dump_ir)
+    {
+        std::error_code ec;
+        auto out = llvm::ToolOutputFile(f.native() + ".opt.ll", ec, llvm::sys::fs::OF_Text);
+        if (ec)
+            return dep0::error_t("error opening file to dump optimized LLVM IR");
+        module->get().print(out.os(), nullptr);
+        out.keep();
+    }
+    return module;
+}
+
+// compile
+compile_pipeline_t::pipeline_t(
+    parser_stage_t a,
+    typecheck_stage_t b,
+    transform_stage_t c,
+    llvmgen_stage_t d,
+    optimize_stage_t e,
+    compile_stage_t f
+) : optimize_pipeline_t(std::move(a), std::move(b), std::move(c), std::move(d), std::move(e)),
+    options(std::move(f))
+{
+}
+
+dep0::expected<dep0::temp_file_t> compile_pipeline_t::run(std::filesystem::path const& f) const
+{
+    auto module = optimize_pipeline_t::run(f);
     if (not module)
         return module.error();
     TRACE_EVENT(TRACE_COMPILE, "compile_pipeline_t::run()", "file", f.native());
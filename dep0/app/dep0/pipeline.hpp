@@ -1,13 +1,19 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
  */
 #pragma once
 
+#include "typecheck_profile.hpp"
+
+#include "dep0/compile/optimize.hpp"
+#include "dep0/llvmgen/func_cache.hpp"
 #include "dep0/parser/ast.hpp"
+#include "dep0/parser/parse.hpp"
 #include "dep0/typecheck/ast.hpp"
+#include "dep0/typecheck/check.hpp"
 
 #include "dep0/error.hpp"
 #include "dep0/temp_file.hpp"
@@ -23,6 +29,7 @@ struct parser_stage_t;
 struct typecheck_stage_t;
 struct transform_stage_t;
 struct llvmgen_stage_t;
+struct optimize_stage_t;
 struct compile_stage_t;
 
 template <typename... Stages>
@@ -32,19 +39,32 @@ using parser_pipeline_t     = pipeline_t<parser_stage_t>;
 using typecheck_pipeline_t  = pipeline_t<parser_stage_t, typecheck_stage_t>;
 using transform_pipeline_t  = pipeline_t<parser_stage_t, typecheck_stage_t, transform_stage_t>;
 using llvmgen_pipeline_t    = pipeline_t<parser_stage_t, typecheck_stage_t, transform_stage_t, llvmgen_stage_t>;
-using compile_pipeline_t    = pipeline_t<parser_stage_t, typecheck_stage_t, transform_stage_t, llvmgen_stage_t, compile_stage_t>;
+using optimize_pipeline_t   =
+    pipeline_t<parser_stage_t, typecheck_stage_t, transform_stage_t, llvmgen_stage_t, optimize_stage_t>;
+using compile_pipeline_t    =
+    pipeline_t<
+        parser_stage_t, typecheck_stage_t, transform_stage_t, llvmgen_stage_t, optimize_stage_t, compile_stage_t>;
 
 template <typename... Stages>
 pipeline_t<Stages...> build_pipeline(Stages&&...);
 
+/**
+ * Build, ahead of time, the state that all pipelines in the same process share and would otherwise build on first use,
+ * i.e. the base environment with the prelude module pre-imported and the prediction cache of the parser.
+ */
+void warm_up_pipelines(dep0::parser::parse_options_t const&);
+
 // parser
 struct parser_stage_t
 {
+    dep0::parser::parse_options_t parse_options = {};
 };
 
 template <>
 struct pipeline_t<parser_stage_t>
 {
+    parser_stage_t options;
+
     explicit pipeline_t(parser_stage_t);
 
     dep0::expected<dep0::parser::module_t> run(std::filesystem::path const&) const;
@@ -56,6 +76,8 @@ struct pipeline_t<parser_stage_t>
 struct typecheck_stage_t
 {
     bool no_prelude = false;
+    dep0::typecheck::check_options_t check_options = {};
+    typecheck_profile_t* profile = nullptr; /**< If set, collects the profile of each function typechecked. */
 };
 
 template <>
@@ -87,11 +109,17 @@ struct pipeline_t<parser_stage_t, typecheck_stage_t, transform_stage_t>
 
 // llvmgen
 
+/**
+ * Generates the LLVM IR code of each input file.
+ * If `func_cache` is set, the code of functions that did not change since a previous run is reused from there;
+ * it is ignored if `unverified` is also set.
+ */
 struct llvmgen_stage_t
 {
     std::reference_wrapper<llvm::TargetMachine> machine;
     std::reference_wrapper<llvm::LLVMContext> llvm_context;
     bool unverified = false;
+    dep0::llvmgen::func_cache_t const* func_cache = nullptr;
 };
 
 template <>
@@ -105,6 +133,30 @@ struct pipeline_t<parser_stage_t, typecheck_stage_t, transform_stage_t, llvmgen_
     dep0::expected<dep0::unique_ref<llvm::Module>> run(std::filesystem::path const&) const;
 };
 
+// optimize
+
+/**
+ * Runs the standard LLVM optimization pipeline of the given level on the generated module.
+ * If `dump_ir` is set, the optimized LLVM IR code is also written to `<input-file>.opt.ll`.
+ */
+struct optimize_stage_t
+{
+    std::reference_wrapper<llvm::TargetMachine> machine;
+    dep0::compile::opt_level_t level = dep0::compile::opt_level_t::O0;
+    bool dump_ir = false;
+};
+
+template <>
+struct pipeline_t<parser_stage_t, typecheck_stage_t, transform_stage_t, llvmgen_stage_t, optimize_stage_t>
+    : llvmgen_pipeline_t
+{
+    optimize_stage_t options;
+
+    pipeline_t(parser_stage_t, typecheck_stage_t, transform_stage_t, llvmgen_stage_t, optimize_stage_t);
+
+    dep0::expected<dep0::unique_ref<llvm::Module>> run(std::filesystem::path const&) const;
+};
+
 // compile
 
 struct compile_stage_t
@@ -114,12 +166,14 @@ struct compile_stage_t
 };
 
 template <>
-struct pipeline_t<parser_stage_t, typecheck_stage_t, transform_stage_t, llvmgen_stage_t, compile_stage_t> :
-    llvmgen_pipeline_t
+struct pipeline_t<
+    parser_stage_t, typecheck_stage_t, transform_stage_t, llvmgen_stage_t, optimize_stage_t, compile_stage_t
+> : optimize_pipeline_t
 {
     compile_stage_t options;
 
-    pipeline_t(parser_stage_t, typecheck_stage_t, transform_stage_t, llvmgen_stage_t, compile_stage_t);
+    pipeline_t(
+        parser_stage_t, typecheck_stage_t, transform_stage_t, llvmgen_stage_t, optimize_stage_t, compile_stage_t);
 
     dep0::expected<dep0::temp_file_t> run(std::filesystem::path const&) const;
 };
@@ -0,0 +1,368 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "server.hpp"
+
+#include "failure.hpp"
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string_view>
+
+// Every request is sent as a 4 bytes size, together with the standard streams of the client as ancillary data,
+// followed by that many bytes containing the working directory of the client and then each argument,
+// each one as a 4 bytes size followed by its characters.
+// Once the request has been processed, the server replies with the exit code in 4 bytes.
+// All sizes and codes are in native byte order, since both sides always run on the same machine.
+
+/** Requests larger than this are rejected; it is much more than any reasonable command line. */
+static constexpr std::uint32_t max_request_size = 1u << 24;
+
+/** Number of standard streams sent with each request, i.e. stdin, stdout and stderr. */
+static constexpr std::size_t num_streams = 3ul;
+
+static dep0::error_t system_error(std::string msg)
+{
+    return dep0::error_t(std::move(msg), {dep0::error_t(std::strerror(errno))});
+}
+
+static bool write_all(int const fd, void const* const data, std::size_t size)
+{
+    auto p = static_cast<char const*>(data);
+    while (size > 0ul)
+    {
+        auto const n = ::write(fd, p, size);
+        if (n < 0 and errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+static bool read_all(int const fd, void* const data, std::size_t size)
+{
+    auto p = static_cast<char*>(data);
+    while (size > 0ul)
+    {
+        auto const n = ::read(fd, p, size);
+        if (n < 0 and errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+static dep0::expected<sockaddr_un> make_address(std::filesystem::path const& socket)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket.native().size() >= sizeof(address.sun_path))
+        return dep0::error_t("socket path is too long");
+    std::strcpy(address.sun_path, socket.c_str());
+    return address;
+}
+
+/**
+ * Check that the given socket can only be used by the current user, which is how `serve()` creates it.
+ * A client sends its standard streams to the server, so it must not connect to a socket that someone else
+ * might have created, nor to one that other users could also listen on after replacing it.
+ */
+static dep0::expected<std::true_type> check_socket_owner(std::filesystem::path const& socket)
+{
+    struct stat st{};
+    if (::lstat(socket.c_str(), &st) < 0)
+        return system_error("cannot stat socket");
+    if (not S_ISSOCK(st.st_mode))
+        return dep0::error_t("not a socket");
+    if (st.st_uid != ::getuid())
+        return dep0::error_t("socket is owned by another user");
+    if (st.st_mode & (S_IRWXG | S_IRWXO))
+        return dep0::error_t("socket is accessible by other users");
+    return std::true_type{};
+}
+
+/** Return true if the peer of the given connection runs as the same user as the current process. */
+static bool is_same_user(int const conn)
+{
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    return ::getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 and len == sizeof(cred)
+        and cred.uid == ::getuid();
+}
+
+/** Return a new socket connected to the given address, or -1 setting `errno`. */
+static int connect_to(sockaddr_un const& address)
+{
+    int const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (::connect(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) < 0)
+    {
+        auto const saved = errno;
+        ::close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+static void append(std::string& payload, std::string_view const s)
+{
+    auto const size = static_cast<std::uint32_t>(s.size());
+    payload.append(reinterpret_cast<char const*>(&size), sizeof(size));
+    payload.append(s);
+}
+
+std::optional<int> run_client(int const argc, char** const argv)
+{
+    std::optional<std::filesystem::path> socket;
+    std::vector<std::string_view> args;
+    for (int i = 1; i < argc; ++i)
+    {
+        auto const arg = std::string_view(argv[i]);
+        if (arg.starts_with("--connect="))
+            socket.emplace(arg.substr(10ul));
+        else if (arg == "--connect" and i + 1 < argc)
+            socket.emplace(argv[++i]);
+        else
+            args.push_back(arg);
+    }
+    if (not socket)
+        return std::nullopt;
+    // if the server goes away, report it rather than being killed by SIGPIPE
+    ::signal(SIGPIPE, SIG_IGN);
+    auto const address = make_address(*socket);
+    if (not address)
+        return failure(*socket, "cannot connect to server", address.error());
+    if (auto const ok = check_socket_owner(*socket); not ok)
+        return failure(*socket, "refusing to connect to server", ok.error());
+    int const fd = connect_to(*address);
+    if (fd < 0)
+        return failure(*socket, "cannot connect to server", system_error("connect failed"));
+    std::error_code ec;
+    auto const cwd = std::filesystem::current_path(ec);
+    if (ec)
+        return failure("cannot determine current working directory");
+    std::string payload;
+    append(payload, cwd.native());
+    for (auto const arg: args)
+        append(payload, arg);
+    if (payload.size() > max_request_size)
+        return failure(*socket, "command line is too long to be sent to server");
+    auto size = static_cast<std::uint32_t>(payload.size());
+    auto iov = iovec{&size, sizeof(size)};
+    alignas(cmsghdr) std::array<char, CMSG_SPACE(num_streams * sizeof(int))> control{};
+    auto msg = msghdr{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    auto const cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(num_streams * sizeof(int));
+    std::array<int, num_streams> const streams{STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    std::memcpy(CMSG_DATA(cmsg), streams.data(), sizeof(streams));
+    if (::sendmsg(fd, &msg, 0) != sizeof(size) or not write_all(fd, payload.data(), payload.size()))
+        return failure(*socket, "cannot send request to server", system_error("write failed"));
+    std::int32_t code = 1;
+    if (not read_all(fd, &code, sizeof(code)))
+        return failure(*socket, "lost connection to server");
+    ::close(fd);
+    return code;
+}
+
+/**
+ * Receive a request from the given connection and set up the calling process to run it.
+ *
+ * If the client does not even send its standard streams, for example because it was only checking
+ * whether a server is listening, there is nobody to report an error to; so the calling process just exits.
+ *
+ * @return The command line arguments of the request, excluding the programme name.
+ */
+static dep0::expected<std::vector<std::string>> receive_request(int const conn)
+{
+    std::uint32_t size = 0u;
+    auto iov = iovec{&size, sizeof(size)};
+    alignas(cmsghdr) std::array<char, CMSG_SPACE(num_streams * sizeof(int))> control{};
+    auto msg = msghdr{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    if (::recvmsg(conn, &msg, MSG_WAITALL) != sizeof(size))
+        ::_exit(1);
+    auto const cmsg = CMSG_FIRSTHDR(&msg);
+    if (not cmsg or cmsg->cmsg_level != SOL_SOCKET or cmsg->cmsg_type != SCM_RIGHTS
+        or cmsg->cmsg_len != CMSG_LEN(num_streams * sizeof(int)))
+        ::_exit(1);
+    std::array<int, num_streams> streams{};
+    std::memcpy(streams.data(), CMSG_DATA(cmsg), sizeof(streams));
+    for (auto const i: {0, 1, 2})
+    {
+        ::dup2(streams[i], i);
+        ::close(streams[i]);
+    }
+    if (size > max_request_size)
+        return dep0::error_t("request is too large");
+    std::string payload(size, '\0');
+    if (not read_all(conn, payload.data(), payload.size()))
+        return dep0::error_t("failed to receive request");
+    std::vector<std::string> strings;
+    for (std::size_t pos = 0ul; pos < payload.size(); )
+    {
+        std::uint32_t n = 0u;
+        if (payload.size() - pos < sizeof(n))
+            return dep0::error_t("malformed request");
+        std::memcpy(&n, payload.data() + pos, sizeof(n));
+        pos += sizeof(n);
+        if (payload.size() - pos < n)
+            return dep0::error_t("malformed request");
+        strings.emplace_back(payload, pos, n);
+        pos += n;
+    }
+    if (strings.empty())
+        return dep0::error_t("malformed request");
+    if (::chdir(strings.front().c_str()) < 0)
+        return system_error("cannot change working directory to " + strings.front());
+    strings.erase(strings.begin());
+    return strings;
+}
+
+/** Written to by the SIGCHLD handler and read by the server loop, which can then wait in `poll()` for either event. */
+static int sigchld_pipe[2] = {-1, -1};
+
+static void on_sigchld(int)
+{
+    auto const saved = errno;
+    char const c = 0;
+    [[maybe_unused]] auto const ignored = ::write(sigchld_pipe[1], &c, 1ul);
+    errno = saved;
+}
+
+dep0::expected<std::vector<std::string>> serve(std::filesystem::path const& socket)
+{
+    auto const address = make_address(socket);
+    if (not address)
+        return address.error();
+    // never steal the socket of a server that is still running, but replace the one left behind by a dead server
+    if (int const fd = connect_to(*address); fd >= 0)
+    {
+        ::close(fd);
+        return dep0::error_t("another server is already listening on this socket");
+    }
+    ::unlink(socket.c_str());
+    int const listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        return system_error("cannot create socket");
+    ::fcntl(listener, F_SETFD, FD_CLOEXEC);
+    // requests run with the privileges of the server, so only its own user may connect;
+    // the socket is created without access for anybody else, so that there is no window in which they could
+    auto const old_mask = ::umask(S_IRWXG | S_IRWXO);
+    auto const bound = ::bind(listener, reinterpret_cast<sockaddr const*>(&*address), sizeof(*address));
+    ::umask(old_mask);
+    if (bound < 0)
+        return system_error("cannot bind socket");
+    if (::chmod(socket.c_str(), S_IRUSR | S_IWUSR) < 0)
+        return system_error("cannot change mode of socket");
+    if (::listen(listener, SOMAXCONN) < 0)
+        return system_error("cannot listen on socket");
+    if (::pipe(sigchld_pipe) < 0)
+        return system_error("cannot create pipe");
+    for (int const fd: sigchld_pipe)
+    {
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        ::fcntl(fd, F_SETFL, O_NONBLOCK);
+    }
+    struct sigaction action{};
+    action.sa_handler = on_sigchld;
+    action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    ::sigemptyset(&action.sa_mask);
+    ::sigaction(SIGCHLD, &action, nullptr);
+    // a client that goes away must not kill the server
+    ::signal(SIGPIPE, SIG_IGN);
+
+    std::map<pid_t, int> clients; // connection of each running request, to which its exit code must be sent
+    while (true)
+    {
+        std::array<pollfd, 2> fds{pollfd{listener, POLLIN, 0}, pollfd{sigchld_pipe[0], POLLIN, 0}};
+        if (::poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return system_error("poll failed");
+        }
+        if (fds[1].revents)
+        {
+            char buffer[64];
+            while (::read(sigchld_pipe[0], buffer, sizeof(buffer)) > 0)
+                ;
+            int status = 0;
+            for (pid_t pid; (pid = ::waitpid(-1, &status, WNOHANG)) > 0; )
+                if (auto const it = clients.find(pid); it != clients.end())
+                {
+                    std::int32_t const code =
+                        WIFEXITED(status) ? WEXITSTATUS(status)
+                        : WIFSIGNALED(status) ? 128 + WTERMSIG(status)
+                        : 1;
+                    write_all(it->second, &code, sizeof(code));
+                    ::close(it->second);
+                    clients.erase(it);
+                }
+        }
+        if (not fds[0].revents)
+            continue;
+        int const conn = ::accept(listener, nullptr, nullptr);
+        if (conn < 0)
+            continue;
+        if (not is_same_user(conn))
+        {
+            // the mode of the socket should prevent this, unless it was changed; the client sees a lost connection
+            ::close(conn);
+            continue;
+        }
+        ::fcntl(conn, F_SETFD, FD_CLOEXEC);
+        pid_t const pid = ::fork();
+        if (pid < 0)
+        {
+            ::close(conn); // the client will report that it lost the connection
+            continue;
+        }
+        if (pid == 0)
+        {
+            // the request must start from the state of the server at startup, with nothing of the server loop
+            ::signal(SIGCHLD, SIG_DFL);
+            ::signal(SIGPIPE, SIG_DFL);
+            ::close(listener);
+            for (int const fd: sigchld_pipe)
+                ::close(fd);
+            for (auto const& [_, fd]: clients)
+                ::close(fd);
+            auto request = receive_request(conn);
+            ::close(conn);
+            return request;
+        }
+        clients.emplace(pid, conn);
+    }
+}
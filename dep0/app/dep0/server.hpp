@@ -0,0 +1,51 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Server and client sides of `dep0 --server=<socket>` and `dep0 --connect=<socket>`.
+ *
+ * A server initializes everything that does not depend on the command line only once, at startup,
+ * and then forks a new process for each request it receives over a Unix domain socket.
+ * Each request consists of the command line arguments, working directory and standard streams of a client,
+ * so the forked process behaves exactly like a fresh invocation of the compiler from the client,
+ * except that it starts from the warm state of the server.
+ * Because each request runs in its own process, any state it builds, or any crash, cannot affect the next one.
+ * Requests run with the privileges of the server, so the socket is only accessible by the user that started it;
+ * connections from other users are dropped and a client refuses a socket that other users could access.
+ */
+#pragma once
+
+#include "dep0/error.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * If the command line contains `--connect=<socket>` (or `--connect <socket>`), send all other arguments,
+ * together with the current working directory and standard streams, to the server listening on that socket
+ * and wait for it to process them.
+ *
+ * This is meant to be called at the very beginning of `main()`, before any expensive initialization.
+ *
+ * @return The exit code of the request, which is 1 if the server could not be contacted,
+ * or empty if the command line does not contain `--connect`.
+ */
+std::optional<int> run_client(int argc, char** argv);
+
+/**
+ * Listen for requests on the given Unix domain socket and fork a new process for each one.
+ *
+ * In the server process, this function only returns if the server could not be started or it fails;
+ * for example, if another server is already listening on the same socket.
+ * In each forked process instead, it returns the command line arguments of the request, excluding the programme name,
+ * after redirecting the standard streams to the ones of the client and moving into its working directory;
+ * or an error, which is then reported to the client, if the request is malformed.
+ * The forked process must then run the request and exit; its exit code is forwarded to the client.
+ */
+dep0::expected<std::vector<std::string>> serve(std::filesystem::path const& socket);
@@ -0,0 +1,189 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_MODULE dep0_server_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "server.hpp"
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+/** Exit code of every request run by the test server, so that a client can tell that its request was run. */
+static constexpr int request_exit_code = 42;
+
+static sockaddr_un make_address(fs::path const& socket)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, socket.c_str());
+    return address;
+}
+
+/**
+ * Send a request with no arguments to the server listening on the given socket, bypassing the checks of the client.
+ *
+ * @return The exit code sent back by the server, or empty if it closed the connection without replying.
+ */
+static std::optional<int> send_request(fs::path const& socket)
+{
+    int const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    auto const address = make_address(socket);
+    if (fd < 0 or ::connect(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) < 0)
+        return std::nullopt;
+    // same format as `run_client()`, with "/" as working directory, which every user can enter
+    std::string payload;
+    std::uint32_t const cwd_size = 1u;
+    payload.append(reinterpret_cast<char const*>(&cwd_size), sizeof(cwd_size));
+    payload.append("/");
+    auto size = static_cast<std::uint32_t>(payload.size());
+    auto iov = iovec{&size, sizeof(size)};
+    std::array<int, 3> const streams{STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(streams))> control{};
+    auto msg = msghdr{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    auto const cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(streams));
+    std::memcpy(CMSG_DATA(cmsg), streams.data(), sizeof(streams));
+    std::int32_t code = 0;
+    // the server may close the connection as soon as it is accepted, so writing or reading may fail
+    bool const ok =
+        ::sendmsg(fd, &msg, MSG_NOSIGNAL) == sizeof(size)
+        and ::send(fd, payload.data(), payload.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(payload.size())
+        and ::recv(fd, &code, sizeof(code), MSG_WAITALL) == sizeof(code);
+    ::close(fd);
+    return ok ? std::optional{code} : std::nullopt;
+}
+
+struct fixture
+{
+    fs::path dir;
+    fs::path socket;
+    pid_t server = -1;
+
+    fixture()
+    {
+        std::string tmp = (fs::temp_directory_path() / "dep0_server_tests_XXXXXX").native();
+        BOOST_TEST_REQUIRE(::mkdtemp(tmp.data()));
+        dir = tmp;
+        socket = dir / "server.sock";
+    }
+
+    ~fixture()
+    {
+        if (server > 0)
+        {
+            ::kill(server, SIGTERM);
+            ::waitpid(server, nullptr, 0);
+        }
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+
+    /** Fork a server listening on `socket`, whose requests all exit with `request_exit_code`, and wait for it. */
+    void start_server()
+    {
+        server = ::fork();
+        BOOST_TEST_REQUIRE(server >= 0);
+        if (server == 0)
+        {
+            auto const request = serve(socket);
+            ::_exit(request ? request_exit_code : 1);
+        }
+        auto const address = make_address(socket);
+        for (int attempt = 0; attempt < 1000; ++attempt)
+        {
+            int const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            bool const connected = ::connect(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == 0;
+            ::close(fd);
+            if (connected)
+                return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        BOOST_FAIL("server did not start");
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(dep0_server_tests, fixture)
+
+BOOST_AUTO_TEST_CASE(socket_is_private)
+{
+    start_server();
+    struct stat st{};
+    BOOST_TEST_REQUIRE(::lstat(socket.c_str(), &st) == 0);
+    BOOST_TEST(S_ISSOCK(st.st_mode));
+    BOOST_TEST(st.st_uid == ::getuid());
+    BOOST_TEST((st.st_mode & 0777) == 0600);
+    BOOST_TEST((send_request(socket) == std::optional{request_exit_code}));
+}
+
+BOOST_AUTO_TEST_CASE(client_refuses_socket_accessible_by_others)
+{
+    // not a real server, so that it is possible to tell whether the client even tried to connect
+    int const listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    auto const address = make_address(socket);
+    BOOST_TEST_REQUIRE(::bind(listener, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == 0);
+    BOOST_TEST_REQUIRE(::listen(listener, 1) == 0);
+    BOOST_TEST_REQUIRE(::chmod(socket.c_str(), 0666) == 0);
+    auto connect_arg = "--connect=" + socket.native();
+    std::array<char*, 3> argv{const_cast<char*>("dep0"), connect_arg.data(), const_cast<char*>("--help")};
+    BOOST_TEST((run_client(static_cast<int>(argv.size()), argv.data()) == std::optional{1}));
+    BOOST_TEST(::accept(listener, nullptr, nullptr) < 0);
+    BOOST_TEST(errno == EAGAIN);
+    ::close(listener);
+}
+
+BOOST_AUTO_TEST_CASE(server_refuses_other_user)
+{
+    if (::getuid() != 0)
+    {
+        BOOST_TEST_MESSAGE("skipping because connecting as another user requires running as root");
+        return;
+    }
+    start_server();
+    // let the other user reach the socket, so that only the server itself can refuse the connection
+    fs::permissions(dir, fs::perms::others_exec, fs::perm_options::add);
+    BOOST_TEST_REQUIRE(::chmod(socket.c_str(), 0666) == 0);
+    pid_t const client = ::fork();
+    BOOST_TEST_REQUIRE(client >= 0);
+    if (client == 0)
+    {
+        uid_t const nobody = 65534;
+        if (::setgid(nobody) < 0 or ::setuid(nobody) < 0)
+            ::_exit(2);
+        ::_exit(send_request(socket) ? 1 : 0);
+    }
+    int status = 0;
+    BOOST_TEST_REQUIRE(::waitpid(client, &status, 0) == client);
+    BOOST_TEST_REQUIRE(WIFEXITED(status));
+    BOOST_TEST(WEXITSTATUS(status) == 0);
+    // the server is still running and serving its own user
+    BOOST_TEST((send_request(socket) == std::optional{request_exit_code}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
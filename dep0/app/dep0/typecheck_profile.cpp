@@ -0,0 +1,76 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "typecheck_profile.hpp"
+
+#include <llvm/Support/Format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <tuple>
+
+static double milliseconds(std::chrono::nanoseconds const x)
+{
+    return std::chrono::duration<double, std::milli>(x).count();
+}
+
+void typecheck_profile_t::add(
+    std::filesystem::path const& file,
+    std::vector<dep0::typecheck::func_profile_t> profiles)
+{
+    auto const lock = std::lock_guard(m_mutex);
+    for (auto& x: profiles)
+        m_entries.push_back(entry_t{file, std::move(x)});
+}
+
+void typecheck_profile_t::print(llvm::raw_ostream& os) const
+{
+    auto const lock = std::lock_guard(m_mutex);
+    std::vector<entry_t const*> entries;
+    entries.reserve(m_entries.size());
+    for (auto const& x: m_entries)
+        entries.push_back(&x);
+    // ties are broken by position, so that the report is stable across runs with many cheap functions
+    std::ranges::sort(entries, [] (entry_t const* const a, entry_t const* const b)
+    {
+        if (a->profile.time != b->profile.time)
+            return a->profile.time > b->profile.time;
+        return std::tie(a->file, a->profile.origin.line) < std::tie(b->file, b->profile.origin.line);
+    });
+    auto const row =
+        [&] (
+            std::chrono::nanoseconds const time,
+            std::chrono::nanoseconds const proof_search_time,
+            std::size_t const goals,
+            std::size_t const tasks,
+            std::chrono::nanoseconds const normalization_time,
+            std::size_t const normalizations) -> llvm::raw_ostream&
+        {
+            return os << llvm::format(
+                "%12.3f %12.3f %8zu %10zu %12.3f %10zu  ",
+                milliseconds(time), milliseconds(proof_search_time), goals, tasks,
+                milliseconds(normalization_time), normalizations);
+        };
+    os << "typecheck profile (times in milliseconds; proof search and normalization overlap):\n";
+    os << "       total proof search    goals      tasks  normalizing normalized  function\n";
+    std::chrono::nanoseconds time{}, proof_search_time{}, normalization_time{};
+    std::size_t goals = 0ul, tasks = 0ul, normalizations = 0ul;
+    for (auto const* const x: entries)
+    {
+        auto const& p = x->profile;
+        row(p.time, p.proof_search_time, p.proof_search_goals, p.proof_search_tasks,
+            p.normalization_time, p.normalizations)
+            << x->file.native() << ':' << p.origin.line << ':' << p.origin.col << ": " << p.name.view() << '\n';
+        time += p.time;
+        proof_search_time += p.proof_search_time;
+        goals += p.proof_search_goals;
+        tasks += p.proof_search_tasks;
+        normalization_time += p.normalization_time;
+        normalizations += p.normalizations;
+    }
+    row(time, proof_search_time, goals, tasks, normalization_time, normalizations)
+        << "total of " << entries.size() << " functions\n";
+}
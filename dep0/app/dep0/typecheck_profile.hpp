@@ -0,0 +1,41 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#pragma once
+
+#include "dep0/typecheck/profile.hpp"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+/**
+ * Collects the profile of every function definition typechecked by a job, from any number of input files
+ * which might be typechecked concurrently, so that it can be reported in one go once the job is finished.
+ */
+class typecheck_profile_t
+{
+    struct entry_t
+    {
+        std::filesystem::path file;
+        dep0::typecheck::func_profile_t profile;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<entry_t> m_entries;
+
+public:
+    /** Add the profile of all function definitions typechecked in the given file. */
+    void add(std::filesystem::path const&, std::vector<dep0::typecheck::func_profile_t>);
+
+    /**
+     * Print one line for each function definition collected so far, from the most to the least expensive one,
+     * followed by the totals across all of them.
+     */
+    void print(llvm::raw_ostream&) const;
+};
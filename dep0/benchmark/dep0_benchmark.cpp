@@ -0,0 +1,382 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Measures the time spent, and the number of heap allocations made, by each stage of the compiler.
+ *
+ * Usage:
+ * `dep0_benchmark [--iterations=N] [--normalizer=<alg>] [--parser=<impl>] [--parser-prediction=<mode>]
+ *     [--arena=on|off] [--output=<csv>] [--baseline=<csv>] [--threshold=P] <files>...`
+ *
+ * Every input file is parsed, typechecked, transformed, converted to LLVM IR and compiled to an object file,
+ * `N` times (by default 5), each time from scratch.
+ * For each file and each stage, it reports the fastest time and the number of heap allocations of the fastest run,
+ * both in human readable form and, if requested, in a CSV file which can later be passed back as baseline.
+ * If a baseline is given, the total time of each stage is compared against it and,
+ * if any stage is slower than the baseline by more than `P` percent (by default 10), the exit code is 1.
+ * Only files that appear in both the baseline and the current run are compared.
+ * The normalizer, either `substitution` (by default) or `evaluation`, is used by both typecheck and transform stages;
+ * so a baseline taken with one can be compared against a run with the other.
+ * Likewise, the parser can be either `antlr` (by default) or `recursive-descent`
+ * and the prediction mode of the former either `two-stage` (by default) or `ll`.
+ * As in the compiler, each file is processed with its own AST arena active, unless `--arena=off` is given;
+ * because this changes the number of heap allocations, the mode is written into the CSV file
+ * and a warning is printed if the baseline was taken with a different one.
+ */
+#include "dep0/arena.hpp"
+#include "dep0/compile/compile.hpp"
+#include "dep0/compile/optimize.hpp"
+#include "dep0/llvmgen/gen.hpp"
+#include "dep0/parser/parse.hpp"
+#include "dep0/transform/beta_delta_normalization.hpp"
+#include "dep0/transform/run.hpp"
+#include "dep0/typecheck/beta_delta_reduction.hpp"
+#include "dep0/typecheck/check.hpp"
+#include "dep0/typecheck/environment.hpp"
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+static std::atomic<std::size_t> num_heap_allocations = 0ul;
+
+void* operator new(std::size_t const size)
+{
+    num_heap_allocations.fetch_add(1ul, std::memory_order_relaxed);
+    if (auto const p = std::malloc(size > 0ul ? size : 1ul))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* const p) noexcept { std::free(p); }
+void operator delete(void* const p, std::size_t) noexcept { std::free(p); }
+
+static constexpr auto stage_names = std::array{"parse", "typecheck", "transform", "llvmgen", "compile"};
+static constexpr std::size_t num_stages = stage_names.size();
+
+/** Time and heap allocations of one stage, for one file. */
+struct measurement_t
+{
+    std::chrono::microseconds time;
+    std::size_t allocations;
+};
+
+/** Results of all stages that completed successfully for one file; failed or skipped stages are left empty. */
+using file_results_t = std::array<std::optional<measurement_t>, num_stages>;
+
+/** Results of a whole run, or of a baseline, keyed by input file. */
+using results_t = std::map<std::string, file_results_t>;
+
+/** A baseline read back from a CSV file, together with the arena mode it was taken with. */
+struct baseline_t
+{
+    bool ast_arena;
+    results_t results;
+};
+
+/**
+ * Run the given function and store its time and allocations in the given result,
+ * unless a faster run of the same stage had already been recorded.
+ *
+ * @return Whatever the given function returned.
+ */
+template <typename F>
+static auto measure(std::optional<measurement_t>& result, F&& f)
+{
+    auto const allocations_before = num_heap_allocations.load(std::memory_order_relaxed);
+    auto const start = std::chrono::steady_clock::now();
+    auto x = std::forward<F>(f)();
+    auto const end = std::chrono::steady_clock::now();
+    auto const elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    auto const allocations = num_heap_allocations.load(std::memory_order_relaxed) - allocations_before;
+    if (not result or elapsed < result->time)
+        result = measurement_t{elapsed, allocations};
+    return x;
+}
+
+/**
+ * Run all stages on the given file once, recording into the given results all stages that succeeded.
+ * If `ast_arena` is set, the file is processed with its own `dep0::arena_t` active, like the compiler does.
+ *
+ * @return True if all stages succeeded; false otherwise.
+ */
+static bool run_once(
+    std::filesystem::path const& f,
+    dep0::typecheck::env_t const& base_env,
+    dep0::parser::parse_options_t const& parse_options,
+    dep0::typecheck::check_options_t const& check_options,
+    bool const ast_arena,
+    llvm::TargetMachine& machine,
+    file_results_t& results)
+{
+    // declared before anything allocated from it, so that all AST nodes are released before the arena
+    auto arena = std::optional<dep0::arena_t>{};
+    auto const scope = ast_arena ? dep0::arena_scope_t(arena.emplace()) : dep0::arena_scope_t(nullptr);
+    // each file gets its own LLVM context, like the compiler does, so nothing is reused across iterations
+    llvm::LLVMContext llvm_ctx;
+    auto const parsed = measure(results[0], [&] { return dep0::parser::parse(f, parse_options); });
+    if (not parsed)
+        return false;
+    auto checked = measure(results[1], [&] { return dep0::typecheck::check(base_env, *parsed, check_options); });
+    if (not checked)
+        return false;
+    auto const transformed = measure(results[2], [&]
+    {
+        auto const normalizer_scope = dep0::typecheck::normalizer_scope_t(check_options.normalizer);
+        return dep0::transform::run(*checked, dep0::transform::beta_delta_normalization_t{});
+    });
+    if (not transformed)
+        return false;
+    auto llvm_module =
+        measure(results[3], [&] { return dep0::llvmgen::gen(llvm_ctx, f.filename().native(), *checked, machine); });
+    if (not llvm_module)
+        return false;
+    auto const object_file = measure(results[4], [&]
+    {
+        dep0::compile::optimize(llvm_module->get(), machine, dep0::compile::opt_level_t::O0);
+        return dep0::compile::compile_and_assemble(llvm_module->get(), machine);
+    });
+    return object_file.has_value();
+}
+
+static void write_csv(std::ostream& os, bool const ast_arena, results_t const& results)
+{
+    os << "# arena=" << (ast_arena ? "on" : "off") << '\n';
+    os << "file,stage,time_us,allocations\n";
+    for (auto const& [file, stages]: results)
+        for (std::size_t i = 0ul; i < num_stages; ++i)
+            if (stages[i])
+                os << file << ',' << stage_names[i] << ',' << stages[i]->time.count() << ','
+                   << stages[i]->allocations << '\n';
+}
+
+/**
+ * Parse the CSV previously produced by `write_csv()` or return an empty optional if it is malformed.
+ * Files without the arena line predate the `--arena` option, when the benchmark never used an arena.
+ */
+static std::optional<baseline_t> read_csv(std::istream& is)
+{
+    auto ast_arena = false;
+    results_t results;
+    std::string line;
+    if (not std::getline(is, line))
+        return std::nullopt;
+    if (line == "# arena=on" or line == "# arena=off")
+    {
+        ast_arena = line == "# arena=on";
+        if (not std::getline(is, line))
+            return std::nullopt;
+    }
+    if (line != "file,stage,time_us,allocations")
+        return std::nullopt;
+    while (std::getline(is, line))
+    {
+        // file names might contain commas but stage names and numbers cannot, so split from the right
+        auto const c3 = line.rfind(',');
+        auto const c2 = c3 == std::string::npos or c3 == 0ul ? std::string::npos : line.rfind(',', c3 - 1ul);
+        auto const c1 = c2 == std::string::npos or c2 == 0ul ? std::string::npos : line.rfind(',', c2 - 1ul);
+        if (c1 == std::string::npos)
+            return std::nullopt;
+        auto const stage = std::string_view(line).substr(c2 + 1ul, c3 - c2 - 1ul);
+        auto const it = std::ranges::find(stage_names, stage);
+        if (it == stage_names.end())
+            return std::nullopt;
+        results[line.substr(0ul, c1)][it - stage_names.begin()] = measurement_t{
+            std::chrono::microseconds(std::strtoll(line.c_str() + c1 + 1ul, nullptr, 10)),
+            std::strtoull(line.c_str() + c3 + 1ul, nullptr, 10)};
+    }
+    return baseline_t{ast_arena, std::move(results)};
+}
+
+/**
+ * Print, for each stage, the total time and allocations of the current run next to the baseline.
+ *
+ * @return True if no stage is slower than the baseline by more than the given threshold (in percent).
+ */
+static bool compare(results_t const& current, results_t const& baseline, double const threshold)
+{
+    std::array<measurement_t, num_stages> totals{};
+    std::array<measurement_t, num_stages> baseline_totals{};
+    for (auto const& [file, stages]: current)
+        if (auto const it = baseline.find(file); it != baseline.end())
+            for (std::size_t i = 0ul; i < num_stages; ++i)
+                if (stages[i] and it->second[i])
+                {
+                    totals[i].time += stages[i]->time;
+                    totals[i].allocations += stages[i]->allocations;
+                    baseline_totals[i].time += it->second[i]->time;
+                    baseline_totals[i].allocations += it->second[i]->allocations;
+                }
+    bool ok = true;
+    std::cout << "\ncomparison against baseline:\n";
+    for (std::size_t i = 0ul; i < num_stages; ++i)
+    {
+        auto const now = static_cast<double>(totals[i].time.count());
+        auto const before = static_cast<double>(baseline_totals[i].time.count());
+        auto const delta = before > 0.0 ? (now - before) * 100.0 / before : 0.0;
+        bool const regressed = delta > threshold;
+        ok = ok and not regressed;
+        std::cout
+            << std::left << std::setw(12) << stage_names[i] << std::right
+            << std::setw(10) << baseline_totals[i].time.count() << " us -> "
+            << std::setw(10) << totals[i].time.count() << " us ("
+            << std::showpos << std::fixed << std::setprecision(1) << delta << std::noshowpos << "%), "
+            << baseline_totals[i].allocations << " -> " << totals[i].allocations << " allocations"
+            << (regressed ? "  REGRESSION" : "") << '\n';
+    }
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t iterations = 5ul;
+    double threshold = 10.0;
+    bool ast_arena = true;
+    dep0::parser::parse_options_t parse_options;
+    dep0::typecheck::check_options_t check_options;
+    std::optional<std::filesystem::path> output;
+    std::optional<std::filesystem::path> baseline_file;
+    std::vector<std::filesystem::path> input_files;
+    for (std::string_view const arg: std::views::counted(argv + 1, argc - 1))
+        if (arg.starts_with("--iterations="))
+            iterations = std::max(std::strtoul(arg.substr(13).data(), nullptr, 10), 1ul);
+        else if (arg == "--normalizer=substitution")
+            check_options.normalizer = dep0::typecheck::normalizer_t::substitution;
+        else if (arg == "--normalizer=evaluation")
+            check_options.normalizer = dep0::typecheck::normalizer_t::evaluation;
+        else if (arg == "--parser=antlr")
+            parse_options.front_end = dep0::parser::front_end_t::antlr;
+        else if (arg == "--parser=recursive-descent")
+            parse_options.front_end = dep0::parser::front_end_t::recursive_descent;
+        else if (arg == "--parser-prediction=two-stage")
+            parse_options.prediction_mode = dep0::parser::prediction_mode_t::two_stage;
+        else if (arg == "--parser-prediction=ll")
+            parse_options.prediction_mode = dep0::parser::prediction_mode_t::ll;
+        else if (arg == "--arena=on")
+            ast_arena = true;
+        else if (arg == "--arena=off")
+            ast_arena = false;
+        else if (arg.starts_with("--output="))
+            output.emplace(arg.substr(9));
+        else if (arg.starts_with("--baseline="))
+            baseline_file.emplace(arg.substr(11));
+        else if (arg.starts_with("--threshold="))
+            threshold = std::strtod(arg.substr(12).data(), nullptr);
+        else
+            input_files.emplace_back(arg);
+    if (input_files.empty())
+    {
+        std::cerr << "usage: dep0_benchmark [--iterations=N] [--normalizer=substitution|evaluation] "
+                     "[--parser=antlr|recursive-descent] [--parser-prediction=two-stage|ll] [--arena=on|off] "
+                     "[--output=<csv>] [--baseline=<csv>] [--threshold=P] <input-files>...\n";
+        return 1;
+    }
+
+    std::optional<baseline_t> baseline;
+    if (baseline_file)
+    {
+        auto is = std::ifstream(*baseline_file);
+        baseline = read_csv(is);
+        if (not baseline)
+        {
+            std::cerr << "cannot read baseline from " << *baseline_file << std::endl;
+            return 1;
+        }
+    }
+
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    auto const triple = llvm::sys::getDefaultTargetTriple();
+    std::string err;
+    auto const target = llvm::TargetRegistry::lookupTarget(triple, err);
+    if (not target)
+    {
+        std::cerr << "cannot find target " << triple << ": " << err << std::endl;
+        return 1;
+    }
+    auto const machine = std::unique_ptr<llvm::TargetMachine>(
+        target->createTargetMachine(triple, "generic", "", llvm::TargetOptions{}, llvm::Reloc::Model::PIC_));
+
+    auto const base_env = dep0::typecheck::make_base_env();
+    if (not base_env)
+    {
+        std::cerr << "failed to build the base environment" << std::endl;
+        return 1;
+    }
+
+    results_t results;
+    std::size_t num_failures = 0ul;
+    for (auto const& f: input_files)
+    {
+        auto& file_results = results[f.native()];
+        for (std::size_t i = 0ul; i < iterations; ++i)
+            if (not run_once(f, *base_env, parse_options, check_options, ast_arena, *machine, file_results))
+            {
+                // a failure is deterministic, so there is no point repeating it
+                ++num_failures;
+                break;
+            }
+    }
+
+    std::cout << "input files: " << input_files.size() << " (of which " << num_failures << " failed)\n";
+    std::cout << "iterations:  " << iterations << '\n';
+    std::cout << "arena:       " << (ast_arena ? "on" : "off") << "\n\n";
+    std::cout << std::left << std::setw(12) << "stage" << std::right << std::setw(14) << "time" << std::setw(16)
+              << "allocations" << '\n';
+    for (std::size_t i = 0ul; i < num_stages; ++i)
+    {
+        auto total = measurement_t{};
+        for (auto const& stages: results | std::views::values)
+            if (stages[i])
+            {
+                total.time += stages[i]->time;
+                total.allocations += stages[i]->allocations;
+            }
+        std::cout << std::left << std::setw(12) << stage_names[i] << std::right
+                  << std::setw(11) << total.time.count() << " us" << std::setw(16) << total.allocations << '\n';
+    }
+
+    if (output)
+    {
+        auto os = std::ofstream(*output);
+        write_csv(os, ast_arena, results);
+        if (not os)
+        {
+            std::cerr << "cannot write results to " << *output << std::endl;
+            return 1;
+        }
+        std::cout << "\nresults written to " << *output << '\n';
+    }
+    if (baseline and baseline->ast_arena != ast_arena)
+        std::cout << "\nwarning: baseline taken with --arena=" << (baseline->ast_arena ? "on" : "off")
+                  << ", so heap allocations are not comparable\n";
+    if (baseline and not compare(results, baseline->results, threshold))
+        return 1;
+    return 0;
+}
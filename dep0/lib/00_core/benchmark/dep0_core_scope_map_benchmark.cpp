@@ -0,0 +1,136 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Compares `dep0::scope_map` against its previous implementation, which had one `std::map` per scope level.
+ *
+ * Usage: `dep0_core_scope_map_benchmark [--iterations=N]`
+ *
+ * Each scenario is repeated `N` times (by default 20) and the fastest time per operation is reported:
+ *   - `insert`: insert many entries in the same scope;
+ *   - `lookup (flat)`: look up all those entries from the same scope;
+ *   - `lookup (nested)`: look up, from the innermost scope, entries declared at every level of a deep nesting,
+ *     which is what happens for example inside deeply nested if/else bodies;
+ *   - `extend`: extend a scope and insert one new entry in the new scope,
+ *     both for a small scope, like a typical typing context, and for a large one, like a big environment.
+ */
+#include "tree_scope_map.hpp"
+
+#include "dep0/scope_map.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static std::size_t const num_keys = 1000ul;
+static std::size_t const nesting_depth = 200ul;
+static std::size_t const keys_per_level = 2ul;
+static std::size_t const small_scope_size = 16ul;
+
+/** Prevents the compiler from optimizing away the result of lookups. */
+static volatile std::size_t sink = 0ul;
+
+/** Run the given function `iterations` times and return the fastest time in nanoseconds per operation. */
+template <typename F>
+static double fastest(std::size_t const iterations, std::size_t const ops_per_run, F&& f)
+{
+    auto best = std::chrono::steady_clock::duration::max();
+    for (std::size_t i = 0ul; i < iterations; ++i)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        f();
+        best = std::min(best, std::chrono::steady_clock::now() - start);
+    }
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(best).count()) / ops_per_run;
+}
+
+template <typename Map>
+static Map make_flat(std::vector<std::string> const& keys)
+{
+    Map m;
+    for (std::size_t i = 0ul; i < keys.size(); ++i)
+        m.try_emplace(keys[i], i);
+    return m;
+}
+
+template <typename Map>
+static std::vector<double> run_all(std::size_t const iterations, std::vector<std::string> const& keys)
+{
+    std::vector<double> results;
+    results.push_back(fastest(iterations, num_keys, [&] { make_flat<Map>(keys); }));
+
+    auto const flat = make_flat<Map>(keys);
+    results.push_back(fastest(iterations, num_keys, [&]
+    {
+        for (auto const& k: keys)
+            sink = sink + *flat[k];
+    }));
+
+    // each level extends the previous one, which must stay alive, like nested typing contexts do
+    std::vector<Map> levels;
+    levels.emplace_back();
+    for (std::size_t d = 0ul, i = 0ul; d < nesting_depth; ++d)
+    {
+        levels.push_back(levels.back().extend());
+        for (std::size_t j = 0ul; j < keys_per_level; ++j, ++i)
+            levels.back().try_emplace(keys[i], i);
+    }
+    auto const num_nested_keys = nesting_depth * keys_per_level;
+    results.push_back(fastest(iterations, num_nested_keys, [&]
+    {
+        for (std::size_t i = 0ul; i < num_nested_keys; ++i)
+            sink = sink + *levels.back()[keys[i]];
+    }));
+
+    auto const small = make_flat<Map>(std::vector(keys.begin(), keys.begin() + small_scope_size));
+    for (auto const* const outer: {&small, &flat})
+        results.push_back(fastest(iterations, num_keys, [&]
+        {
+            for (std::size_t i = 0ul; i < num_keys; ++i)
+            {
+                auto inner = outer->extend();
+                inner.try_emplace(keys[i], i);
+            }
+        }));
+    return results;
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t iterations = 20ul;
+    for (int i = 1; i < argc; ++i)
+        if (auto const arg = std::string_view(argv[i]); arg.starts_with("--iterations="))
+            iterations = std::max(std::strtoul(arg.substr(13).data(), nullptr, 10), 1ul);
+        else
+        {
+            std::cerr << "usage: dep0_core_scope_map_benchmark [--iterations=N]\n";
+            return 1;
+        }
+
+    std::vector<std::string> keys;
+    for (std::size_t i = 0ul; i < std::max(num_keys, nesting_depth * keys_per_level); ++i)
+        keys.push_back("x" + std::to_string(i));
+
+    auto const before = run_all<dep0::benchmark::tree_scope_map<std::string, std::size_t>>(iterations, keys);
+    auto const after = run_all<dep0::scope_map<std::string, std::size_t>>(iterations, keys);
+    char const* const names[] = {"insert", "lookup (flat)", "lookup (nested)", "extend (small)", "extend (large)"};
+    std::cout
+        << std::left << std::setw(18) << "operation" << std::right
+        << std::setw(14) << "tree (ns/op)" << std::setw(14) << "trie (ns/op)" << std::setw(10) << "speedup" << '\n'
+        << std::fixed << std::setprecision(1);
+    for (std::size_t i = 0ul; i < before.size(); ++i)
+        std::cout
+            << std::left << std::setw(18) << names[i] << std::right
+            << std::setw(14) << before[i] << std::setw(14) << after[i]
+            << std::setw(9) << before[i] / after[i] << "x\n";
+    return 0;
+}
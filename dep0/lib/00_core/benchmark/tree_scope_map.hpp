@@ -0,0 +1,78 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief The previous implementation of `dep0::scope_map`, kept only as a reference for the benchmark.
+ *
+ * Each scope level has its own `std::map` index, so lookups walk the chain of parent levels.
+ * Only the operations measured by the benchmark are retained.
+ */
+#pragma once
+
+#include <deque>
+#include <limits>
+#include <map>
+#include <memory>
+#include <utility>
+
+namespace dep0::benchmark {
+
+template <typename K, typename V>
+class tree_scope_map
+{
+    using data_map = std::deque<std::pair<K const, V>>;
+
+    struct state_t
+    {
+        std::shared_ptr<state_t> parent;
+        std::size_t max_parent_index = std::numeric_limits<std::size_t>::max();
+        data_map data;
+        std::map<K, std::size_t> index;
+
+        state_t() = default;
+        state_t(std::shared_ptr<state_t> parent, std::size_t const max_parent_index)
+            : parent(std::move(parent)), max_parent_index(max_parent_index)
+        { }
+    };
+    std::shared_ptr<state_t> state;
+
+    explicit tree_scope_map(std::shared_ptr<state_t> p) : state(std::move(p)) { }
+
+public:
+    tree_scope_map() : state(std::make_shared<state_t>()) { }
+
+    tree_scope_map extend() const
+    {
+        return tree_scope_map(std::make_shared<state_t>(state, state->data.size()));
+    }
+
+    template <typename... Args>
+    bool try_emplace(K k, Args&&... args)
+    {
+        auto const [it_index, inserted] = state->index.try_emplace(k, state->data.size());
+        if (inserted)
+            state->data.emplace_back(std::move(k), V{std::forward<Args>(args)...});
+        return inserted;
+    }
+
+    V const* operator[](K const& k) const
+    {
+        auto const* s = state.get();
+        auto max_index = std::numeric_limits<std::size_t>::max();
+        do
+        {
+            if (auto const it = s->index.find(k); it != s->index.end() and it->second < max_index)
+                return &s->data[it->second].second;
+            max_index = s->max_parent_index;
+            s = s->parent.get();
+        }
+        while (s);
+        return nullptr;
+    }
+};
+
+} // namespace dep0::benchmark
@@ -0,0 +1,92 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Defines `dep0::arena_t` and `dep0::arena_scope_t`.
+ */
+#pragma once
+
+#include <cstddef>
+
+namespace dep0 {
+
+/** @cond DEP0_DOXYGEN_HIDE */
+namespace impl {
+
+struct arena_state_t;
+
+/**
+ * Allocate a block of the given size from the arena currently active in the calling thread,
+ * or from the heap if there is none.
+ * The returned block is suitably aligned for any object whose alignment does not exceed `std::max_align_t`.
+ */
+void* arena_allocate(std::size_t);
+
+/** Release a block previously returned from `arena_allocate()` with the same size. */
+void arena_deallocate(void*, std::size_t) noexcept;
+
+} // namespace impl
+/** @endcond */
+
+/**
+ * @brief A pool of memory from which many small objects, typically AST nodes, can be allocated very cheaply.
+ *
+ * Memory is reserved in big chunks and handed out by simply bumping a pointer;
+ * blocks that are released are kept in a free-list, per size, ready to be reused for the next allocation.
+ * All chunks are returned to the heap in one shot, only when the arena and every block allocated from it are gone,
+ * so it is always safe for an object allocated from an arena to outlive the `arena_t` object itself.
+ *
+ * An arena is not used directly but it must be activated in the current thread via `arena_scope_t`;
+ * after that, all `dep0::recursive_wrapper` objects created by the same thread are allocated from it.
+ *
+ * @remarks An arena must not be active in more than one thread at the same time.
+ * Blocks can be released from any thread but they are reused only if released whilst their arena is active.
+ */
+class arena_t
+{
+    friend class arena_scope_t;
+
+    impl::arena_state_t* m_state;
+
+public:
+    /** @brief Statistics about the memory used by an arena, for example to compare with heap allocation. */
+    struct statistics_t
+    {
+        std::size_t num_allocations; /**< @brief Total number of blocks allocated, including reused ones. */
+        std::size_t num_reused; /**< @brief Number of blocks allocated by reusing a previously released one. */
+        std::size_t reserved_bytes; /**< @brief Total size of all chunks reserved from the heap. */
+    };
+
+    arena_t();
+    arena_t(arena_t const&) = delete;
+    arena_t& operator=(arena_t const&) = delete;
+    ~arena_t();
+
+    statistics_t statistics() const;
+};
+
+/**
+ * @brief RAII object that activates an arena in the calling thread, until it is destroyed.
+ *
+ * Scopes can be nested and the previously active arena, if any, is restored on destruction.
+ * Passing `nullptr` deactivates any arena, so that the following allocations are made from the heap;
+ * this is useful for objects that live for the whole process, which would otherwise keep their arena alive.
+ */
+class arena_scope_t
+{
+    impl::arena_state_t* m_previous;
+    impl::arena_state_t* m_current;
+
+public:
+    explicit arena_scope_t(arena_t&);
+    explicit arena_scope_t(std::nullptr_t);
+    arena_scope_t(arena_scope_t const&) = delete;
+    arena_scope_t& operator=(arena_scope_t const&) = delete;
+    ~arena_scope_t();
+};
+
+} // namespace dep0
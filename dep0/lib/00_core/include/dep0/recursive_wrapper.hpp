@@ -0,0 +1,98 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Defines `dep0::recursive_wrapper`.
+ */
+#pragma once
+
+#include "dep0/arena.hpp"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace dep0 {
+
+/**
+ * @brief Drop-in replacement for `boost::recursive_wrapper`, used to define recursive types like the AST.
+ *
+ * The wrapped value is allocated from the arena active in the current thread, if any, or from the heap otherwise.
+ * Like `boost::recursive_wrapper`, it always contains a value, even after being moved from.
+ *
+ * @see `dep0::arena_t`
+ */
+template <typename T>
+class recursive_wrapper
+{
+    T* m_ptr;
+
+    template <typename... Args>
+    static T* make(Args&&... args)
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+        void* const p = impl::arena_allocate(sizeof(T));
+        try
+        {
+            return ::new (p) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            impl::arena_deallocate(p, sizeof(T));
+            throw;
+        }
+    }
+
+public:
+    using type = T;
+
+    recursive_wrapper() : m_ptr(make()) { }
+    /*implicit*/ recursive_wrapper(T const& x) : m_ptr(make(x)) { }
+    /*implicit*/ recursive_wrapper(T&& x) : m_ptr(make(std::move(x))) { }
+    recursive_wrapper(recursive_wrapper const& that) : m_ptr(make(that.get())) { }
+    recursive_wrapper(recursive_wrapper&& that) : m_ptr(make(std::move(that.get()))) { }
+
+    ~recursive_wrapper()
+    {
+        m_ptr->~T();
+        impl::arena_deallocate(m_ptr, sizeof(T));
+    }
+
+    recursive_wrapper& operator=(recursive_wrapper const& that)
+    {
+        get() = that.get();
+        return *this;
+    }
+
+    recursive_wrapper& operator=(recursive_wrapper&& that)
+    {
+        get() = std::move(that.get());
+        return *this;
+    }
+
+    recursive_wrapper& operator=(T const& x)
+    {
+        get() = x;
+        return *this;
+    }
+
+    recursive_wrapper& operator=(T&& x)
+    {
+        get() = std::move(x);
+        return *this;
+    }
+
+    void swap(recursive_wrapper& that) noexcept { std::swap(m_ptr, that.m_ptr); }
+
+    T& get() { return *m_ptr; }
+    T const& get() const { return *m_ptr; }
+
+    T* get_pointer() { return m_ptr; }
+    T const* get_pointer() const { return m_ptr; }
+};
+
+} // namespace dep0
@@ -13,29 +13,55 @@
 #include "dep0/source.hpp"
 
 #include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
 #include <deque>
+#include <functional>
 #include <iterator>
 #include <limits>
 #include <memory>
-#include <map>
-#include <deque>
 #include <optional>
+#include <variant>
 #include <vector>
 
 namespace dep0 {
 
+/**
+ * @brief The default hash function of `scope_map`.
+ *
+ * It calls `hash_value(k)` if such a function is found via ADL, for example for `dep0::source_text`;
+ * otherwise it falls back to `std::hash<K>`.
+ */
+template <typename K>
+struct scope_map_hash
+{
+    std::size_t operator()(K const& k) const
+    {
+        if constexpr (requires { { hash_value(k) } -> std::convertible_to<std::size_t>; })
+            return hash_value(k);
+        else
+            return std::hash<K>{}(k);
+    }
+};
+
 /**
  * @brief Key-Value pair dictionary that can be inherited to allow shadowing inside a different scope.
  *
  * This is useful for example to track variables declared inside a function scope which
  * might shadow other variables with the same name declared in outer function scopes.
+ *
+ * All entries visible from a scope, including those inherited from its parent scopes, are indexed by
+ * a persistent hash trie, which a new scope shares with its parent until either of them is modified.
+ * So lookups take the same time regardless of how deeply nested a scope is and extending a scope is cheap.
  */
-template <typename K, typename V>
+template <typename K, typename V, typename Hash = scope_map_hash<K>>
 class scope_map
 {
     using data_map = std::deque<std::pair<K const, V>>;
 
     struct state_t;
+    struct node_t;
     std::shared_ptr<state_t> state;
 
     explicit scope_map(std::shared_ptr<state_t>);
@@ -186,8 +212,8 @@ public:
     /**
      * @brief Find an element by the given key, either at the current scope level or any parent level.
      *
-     * Because of shadowing, this may require a lookup at every parent level until
-     * an element is found or the root level is reached.
+     * Because of shadowing, the element might be found at any parent level,
+     * but all visible elements are indexed together so this is a single lookup regardless of the nesting depth.
      *
      * @return A stable pointer to the found element or `nullptr if the element does not exist at any scope level.
      * Stable means that future insertions, at any scope level, will not invalidate the returned pointer.
@@ -201,20 +227,36 @@ public:
 // implementation
 
 /** @brief Stores the internal state at a specific scope level and a pointer to the parent level. */
-template <typename K, typename V>
-struct scope_map<K, V>::state_t
+template <typename K, typename V, typename Hash>
+struct scope_map<K, V, Hash>::state_t
 {
+    /**
+     * @brief Reference to an entry stored at some scope level, as indexed by the hash trie.
+     *
+     * The owner level is always either the level that holds the trie or one of its parents,
+     * so it is kept alive by the `parent` pointer of that level.
+     */
+    struct leaf_t
+    {
+        std::size_t hash;
+        state_t const* owner;
+        std::size_t index; // position of the entry inside `owner->data`
+
+        std::pair<K const, V> const& entry() const { return owner->data[index]; }
+    };
+
     std::shared_ptr<state_t> parent;
     std::size_t max_parent_index; // when looking into the parent, look only before this index
     data_map data;
-    std::map<K, std::size_t> index;
+    std::shared_ptr<node_t> base; // all entries visible from the parent, when this level was created
+    std::shared_ptr<node_t> root; // like `base` plus all entries of this level, possibly shadowing some from `base`
 
     /** @brief Constructs the root scope. */
     state_t() : parent(nullptr), max_parent_index(std::numeric_limits<std::size_t>::max()) {}
 
-    /** @brief Constructs a copy of the current scope, with the same parent. */
-    state_t(state_t const&) = default;
-    state_t& operator=(state_t const&) = default;
+    // copies must rebuild the trie to point to their own entries, so they are made via `innermost_copy()`
+    state_t(state_t const&) = delete;
+    state_t& operator=(state_t const&) = delete;
 
     // move could be implemented but unnecessary because we use shared_ptr
     state_t(state_t&&) = delete;
@@ -223,7 +265,20 @@ struct scope_map<K, V>::state_t
     /** @brief Constructs a new empty scope, that extends from the given parent. */
     state_t(std::shared_ptr<state_t> parent, std::size_t const max_parent_index)
         : parent(std::move(parent)), max_parent_index(max_parent_index)
-    {}
+    {
+        if (this->parent)
+            base = root = this->parent->root;
+    }
+
+    /** @brief Constructs a copy of the current scope, with the same parent and indexing its own copy of the entries. */
+    std::shared_ptr<state_t> innermost_copy() const
+    {
+        auto const s = std::make_shared<state_t>(parent, max_parent_index);
+        std::ranges::copy(data, std::back_inserter(s->data)); // data contains `K const` so can't use operator=()
+        s->base = s->root = base;
+        s->index_from(0ul);
+        return s;
+    }
 
     std::shared_ptr<state_t> deep_copy() const
     {
@@ -231,36 +286,152 @@ struct scope_map<K, V>::state_t
         auto const s = std::make_shared<state_t>();
         s->parent = parent_copy;
         s->max_parent_index = max_parent_index;
-        std::ranges::copy(data, std::back_inserter(s->data)); // data contains `K const` so can't use operator=()
-        s->index = index;
+        std::ranges::copy(data, std::back_inserter(s->data));
+        s->base = s->root = parent_copy ? parent_copy->snapshot(max_parent_index) : nullptr;
+        s->index_from(0ul);
         return s;
     }
+
+    /** @brief Return the trie as it was when this level contained only the given number of entries. */
+    std::shared_ptr<node_t> snapshot(std::size_t const size) const
+    {
+        if (size >= data.size())
+            return root;
+        auto s = base;
+        for (std::size_t i = 0ul; i < size; ++i)
+            node_t::insert(s, leaf_t{Hash{}(data[i].first), this, i}, 0u);
+        return s;
+    }
+
+    /** @brief Add to the trie all entries of this level starting from the given index. */
+    void index_from(std::size_t const first)
+    {
+        for (std::size_t i = first; i < data.size(); ++i)
+            node_t::insert(root, leaf_t{Hash{}(data[i].first), this, i}, 0u);
+    }
 };
 
-template <typename K, typename V>
-scope_map<K, V>::scope_map() :
+/**
+ * @brief A node of the hash trie, which consumes 5 bits of the hash code at each level.
+ *
+ * Only the occupied slots are stored, in the same order as the bits set in `bitmap`.
+ * Once all bits of the hash code are consumed, all remaining entries collide, so they are stored in a flat list.
+ *
+ * Nodes are immutable whilst shared, for example between a scope level and its parent,
+ * but a node owned by only one level is modified in-place, which avoids copying it on every insertion.
+ */
+template <typename K, typename V, typename Hash>
+struct scope_map<K, V, Hash>::node_t
+{
+    using leaf_t = typename state_t::leaf_t;
+    using slot_t = std::variant<leaf_t, std::shared_ptr<node_t>>;
+
+    static constexpr unsigned bits_per_level = 5u;
+    static constexpr unsigned hash_bits = std::numeric_limits<std::size_t>::digits;
+
+    std::uint32_t bitmap = 0u;
+    std::vector<slot_t> slots;
+
+    static leaf_t const* find(node_t const* n, std::size_t const hash, K const& k)
+    {
+        for (unsigned shift = 0u; n; shift += bits_per_level)
+        {
+            if (shift >= hash_bits)
+            {
+                for (auto const& slot: n->slots)
+                    if (auto const& l = std::get<leaf_t>(slot); l.entry().first == k)
+                        return &l;
+                return nullptr;
+            }
+            auto const bit = std::uint32_t{1u} << ((hash >> shift) & 31u);
+            if (not (n->bitmap & bit))
+                return nullptr;
+            auto const& slot = n->slots[std::popcount(n->bitmap & (bit - 1u))];
+            if (auto const* const l = std::get_if<leaf_t>(&slot))
+                return l->hash == hash and l->entry().first == k ? l : nullptr;
+            n = std::get<std::shared_ptr<node_t>>(slot).get();
+        }
+        return nullptr;
+    }
+
+    /** @brief Insert the given leaf, replacing any other leaf with the same key, copying all shared nodes. */
+    static void insert(std::shared_ptr<node_t>& p, leaf_t const& leaf, unsigned const shift)
+    {
+        if (not p)
+            p = std::make_shared<node_t>();
+        else if (p.use_count() != 1l)
+        {
+            // the copy is about to receive a new slot, so reserve room for it now rather than reallocating later
+            auto copy = std::make_shared<node_t>();
+            copy->bitmap = p->bitmap;
+            copy->slots.reserve(p->slots.size() + 1ul);
+            copy->slots.assign(p->slots.begin(), p->slots.end());
+            p = std::move(copy);
+        }
+        auto& n = *p;
+        auto const& k = leaf.entry().first;
+        if (shift >= hash_bits)
+        {
+            for (auto& slot: n.slots)
+                if (auto& l = std::get<leaf_t>(slot); l.entry().first == k)
+                {
+                    l = leaf;
+                    return;
+                }
+            n.slots.emplace_back(leaf);
+            return;
+        }
+        auto const bit = std::uint32_t{1u} << ((leaf.hash >> shift) & 31u);
+        auto const pos = std::popcount(n.bitmap & (bit - 1u));
+        if (not (n.bitmap & bit))
+        {
+            n.slots.emplace(std::next(n.slots.begin(), pos), leaf);
+            n.bitmap |= bit;
+            return;
+        }
+        auto& slot = n.slots[pos];
+        if (auto* const l = std::get_if<leaf_t>(&slot))
+        {
+            if (l->hash == leaf.hash and l->entry().first == k)
+            {
+                *l = leaf;
+                return;
+            }
+            // two different keys in the same slot, so push both down to a new node
+            auto child = std::shared_ptr<node_t>{};
+            insert(child, *l, shift + bits_per_level);
+            insert(child, leaf, shift + bits_per_level);
+            slot = std::move(child);
+        }
+        else
+            insert(std::get<std::shared_ptr<node_t>>(slot), leaf, shift + bits_per_level);
+    }
+};
+
+template <typename K, typename V, typename Hash>
+scope_map<K, V, Hash>::scope_map() :
     state(std::make_shared<state_t>())
 { }
 
-template <typename K, typename V>
-scope_map<K, V>::scope_map(std::shared_ptr<state_t> p) :
+template <typename K, typename V, typename Hash>
+scope_map<K, V, Hash>::scope_map(std::shared_ptr<state_t> p) :
     state(std::move(p))
 { }
 
-template <typename K, typename V>
-scope_map<K, V> scope_map<K, V>::innermost_copy() const
+template <typename K, typename V, typename Hash>
+scope_map<K, V, Hash> scope_map<K, V, Hash>::innermost_copy() const
 {
-    return scope_map(std::make_shared<state_t>(*state));
+    return scope_map(state->innermost_copy());
 }
 
-template <typename K, typename V>
-scope_map<K, V> scope_map<K, V>::deep_copy() const
+template <typename K, typename V, typename Hash>
+scope_map<K, V, Hash> scope_map<K, V, Hash>::deep_copy() const
 {
     return scope_map(state->deep_copy());
 }
 
-template <typename K, typename V>
-auto scope_map<K, V>::cbegin() const -> forward_levels_iterator_t
+template <typename K, typename V, typename Hash>
+auto scope_map<K, V, Hash>::cbegin() const -> forward_levels_iterator_t
 {
     typename forward_levels_iterator_t::levels_t levels;
     auto const* s = state.get();
@@ -280,8 +451,8 @@ auto scope_map<K, V>::cbegin() const -> forward_levels_iterator_t
     return forward_levels_iterator_t(std::move(levels));
 }
 
-template <typename K, typename V>
-auto scope_map<K, V>::rbegin() const -> reverse_levels_iterator_t
+template <typename K, typename V, typename Hash>
+auto scope_map<K, V, Hash>::rbegin() const -> reverse_levels_iterator_t
 {
     typename reverse_levels_iterator_t::levels_t levels;
     auto const* s = state.get();
@@ -300,49 +471,40 @@ auto scope_map<K, V>::rbegin() const -> reverse_levels_iterator_t
     return reverse_levels_iterator_t(std::move(levels));
 }
 
-template <typename K, typename V>
-auto scope_map<K, V>::extend() const -> scope_map
+template <typename K, typename V, typename Hash>
+auto scope_map<K, V, Hash>::extend() const -> scope_map
 {
     return scope_map(std::make_shared<state_t>(state, state ? state->data.size() : 0ul));
 }
 
-template <typename K, typename V>
+template <typename K, typename V, typename Hash>
 template <typename... Args>
-auto scope_map<K, V>::try_emplace(K k, Args&&... args) -> std::pair<iterator, bool>
+auto scope_map<K, V, Hash>::try_emplace(K k, Args&&... args) -> std::pair<iterator, bool>
 {
-    auto const [it_index, inserted] = state->index.try_emplace(k, state->data.size());
-    if (inserted)
+    auto const hash = Hash{}(k);
+    if (auto const* const l = node_t::find(state->root.get(), hash, k); l and l->owner == state.get())
+        return std::pair{std::next(state->data.begin(), l->index), false};
+    state->data.emplace_back(std::move(k), V{std::forward<Args>(args)...});
+    try { node_t::insert(state->root, typename state_t::leaf_t{hash, state.get(), state->data.size() - 1ul}, 0u); }
+    catch (...)
     {
-        try { state->data.emplace_back(std::move(k), V{std::forward<Args>(args)...}); }
-        catch (...)
-        {
-            state->index.erase(it_index);
-            throw;
-        }
+        state->data.pop_back();
+        throw;
     }
-    return std::pair{std::next(state->data.begin(), it_index->second), inserted};
+    return std::pair{std::prev(state->data.end()), true};
 }
 
-template <typename K, typename V>
-V* scope_map<K, V>::operator[](K const& k)
+template <typename K, typename V, typename Hash>
+V* scope_map<K, V, Hash>::operator[](K const& k)
 {
     return const_cast<V*>(const_cast<scope_map const*>(this)->operator[](k));
 }
 
-template <typename K, typename V>
-V const* scope_map<K, V>::operator[](K const& k) const
+template <typename K, typename V, typename Hash>
+V const* scope_map<K, V, Hash>::operator[](K const& k) const
 {
-    auto const *s = state.get();
-    auto max_index = std::numeric_limits<std::size_t>::max();
-    do
-    {
-        if (auto const it = s->index.find(k); it != s->index.end() and it->second < max_index)
-            return &s->data[it->second].second;
-        max_index = s->max_parent_index;
-        s = s->parent.get();
-    }
-    while (s);
-    return nullptr;
+    auto const* const l = node_t::find(state->root.get(), Hash{}(k), k);
+    return l ? &l->entry().second : nullptr;
 }
 
 } // namespace dep0
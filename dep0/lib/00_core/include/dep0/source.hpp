@@ -102,6 +102,17 @@ public:
      */
     static source_text from_literal(char const*);
 
+    /**
+     * @brief Helper method to construct a source text backed by a buffer with static storage duration,
+     * for example a constant array embedded in the binary at build time.
+     *
+     * Like for literal C-strings there is no state to keep around,
+     * but the buffer does not need to be null-terminated and it may contain null characters.
+     *
+     * @warning It is undefined behaviour to pass a buffer that does not have static storage duration.
+     */
+    static source_text from_static_buffer(std::string_view);
+
     source_text(source_handle_t, std::string_view);
     source_text(source_text const&) = default;
     source_text(source_text&&) = default;
@@ -137,6 +148,9 @@ bool operator!=(std::string_view, source_text const&);
 
 std::ostream& operator<<(std::ostream&, source_text const&);
 
+/** @brief Hash code of the text, consistent with `operator==`; it is found via ADL, for example by `scope_map`. */
+std::size_t hash_value(source_text const&);
+
 /**
  * @brief The location of some source code snippet.
  * 
@@ -0,0 +1,175 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief A registry of named counters that any library can increment and that can be written out as JSON.
+ *
+ * Counters are grouped by component, for example `parser` or `typecheck`, and must be objects with static storage;
+ * they register themselves on construction, for example:
+ *
+ *     static dep0::stats_counter_t num_files("parser", "files");
+ *     ...
+ *     num_files.add();
+ *
+ * Collecting is disabled by default, in which case updating a counter only costs a relaxed load and a branch.
+ * Once enabled, updates from different threads go to different cache lines, so they do not contend with each other.
+ */
+#pragma once
+
+#include "dep0/error.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace dep0 {
+
+namespace impl {
+
+extern std::atomic<bool> stats_enabled;
+
+/** Number of independent slots of each counter; threads are assigned one each in round-robin fashion. */
+inline constexpr std::size_t num_stats_shards = 16ul;
+
+struct alignas(64) stats_shard_t
+{
+    std::atomic<std::uint64_t> value = 0ul;
+};
+
+/** Return the index of the slot assigned to the calling thread. */
+std::size_t stats_shard_index() noexcept;
+
+} // namespace impl
+
+/** @brief Return true if counters are currently being collected. */
+inline bool stats_enabled() noexcept
+{
+    return impl::stats_enabled.load(std::memory_order_relaxed);
+}
+
+/** @brief Start or stop collecting counters; values collected so far are kept. */
+void enable_stats(bool = true) noexcept;
+
+/** @brief Set all registered counters back to 0. */
+void reset_stats() noexcept;
+
+/**
+ * @brief Base class of all registered statistics, each identified by its component and name.
+ *
+ * Both must only contain lowercase letters, digits and underscores, so that they can be written as JSON keys as is;
+ * they are not copied, so they should be string literals.
+ */
+class stats_entry_t
+{
+    std::string_view m_component;
+    std::string_view m_name;
+
+protected:
+    std::array<impl::stats_shard_t, impl::num_stats_shards> m_shards;
+
+    stats_entry_t(std::string_view component, std::string_view name);
+
+public:
+    virtual ~stats_entry_t();
+
+    // neither copyable nor moveable, because the registry refers to it by address
+    stats_entry_t(stats_entry_t const&) = delete;
+    stats_entry_t& operator=(stats_entry_t const&) = delete;
+
+    std::string_view component() const noexcept { return m_component; }
+    std::string_view name() const noexcept { return m_name; }
+
+    /** @brief Return the current value, combining all slots. */
+    virtual std::uint64_t value() const noexcept = 0;
+
+    void reset() noexcept;
+};
+
+/** @brief A statistic that sums all values added to it, for example the number of files parsed. */
+class stats_counter_t : public stats_entry_t
+{
+public:
+    stats_counter_t(std::string_view component, std::string_view name);
+
+    void add(std::uint64_t const n = 1ul) noexcept
+    {
+        if (stats_enabled())
+            m_shards[impl::stats_shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    std::uint64_t value() const noexcept override;
+};
+
+/** @brief A statistic that keeps the largest value recorded, for example the size of the largest function. */
+class stats_maximum_t : public stats_entry_t
+{
+public:
+    stats_maximum_t(std::string_view component, std::string_view name);
+
+    void record(std::uint64_t const n) noexcept
+    {
+        if (stats_enabled())
+        {
+            auto& slot = m_shards[impl::stats_shard_index()].value;
+            auto old = slot.load(std::memory_order_relaxed);
+            while (old < n and not slot.compare_exchange_weak(old, n, std::memory_order_relaxed))
+                ;
+        }
+    }
+
+    std::uint64_t value() const noexcept override;
+};
+
+/** @brief The value of a statistic at some point in time. */
+struct stats_value_t
+{
+    std::string_view component;
+    std::string_view name;
+    std::uint64_t value;
+};
+
+/** @brief Return the current value of all registered statistics, sorted by component and then by name. */
+std::vector<stats_value_t> snapshot_stats();
+
+/**
+ * @brief Write the current value of all registered statistics as a JSON object of objects.
+ *
+ * The outer object contains one entry per component, each containing one entry per statistic;
+ * both are sorted by name, so that two runs of the same version of the compiler always produce the same keys.
+ */
+void write_stats(std::ostream&);
+
+/** @brief Opaque data structure holding the state of a statistics session. */
+struct stats_session_t;
+
+/**
+ * @brief Starts collecting statistics until the session is stopped, at which point they are written to file.
+ *
+ * A session that has not been stopped explicitly is stopped when all references are destroyed,
+ * but then any failure to write the file goes unnoticed; see `stop_stats_session()`.
+ *
+ * @param file_name The file name where the statistics will be stored as JSON, see `write_stats()`.
+ * @return The new session or an error if the statistics file could not be created.
+ */
+expected<std::shared_ptr<stats_session_t>> start_stats_session(std::filesystem::path file_name);
+
+/**
+ * @brief Stops collecting statistics and writes them to the file of the given session.
+ *
+ * Stopping a session that was already stopped has no effect.
+ *
+ * @return An error if the statistics file could not be written.
+ */
+expected<std::true_type> stop_stats_session(stats_session_t&);
+
+} // namespace dep0
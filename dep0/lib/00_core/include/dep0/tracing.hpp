@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -10,8 +10,12 @@
  */
 #pragma once
 
+#include "dep0/error.hpp"
+
 #include <perfetto.h>
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <filesystem>
 
@@ -20,7 +24,9 @@
 #define TRACE_TYPECHECKING "typechecking"
 #define TRACE_TRANSFORM "transform"
 #define TRACE_LLVMGEN "llvmgen"
+#define TRACE_OPTIMIZE "optimize"
 #define TRACE_COMPILE "compile"
+#define TRACE_COUNTERS "counters"
 
 PERFETTO_DEFINE_CATEGORIES(
     perfetto::Category(TRACE_PARSING),
@@ -28,7 +34,9 @@ PERFETTO_DEFINE_CATEGORIES(
     perfetto::Category(TRACE_PROOF_SEARCH),
     perfetto::Category(TRACE_TRANSFORM),
     perfetto::Category(TRACE_LLVMGEN),
-    perfetto::Category(TRACE_COMPILE)
+    perfetto::Category(TRACE_OPTIMIZE),
+    perfetto::Category(TRACE_COMPILE),
+    perfetto::Category(TRACE_COUNTERS)
     );
 
 namespace dep0 {
@@ -36,11 +44,41 @@ namespace dep0 {
 /** @brief Opaque data structure holding tracing objects from perfetto library. */
 struct tracing_session_t;
 
+/** @brief Options to configure a tracing session. */
+struct tracing_options_t
+{
+    /**
+     * Size of the in-memory buffer where events are collected before being written to the trace file.
+     * If `write_period` is not zero, the buffer is used as a ring: once full, the oldest events that have not been
+     * written yet are overwritten, so it must be large enough to hold all events produced in one `write_period`.
+     * Otherwise the whole trace is written only at the end and, once the buffer is full, all later events are dropped,
+     * so it must be large enough to hold all events of the whole session.
+     */
+    std::size_t buffer_size_kb = 4096ul;
+
+    /**
+     * How often the content of the buffer is written to the trace file, so that long sessions do not drop events
+     * and a crash only loses the events of the last period.
+     * If zero, the trace file is only written once the session stops.
+     */
+    std::chrono::milliseconds write_period{1000};
+
+    /**
+     * How often to sample counter tracks, which are written to the trace file alongside all other events:
+     * the resident set size of the process, the number of live AST nodes and proof search tasks,
+     * the hit rate of all caches and every statistic registered in `dep0/stats.hpp`.
+     * If zero, no counter is sampled.
+     */
+    std::chrono::milliseconds counters_period{10};
+};
+
 /**
  * @brief Starts a new tracing session that will be automatically stopped when all references are destroyed.
  *
  * @param trace_file_name The file name where the trace will be stored.
+ * @return The new session or an error if the trace file could not be created.
  */
-std::shared_ptr<tracing_session_t> start_tracing_session(std::filesystem::path trace_file_name);
+expected<std::shared_ptr<tracing_session_t>>
+start_tracing_session(std::filesystem::path trace_file_name, tracing_options_t const& = {});
 
 } // namespace dep0
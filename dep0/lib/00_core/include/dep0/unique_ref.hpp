@@ -36,6 +36,9 @@ public:
     T const* operator->() const { return ptr.get(); }
     T const& operator*() const { return *ptr; }
     T const& get() const { return *ptr; }
+
+    /** @brief Give up ownership to a `std::unique_ptr`, for APIs that need one; this object must not be used again. */
+    std::unique_ptr<T> release() && { return std::move(ptr); }
 };
 
 /** @brief Constructs a `unique_ref` in-place by passing all the given arguments to the element's constructor. */
@@ -0,0 +1,155 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "dep0/arena.hpp"
+
+#include "dep0/stats.hpp"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace dep0 {
+
+namespace impl {
+
+/**
+ * The shared state of an arena, which is reference counted by the `arena_t` object,
+ * all active `arena_scope_t` objects and all live blocks allocated from it.
+ */
+struct arena_state_t
+{
+    static constexpr std::size_t granularity = alignof(std::max_align_t);
+    static constexpr std::size_t max_block_size = 1024ul; // anything bigger is allocated from the heap
+    static constexpr std::size_t chunk_size = 64ul * 1024ul;
+
+    std::atomic<std::size_t> refs = 1ul;
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    std::byte* next = nullptr;
+    std::byte* end = nullptr;
+    std::array<void*, max_block_size / granularity + 1ul> free_lists{}; // each free block points to the next one
+    arena_t::statistics_t statistics{};
+
+    void* allocate(std::size_t const size)
+    {
+        ++statistics.num_allocations;
+        auto& free_list = free_lists[size / granularity];
+        if (free_list)
+        {
+            ++statistics.num_reused;
+            auto const p = free_list;
+            free_list = *static_cast<void**>(p);
+            return p;
+        }
+        if (static_cast<std::size_t>(end - next) < size)
+        {
+            chunks.emplace_back(new std::byte[chunk_size]);
+            next = chunks.back().get();
+            end = next + chunk_size;
+            statistics.reserved_bytes += chunk_size;
+        }
+        auto const p = next;
+        next += size;
+        return p;
+    }
+
+    void deallocate(void* const p, std::size_t const size) noexcept
+    {
+        auto& free_list = free_lists[size / granularity];
+        *static_cast<void**>(p) = free_list;
+        free_list = p;
+    }
+
+    void acquire() noexcept
+    {
+        refs.fetch_add(1ul, std::memory_order_relaxed);
+    }
+
+    void release() noexcept
+    {
+        if (refs.fetch_sub(1ul, std::memory_order_acq_rel) == 1ul)
+            delete this;
+    }
+};
+
+static thread_local arena_state_t* current_arena = nullptr;
+
+// in practice, `recursive_wrapper` is the only user of the arena and it is only used to build the AST
+static stats_counter_t num_nodes_allocated("ast", "nodes_allocated");
+static stats_counter_t num_nodes_freed("ast", "nodes_freed");
+
+// every block starts with a header pointing to the arena it was allocated from, or `nullptr` for the heap
+static constexpr std::size_t header_size = arena_state_t::granularity;
+
+static std::size_t block_size(std::size_t const size)
+{
+    auto constexpr g = arena_state_t::granularity;
+    return (header_size + size + g - 1ul) / g * g;
+}
+
+void* arena_allocate(std::size_t const size)
+{
+    num_nodes_allocated.add();
+    auto const total = block_size(size);
+    auto const arena = total <= arena_state_t::max_block_size ? current_arena : nullptr;
+    auto const block = static_cast<std::byte*>(arena ? arena->allocate(total) : ::operator new(total));
+    if (arena)
+        arena->acquire();
+    *reinterpret_cast<arena_state_t**>(block) = arena;
+    return block + header_size;
+}
+
+void arena_deallocate(void* const p, std::size_t const size) noexcept
+{
+    num_nodes_freed.add();
+    auto const block = static_cast<std::byte*>(p) - header_size;
+    auto const arena = *reinterpret_cast<arena_state_t**>(block);
+    if (not arena)
+        return ::operator delete(block);
+    if (arena == current_arena)
+        arena->deallocate(block, block_size(size));
+    arena->release();
+}
+
+} // namespace impl
+
+arena_t::arena_t() : m_state(new impl::arena_state_t) { }
+
+arena_t::~arena_t()
+{
+    m_state->release();
+}
+
+arena_t::statistics_t arena_t::statistics() const
+{
+    return m_state->statistics;
+}
+
+arena_scope_t::arena_scope_t(arena_t& arena) :
+    m_previous(impl::current_arena),
+    m_current(arena.m_state)
+{
+    m_current->acquire();
+    impl::current_arena = m_current;
+}
+
+arena_scope_t::arena_scope_t(std::nullptr_t) :
+    m_previous(impl::current_arena),
+    m_current(nullptr)
+{
+    impl::current_arena = nullptr;
+}
+
+arena_scope_t::~arena_scope_t()
+{
+    impl::current_arena = m_previous;
+    if (m_current)
+        m_current->release();
+}
+
+} // namespace dep0
@@ -54,6 +54,11 @@ source_text source_text::from_literal(char const* const s)
     return source_text(source_handle_t(source_handle_t::literal_string_tag_t{}), s);
 }
 
+source_text source_text::from_static_buffer(std::string_view const s)
+{
+    return source_text(source_handle_t(source_handle_t::literal_string_tag_t{}), s);
+}
+
 source_text::source_text(source_handle_t hdl, std::string_view const txt) :
     hdl(std::move(hdl)),
     txt(txt)
@@ -83,6 +88,8 @@ bool operator!=(std::string_view const s, source_text const& x) { return x.txt !
 
 std::ostream& operator<<(std::ostream& os, source_text const& s) { return os << s.txt; }
 
+std::size_t hash_value(source_text const& s) { return std::hash<std::string_view>{}(s.view()); }
+
 source_loc_t::source_loc_t(std::size_t const line, std::size_t const col, source_text txt) :
     line(line), col(col), txt(std::move(txt))
 { }
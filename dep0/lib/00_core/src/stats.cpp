@@ -0,0 +1,189 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "dep0/stats.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace dep0 {
+
+namespace impl {
+
+std::atomic<bool> stats_enabled = false;
+
+std::size_t stats_shard_index() noexcept
+{
+    static std::atomic<std::size_t> next_index = 0ul;
+    static thread_local std::size_t const index =
+        next_index.fetch_add(1ul, std::memory_order_relaxed) % num_stats_shards;
+    return index;
+}
+
+} // namespace impl
+
+/** All statistics currently alive, in order of construction. */
+struct stats_registry_t
+{
+    std::mutex mutex;
+    std::vector<stats_entry_t*> entries;
+
+    static stats_registry_t& instance()
+    {
+        // constructed by the first statistic, so it is destroyed after the last one
+        static stats_registry_t registry;
+        return registry;
+    }
+};
+
+static bool is_valid_key(std::string_view const s)
+{
+    return not s.empty() and std::ranges::all_of(s, [] (char const c)
+    {
+        return (c >= 'a' and c <= 'z') or (c >= '0' and c <= '9') or c == '_';
+    });
+}
+
+void enable_stats(bool const enabled) noexcept
+{
+    impl::stats_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void reset_stats() noexcept
+{
+    auto& registry = stats_registry_t::instance();
+    auto const lock = std::lock_guard(registry.mutex);
+    for (auto const x: registry.entries)
+        x->reset();
+}
+
+stats_entry_t::stats_entry_t(std::string_view const component, std::string_view const name) :
+    m_component(component),
+    m_name(name)
+{
+    assert(is_valid_key(component) and is_valid_key(name));
+    auto& registry = stats_registry_t::instance();
+    auto const lock = std::lock_guard(registry.mutex);
+    registry.entries.push_back(this);
+}
+
+stats_entry_t::~stats_entry_t()
+{
+    auto& registry = stats_registry_t::instance();
+    auto const lock = std::lock_guard(registry.mutex);
+    std::erase(registry.entries, this);
+}
+
+void stats_entry_t::reset() noexcept
+{
+    for (auto& x: m_shards)
+        x.value.store(0ul, std::memory_order_relaxed);
+}
+
+stats_counter_t::stats_counter_t(std::string_view const component, std::string_view const name) :
+    stats_entry_t(component, name)
+{ }
+
+std::uint64_t stats_counter_t::value() const noexcept
+{
+    std::uint64_t result = 0ul;
+    for (auto const& x: m_shards)
+        result += x.value.load(std::memory_order_relaxed);
+    return result;
+}
+
+stats_maximum_t::stats_maximum_t(std::string_view const component, std::string_view const name) :
+    stats_entry_t(component, name)
+{ }
+
+std::uint64_t stats_maximum_t::value() const noexcept
+{
+    std::uint64_t result = 0ul;
+    for (auto const& x: m_shards)
+        result = std::max(result, x.value.load(std::memory_order_relaxed));
+    return result;
+}
+
+std::vector<stats_value_t> snapshot_stats()
+{
+    std::vector<stats_value_t> result;
+    {
+        auto& registry = stats_registry_t::instance();
+        auto const lock = std::lock_guard(registry.mutex);
+        result.reserve(registry.entries.size());
+        for (auto const x: registry.entries)
+            result.push_back(stats_value_t{x->component(), x->name(), x->value()});
+    }
+    std::ranges::sort(result, [] (stats_value_t const& a, stats_value_t const& b)
+    {
+        return std::pair(a.component, a.name) < std::pair(b.component, b.name);
+    });
+    return result;
+}
+
+void write_stats(std::ostream& os)
+{
+    auto const values = snapshot_stats();
+    os << '{';
+    for (auto it = values.begin(); it != values.end(); )
+    {
+        auto const component = it->component;
+        os << (it == values.begin() ? "\n" : ",\n") << "  \"" << component << "\": {";
+        for (bool first = true; it != values.end() and it->component == component; ++it, first = false)
+            os << (first ? "\n" : ",\n") << "    \"" << it->name << "\": " << it->value;
+        os << "\n  }";
+    }
+    os << (values.empty() ? "}\n" : "\n}\n");
+}
+
+struct stats_session_t
+{
+    std::ofstream file;
+    bool stopped = false;
+
+    explicit stats_session_t(std::ofstream file) :
+        file(std::move(file))
+    {
+        reset_stats();
+        enable_stats();
+    }
+
+    ~stats_session_t()
+    {
+        if (not stopped)
+            (void)stop_stats_session(*this);
+    }
+};
+
+expected<std::shared_ptr<stats_session_t>> start_stats_session(std::filesystem::path file_name)
+{
+    // open the file straight away, so that a bad file name is reported before doing any work rather than after
+    std::ofstream file(file_name);
+    if (not file)
+        return error_t("cannot open statistics file", {error_t(std::strerror(errno))});
+    return std::make_shared<stats_session_t>(std::move(file));
+}
+
+expected<std::true_type> stop_stats_session(stats_session_t& session)
+{
+    if (session.stopped)
+        return std::true_type{};
+    session.stopped = true;
+    enable_stats(false);
+    write_stats(session.file);
+    // closing flushes the stream, which is when most write errors, like a full disk, are detected
+    session.file.close();
+    if (not session.file)
+        return error_t("cannot write statistics file", {error_t(std::strerror(errno))});
+    return std::true_type{};
+}
+
+} // namespace dep0
@@ -1,28 +1,107 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
  */
 #include "dep0/tracing.hpp"
 
-#include "dep0/temp_file.hpp"
+#include "dep0/stats.hpp"
 
-#include <boost/core/ignore_unused.hpp>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <thread>
 
 PERFETTO_TRACK_EVENT_STATIC_STORAGE();
 
 namespace dep0 {
 
+/** Return the resident set size of the current process in bytes, or 0 if it cannot be determined. */
+static std::uint64_t resident_set_size()
+{
+    std::uint64_t size = 0ul;
+    std::uint64_t resident = 0ul;
+    std::ifstream("/proc/self/statm") >> size >> resident;
+    return resident * static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+}
+
+/**
+ * Emit the current value of all counter tracks.
+ *
+ * Apart from the resident set size, counters are derived from the statistics registered in `dep0/stats.hpp`:
+ * each statistic has its own track, plus one for the hit rate of every pair counting hits and misses,
+ * and one for the number of live AST nodes and proof search tasks, which are allocated and freed all the time.
+ * In order to keep the trace small, only values that changed since the previous sample are emitted.
+ */
+static void sample_counters(std::map<std::string, double>& previous)
+{
+    auto const emit = [&] (std::string name, double const value)
+    {
+        auto const [it, inserted] = previous.try_emplace(std::move(name), value);
+        if (not inserted and it->second == value)
+            return;
+        it->second = value;
+        TRACE_COUNTER(TRACE_COUNTERS, perfetto::CounterTrack(perfetto::DynamicString(it->first)), value);
+    };
+    TRACE_COUNTER(
+        TRACE_COUNTERS,
+        perfetto::CounterTrack("rss").set_unit(perfetto::CounterTrack::Unit::UNIT_SIZE_BYTES),
+        resident_set_size());
+    auto const values = snapshot_stats();
+    auto const find = [&] (std::string_view const component, std::string_view const name)
+    {
+        auto const it = std::ranges::find_if(values, [&] (stats_value_t const& x)
+        {
+            return x.component == component and x.name == name;
+        });
+        return it == values.end() ? std::nullopt : std::optional{it->value};
+    };
+    for (auto const& x: values)
+    {
+        auto const prefix = std::string(x.component) + '.';
+        emit(prefix + std::string(x.name), static_cast<double>(x.value));
+        if (x.name.ends_with("_hits"))
+        {
+            auto const what = x.name.substr(0ul, x.name.size() - 5ul);
+            auto const misses = find(x.component, std::string(what) + "_misses");
+            if (misses and x.value + *misses > 0ul)
+                emit(
+                    prefix + std::string(what) + "_hit_rate",
+                    100.0 * static_cast<double>(x.value) / static_cast<double>(x.value + *misses));
+        }
+    }
+    auto const live =
+        [&] (std::string_view const component, std::string_view const created, std::string_view const destroyed,
+            std::string const& name)
+        {
+            auto const a = find(component, created);
+            auto const b = find(component, destroyed);
+            if (a and b and *a >= *b) // might not hold if statistics were reset while objects were alive
+                emit(std::string(component) + '.' + name, static_cast<double>(*a - *b));
+        };
+    live("ast", "nodes_allocated", "nodes_freed", "live_nodes");
+    live("proof_search", "tasks_created", "tasks_destroyed", "live_tasks");
+}
+
 struct tracing_session_t
 {
+    std::FILE* trace_file;
     std::unique_ptr<perfetto::TracingSession> tracing_session;
-    std::filesystem::path trace_file_name;
-    temp_file_t trace_file;
+    std::optional<std::jthread> sampler;
 
-    tracing_session_t(std::filesystem::path trace_file_name) :
-        trace_file_name(std::move(trace_file_name)),
-        trace_file(std::move(make_temp_file().value()))
+    tracing_session_t(std::FILE* const trace_file, tracing_options_t const& options) :
+        trace_file(trace_file)
     {
         perfetto::TracingInitArgs args;
         args.backends |= perfetto::kInProcessBackend;
@@ -31,25 +110,62 @@ struct tracing_session_t
         perfetto::protos::gen::TrackEventConfig track_event_cfg;
         track_event_cfg.add_enabled_categories("*");
         perfetto::TraceConfig cfg;
-        cfg.add_buffers()->set_size_kb(1024);
+        auto const buffer = cfg.add_buffers();
+        buffer->set_size_kb(static_cast<std::uint32_t>(options.buffer_size_kb));
+        if (auto const period = static_cast<std::uint32_t>(options.write_period.count()); period > 0u)
+        {
+            // a DISCARD buffer never accepts more than its size in total, even after its content has been written,
+            // so streaming needs a ring buffer, whose space is reused once written
+            buffer->set_fill_policy(perfetto::TraceConfig::BufferConfig::RING_BUFFER);
+            // events are first committed from thread-local chunks to the buffer and then from the buffer to the file
+            cfg.set_flush_period_ms(period);
+            cfg.set_write_into_file(true);
+            cfg.set_file_write_period_ms(period);
+        }
+        else
+            // the trace is written only at the end, so keep its beginning rather than its end
+            buffer->set_fill_policy(perfetto::TraceConfig::BufferConfig::DISCARD);
         auto ds_cfg = cfg.add_data_sources()->mutable_config();
         ds_cfg->set_name("track_event");
         ds_cfg->set_track_event_config_raw(track_event_cfg.SerializeAsString());
         tracing_session = std::unique_ptr<perfetto::TracingSession>(perfetto::Tracing::NewTrace());
-        tracing_session->Setup(cfg, trace_file.fd());
+        tracing_session->Setup(cfg, ::fileno(trace_file));
         tracing_session->StartBlocking();
+        if (options.counters_period.count() > 0)
+        {
+            enable_stats();
+            sampler.emplace([period = options.counters_period] (std::stop_token const stop)
+            {
+                std::map<std::string, double> previous;
+                std::mutex mutex;
+                std::condition_variable_any cv; // only used to sleep until either the next period or stop is requested
+                auto lock = std::unique_lock(mutex);
+                while (not stop.stop_requested())
+                {
+                    sample_counters(previous);
+                    cv.wait_for(lock, stop, period, [] { return false; });
+                }
+                sample_counters(previous);
+            });
+        }
     }
 
     ~tracing_session_t()
     {
+        sampler.reset(); // stops and joins the sampler, so that its last samples are part of the trace
         tracing_session->StopBlocking();
-        boost::ignore_unused(trace_file.rename_and_keep(trace_file_name));
+        std::fclose(trace_file);
     }
 };
 
-std::shared_ptr<tracing_session_t> start_tracing_session(std::filesystem::path trace_file_name)
+expected<std::shared_ptr<tracing_session_t>>
+start_tracing_session(std::filesystem::path trace_file_name, tracing_options_t const& options)
 {
-    return std::make_shared<tracing_session_t>(std::move(trace_file_name));
+    // write directly to the final file, rather than to a temporary one, so that a crash does not lose the whole trace
+    auto const trace_file = std::fopen(trace_file_name.c_str(), "wb");
+    if (not trace_file)
+        return error_t("cannot open trace file", {error_t(std::strerror(errno))});
+    return std::make_shared<tracing_session_t>(trace_file, options);
 }
 
 } // namespace dep0
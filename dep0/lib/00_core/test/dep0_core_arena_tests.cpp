@@ -0,0 +1,120 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_MODULE dep0_core_arena_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "dep0/arena.hpp"
+#include "dep0/recursive_wrapper.hpp"
+
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dep0 {
+
+struct list_t
+{
+    std::string value;
+    std::optional<recursive_wrapper<list_t>> next;
+};
+
+static list_t make_list(std::size_t const n)
+{
+    list_t result{"0", std::nullopt};
+    for (std::size_t i = 1ul; i < n; ++i)
+        result = list_t{std::to_string(i), std::move(result)};
+    return result;
+}
+
+static std::size_t length(list_t const& x)
+{
+    return 1ul + (x.next ? length(x.next->get()) : 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE(dep0_core_arena_tests)
+
+BOOST_AUTO_TEST_CASE(heap_allocation)
+{
+    auto const x = make_list(10ul);
+    BOOST_TEST(length(x) == 10ul);
+    BOOST_TEST(x.value == "9");
+}
+
+BOOST_AUTO_TEST_CASE(arena_allocation)
+{
+    arena_t arena;
+    {
+        arena_scope_t const scope(arena);
+        auto const x = make_list(10ul);
+        BOOST_TEST(length(x) == 10ul);
+        BOOST_TEST(x.value == "9");
+    }
+    auto const stats = arena.statistics();
+    BOOST_TEST(stats.num_allocations > 0ul);
+    BOOST_TEST(stats.num_reused > 0ul); // moving a list releases the old node, which can be reused by the next one
+    BOOST_TEST(stats.reserved_bytes > 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(nodes_outlive_arena)
+{
+    std::optional<list_t> x;
+    {
+        arena_t arena;
+        arena_scope_t const scope(arena);
+        x.emplace(make_list(10ul));
+    }
+    BOOST_TEST(length(*x) == 10ul);
+    auto const y = *x; // copies are allocated from the heap, since no arena is active now
+    x.reset();
+    BOOST_TEST(length(y) == 10ul);
+    BOOST_TEST(y.value == "9");
+}
+
+BOOST_AUTO_TEST_CASE(nested_scopes)
+{
+    arena_t arena1;
+    arena_t arena2;
+    {
+        arena_scope_t const scope1(arena1);
+        auto const x = make_list(3ul);
+        {
+            arena_scope_t const scope2(arena2);
+            auto const y = make_list(3ul);
+            {
+                arena_scope_t const heap(nullptr);
+                auto const z = make_list(3ul);
+                BOOST_TEST(length(z) == 3ul);
+            }
+            BOOST_TEST(length(y) == 3ul);
+        }
+        auto const z = x;
+        BOOST_TEST(length(z) == 3ul);
+    }
+    BOOST_TEST(arena1.statistics().num_allocations > arena2.statistics().num_allocations);
+}
+
+BOOST_AUTO_TEST_CASE(one_arena_per_thread)
+{
+    std::vector<list_t> results(4ul);
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t i = 0ul; i < results.size(); ++i)
+            threads.emplace_back([&results, i]
+            {
+                arena_t arena;
+                arena_scope_t const scope(arena);
+                results[i] = make_list(100ul + i);
+            });
+    }
+    for (std::size_t i = 0ul; i < results.size(); ++i)
+        BOOST_TEST(length(results[i]) == 100ul + i);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace dep0
@@ -11,6 +11,7 @@
 
 #include <string>
 #include <type_traits>
+#include <vector>
 
 namespace dep0 {
 
@@ -233,6 +234,58 @@ BOOST_AUTO_TEST_CASE(iterate_tests)
     BOOST_TEST(entries[1].second == 42);
 }
 
+BOOST_AUTO_TEST_CASE(deep_nesting_tests)
+{
+    // lookups from the innermost scope see the most recent shadowing entry of every outer scope
+    std::vector<scope_map<std::string, int>> levels;
+    levels.emplace_back();
+    for (int i = 0; i < 100; ++i)
+    {
+        levels.push_back(levels.back().extend());
+        BOOST_TEST(levels.back().try_emplace("x" + std::to_string(i), i).second);
+        BOOST_TEST(levels.back().try_emplace("shadowed", i).second);
+    }
+    for (int i = 0; i < 100; ++i)
+    {
+        auto const p = levels.back()["x" + std::to_string(i)];
+        BOOST_TEST_REQUIRE(p);
+        BOOST_TEST(*p == i);
+        auto const q = levels[i + 1]["shadowed"];
+        BOOST_TEST_REQUIRE(q);
+        BOOST_TEST(*q == i);
+        // outer scopes do not see entries of inner scopes
+        BOOST_TEST(not levels[i]["x" + std::to_string(i)]);
+    }
+    // values are shared with the outer scope where they were inserted
+    *levels[1]["x0"] = 42;
+    BOOST_TEST(*levels.back()["x0"] == 42);
+}
+
+BOOST_AUTO_TEST_CASE(hash_collision_tests)
+{
+    struct bad_hash_t
+    {
+        std::size_t operator()(std::string const&) const { return 0ul; }
+    };
+    scope_map<std::string, int, bad_hash_t> map1;
+    for (int i = 0; i < 50; ++i)
+        BOOST_TEST(map1.try_emplace(std::to_string(i), i).second);
+    BOOST_TEST(not map1.try_emplace("7", 0).second);
+    auto map2 = map1.extend();
+    BOOST_TEST(map2.try_emplace("7", 77).second);
+    auto map3 = map2.innermost_copy();
+    BOOST_TEST(not map3.try_emplace("7", 0).second);
+    for (int i = 0; i < 50; ++i)
+    {
+        auto const p = map1[std::to_string(i)];
+        BOOST_TEST_REQUIRE(p);
+        BOOST_TEST(*p == i);
+    }
+    BOOST_TEST(*map2["7"] == 77);
+    BOOST_TEST(*map3["7"] == 77);
+    BOOST_TEST(not map1["50"]);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace dep0
@@ -0,0 +1,170 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_MODULE dep0_core_stats_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "dep0/stats.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dep0 {
+
+static stats_counter_t counter("test", "counter");
+static stats_counter_t other_counter("test", "another_counter");
+static stats_maximum_t maximum("test", "maximum");
+
+struct stats_fixture
+{
+    stats_fixture()
+    {
+        reset_stats();
+        enable_stats();
+    }
+
+    ~stats_fixture()
+    {
+        enable_stats(false);
+    }
+};
+
+static std::string to_string()
+{
+    std::ostringstream os;
+    write_stats(os);
+    return os.str();
+}
+
+BOOST_FIXTURE_TEST_SUITE(dep0_core_stats_tests, stats_fixture)
+
+BOOST_AUTO_TEST_CASE(disabled_by_default)
+{
+    enable_stats(false);
+    counter.add(5ul);
+    maximum.record(5ul);
+    BOOST_TEST(counter.value() == 0ul);
+    BOOST_TEST(maximum.value() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(counter_and_maximum)
+{
+    counter.add();
+    counter.add(41ul);
+    maximum.record(3ul);
+    maximum.record(7ul);
+    maximum.record(5ul);
+    BOOST_TEST(counter.value() == 42ul);
+    BOOST_TEST(maximum.value() == 7ul);
+    reset_stats();
+    BOOST_TEST(counter.value() == 0ul);
+    BOOST_TEST(maximum.value() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(many_threads)
+{
+    {
+        std::vector<std::jthread> threads;
+        for (std::uint64_t i = 1ul; i <= 32ul; ++i)
+            threads.emplace_back([i]
+            {
+                for (std::size_t j = 0ul; j < 1000ul; ++j)
+                    counter.add();
+                maximum.record(i);
+            });
+    }
+    BOOST_TEST(counter.value() == 32'000ul);
+    BOOST_TEST(maximum.value() == 32ul);
+}
+
+BOOST_AUTO_TEST_CASE(json_output)
+{
+    counter.add(3ul);
+    maximum.record(9ul);
+    auto const json = to_string();
+    BOOST_TEST(json.starts_with("{\n"));
+    BOOST_TEST(json.ends_with("\n}\n"));
+    // sorted by name within each component
+    auto const expected = std::string(
+        "  \"test\": {\n"
+        "    \"another_counter\": 0,\n"
+        "    \"counter\": 3,\n"
+        "    \"maximum\": 9\n"
+        "  }");
+    BOOST_TEST(json.find(expected) != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(snapshot)
+{
+    counter.add(4ul);
+    auto const values = snapshot_stats();
+    auto const key = [] (stats_value_t const& x) { return std::pair(x.component, x.name); };
+    BOOST_TEST(std::ranges::is_sorted(values, {}, key));
+    auto const it = std::ranges::find_if(values, [] (stats_value_t const& x)
+    {
+        return x.component == "test" and x.name == "counter";
+    });
+    BOOST_TEST_REQUIRE((it != values.end()));
+    BOOST_TEST(it->value == 4ul);
+}
+
+BOOST_AUTO_TEST_CASE(registration)
+{
+    {
+        stats_counter_t const local("test", "local");
+        BOOST_TEST(to_string().find("\"local\"") != std::string::npos);
+    }
+    BOOST_TEST(to_string().find("\"local\"") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(session)
+{
+    enable_stats(false);
+    auto const path = std::filesystem::temp_directory_path() / "dep0_core_stats_tests.json";
+    {
+        auto const session = start_stats_session(path);
+        BOOST_TEST_REQUIRE(session.has_value());
+        BOOST_TEST(stats_enabled());
+        counter.add(2ul);
+    }
+    BOOST_TEST(not stats_enabled());
+    std::ifstream f(path);
+    auto const json = std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    std::filesystem::remove(path);
+    BOOST_TEST(json == to_string());
+    BOOST_TEST(json.find("\"counter\": 2") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(session_cannot_open_file)
+{
+    enable_stats(false);
+    auto const path = std::filesystem::temp_directory_path() / "dep0_core_stats_tests_missing_dir" / "stats.json";
+    auto const session = start_stats_session(path);
+    BOOST_TEST(session.has_error());
+    BOOST_TEST(not stats_enabled());
+}
+
+BOOST_AUTO_TEST_CASE(session_cannot_write_file)
+{
+    enable_stats(false);
+    // opening `/dev/full` succeeds but every write fails
+    auto const session = start_stats_session("/dev/full");
+    BOOST_TEST_REQUIRE(session.has_value());
+    counter.add(2ul);
+    BOOST_TEST(stop_stats_session(**session).has_error());
+    BOOST_TEST(not stats_enabled());
+    BOOST_TEST(stop_stats_session(**session).has_value());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace dep0
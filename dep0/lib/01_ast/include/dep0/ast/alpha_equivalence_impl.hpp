@@ -13,25 +13,90 @@
 #include "dep0/ast/alpha_equivalence.hpp"
 #include "dep0/ast/occurs_in.hpp"
 #include "dep0/ast/pretty_print.hpp"
-#include "dep0/ast/replace.hpp"
-#include "dep0/ast/rename.hpp"
 
 #include "dep0/match.hpp"
 
 #include <boost/hana.hpp>
+#include <boost/scope/scope_exit.hpp>
 
+#include <algorithm>
+#include <optional>
+#include <ranges>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 namespace dep0::ast {
 
 namespace impl {
 
-// Internally we use an implementation that modifies a copy of the original arguments when renaming is necessary.
+/**
+ * @brief Helper object to keep track of the binders introduced, at the same position, by the two expressions
+ * being compared, so that bound variables can be compared by position rather than by name.
+ *
+ * This is effectively a locally nameless representation of the two expressions, built on the fly:
+ * two bound variables are the same if they refer to the binders at the same position,
+ * whereas two free variables are the same only if they have the same name.
+ * So alpha-equivalence becomes a structural comparison that requires neither copying nor renaming.
+ *
+ * Like in `hash_code_state_t`, binders are stored in a flat vector and lookup scans backwards,
+ * so that the most recent binder of a name shadows any previous one.
+ * An anonymous function argument is stored as an empty binder.
+ *
+ * @see @ref alpha_equivalence
+ */
+template <Properties P>
+class alpha_equivalence_state_t
+{
+    using var_t = typename expr_t<P>::var_t;
+
+    std::vector<std::pair<std::optional<var_t>, std::optional<var_t>>> binders;
+
+    template <typename Proj>
+    std::optional<std::size_t> find(var_t const& x, Proj const proj) const
+    {
+        auto const innermost = binders | std::views::reverse;
+        auto const it = std::ranges::find(innermost, std::optional{x}, proj);
+        if (it == innermost.end())
+            return std::nullopt;
+        else
+            return binders.size() - 1ul - std::ranges::distance(innermost.begin(), it);
+    }
+
+public:
+    /** @brief Return the number of binders currently in scope, suitable for `pop()`. */
+    std::size_t size() const { return binders.size(); }
+
+    /** @brief Store a pair of binders introduced at the same position by the two expressions. */
+    void push(std::optional<var_t> const& x, std::optional<var_t> const& y)
+    {
+        binders.emplace_back(x, y);
+    }
+
+    /** @brief Remove all binders stored after the given number of binders, i.e. those that went out of scope. */
+    void pop(std::size_t const size)
+    {
+        binders.erase(binders.begin() + size, binders.end());
+    }
+
+    /** @brief Return true if the two variables refer to the same binder or are the same free variable. */
+    bool is_same_var(var_t const& x, var_t const& y) const
+    {
+        auto const x_pos = find(x, &std::pair<std::optional<var_t>, std::optional<var_t>>::first);
+        auto const y_pos = find(y, &std::pair<std::optional<var_t>, std::optional<var_t>>::second);
+        return x_pos == y_pos and (x_pos or x == y);
+    }
+};
+
 template <Properties P>
-dep0::expected<std::true_type> is_alpha_equivalent_impl(expr_t<P>&, expr_t<P>&);
+dep0::expected<std::true_type>
+is_alpha_equivalent_impl(alpha_equivalence_state_t<P>&, expr_t<P> const&, expr_t<P> const&);
 
 template <Properties P>
-dep0::expected<std::true_type> is_alpha_equivalent_impl(typename expr_t<P>::app_t&, typename expr_t<P>::app_t&);
+dep0::expected<std::true_type> is_alpha_equivalent_impl(
+    alpha_equivalence_state_t<P>&,
+    typename expr_t<P>::app_t const&,
+    typename expr_t<P>::app_t const&);
 
 /**
  * @brief Check whether two Pi-Types, Sigma-Types or Lambda-Abstractions are alpha-equivalent.
@@ -41,14 +106,23 @@ dep0::expected<std::true_type> is_alpha_equivalent_impl(typename expr_t<P>::app_
  */
 template <Properties P>
 dep0::expected<std::true_type> is_alpha_equivalent_impl(
-    is_mutable_t x_mutable, std::vector<func_arg_t<P>>& x_args, expr_t<P>* x_ret_type, body_t<P>* x_body,
-    is_mutable_t y_mutable, std::vector<func_arg_t<P>>& y_args, expr_t<P>* y_ret_type, body_t<P>* y_body);
+    alpha_equivalence_state_t<P>&,
+    is_mutable_t x_mutable,
+    std::vector<func_arg_t<P>> const& x_args,
+    expr_t<P> const* x_ret_type,
+    body_t<P> const* x_body,
+    is_mutable_t y_mutable,
+    std::vector<func_arg_t<P>> const& y_args,
+    expr_t<P> const* y_ret_type,
+    body_t<P> const* y_body);
 
 template <Properties P>
-dep0::expected<std::true_type> is_alpha_equivalent_impl(body_t<P>&, body_t<P>&);
+dep0::expected<std::true_type>
+is_alpha_equivalent_impl(alpha_equivalence_state_t<P>&, body_t<P> const&, body_t<P> const&);
 
 template <Properties P>
-dep0::expected<std::true_type> is_alpha_equivalent_impl(stmt_t<P>&, stmt_t<P>&);
+dep0::expected<std::true_type>
+is_alpha_equivalent_impl(alpha_equivalence_state_t<P>&, stmt_t<P> const&, stmt_t<P> const&);
 
 /**
  * @brief Visit two expressions to test whether they are alpha-equivalent or not.
@@ -57,6 +131,8 @@ dep0::expected<std::true_type> is_alpha_equivalent_impl(stmt_t<P>&, stmt_t<P>&);
 template <Properties P>
 struct alpha_equivalence_visitor
 {
+    alpha_equivalence_state_t<P>& state;
+
     /** @brief All functions succeed if the two expressions are equivalent, or fail with the reason why they are not. */
     using result_t = dep0::expected<std::true_type>;
 
@@ -121,19 +197,21 @@ struct alpha_equivalence_visitor
             return not_alpha_equivalent(x, y);
     }
 
-    result_t operator()(typename expr_t<P>::boolean_expr_t& x, typename expr_t<P>::boolean_expr_t& y) const
+    result_t operator()(
+        typename expr_t<P>::boolean_expr_t const& x,
+        typename expr_t<P>::boolean_expr_t const& y) const
     {
         return std::visit(
             boost::hana::overload(
-                [] (expr_t<P>::boolean_expr_t::not_t& x, expr_t<P>::boolean_expr_t::not_t& y)
+                [&] (expr_t<P>::boolean_expr_t::not_t const& x, expr_t<P>::boolean_expr_t::not_t const& y)
                 {
-                    return is_alpha_equivalent_impl(x.expr.get(), y.expr.get());
+                    return is_alpha_equivalent_impl(state, x.expr.get(), y.expr.get());
                 },
-                [] <typename T> (T& x, T& y)
+                [&] <typename T> (T const& x, T const& y)
                 {
-                    auto eq = is_alpha_equivalent_impl(x.lhs.get(), y.lhs.get());
+                    auto eq = is_alpha_equivalent_impl(state, x.lhs.get(), y.lhs.get());
                     if (eq)
-                        eq = is_alpha_equivalent_impl(x.rhs.get(), y.rhs.get());
+                        eq = is_alpha_equivalent_impl(state, x.rhs.get(), y.rhs.get());
                     return eq;
                 },
                 [&] <typename T, typename U> (T const&, U const&) requires (not std::is_same_v<T, U>)
@@ -143,15 +221,17 @@ struct alpha_equivalence_visitor
             x.value, y.value);
     };
 
-    result_t operator()(typename expr_t<P>::relation_expr_t& x, typename expr_t<P>::relation_expr_t& y) const
+    result_t operator()(
+        typename expr_t<P>::relation_expr_t const& x,
+        typename expr_t<P>::relation_expr_t const& y) const
     {
         return std::visit(
             boost::hana::overload(
-                [] <typename T> (T& x, T& y)
+                [&] <typename T> (T const& x, T const& y)
                 {
-                    auto eq = is_alpha_equivalent_impl(x.lhs.get(), y.lhs.get());
+                    auto eq = is_alpha_equivalent_impl(state, x.lhs.get(), y.lhs.get());
                     if (eq)
-                        eq = is_alpha_equivalent_impl(x.rhs.get(), y.rhs.get());
+                        eq = is_alpha_equivalent_impl(state, x.rhs.get(), y.rhs.get());
                     return eq;
                 },
                 [&] <typename T, typename U> (T const&, U const&) requires (not std::is_same_v<T, U>)
@@ -161,15 +241,17 @@ struct alpha_equivalence_visitor
             x.value, y.value);
     };
 
-    result_t operator()(typename expr_t<P>::arith_expr_t& x, typename expr_t<P>::arith_expr_t& y) const
+    result_t operator()(
+        typename expr_t<P>::arith_expr_t const& x,
+        typename expr_t<P>::arith_expr_t const& y) const
     {
         return std::visit(
             boost::hana::overload(
-                [] <typename T> (T& x, T& y)
+                [&] <typename T> (T const& x, T const& y)
                 {
-                    auto eq = is_alpha_equivalent_impl(x.lhs.get(), y.lhs.get());
+                    auto eq = is_alpha_equivalent_impl(state, x.lhs.get(), y.lhs.get());
                     if (eq)
-                        eq = is_alpha_equivalent_impl(x.rhs.get(), y.rhs.get());
+                        eq = is_alpha_equivalent_impl(state, x.rhs.get(), y.rhs.get());
                     return eq;
                 },
                 [&] <typename T, typename U> (T const&, U const&) requires (not std::is_same_v<T, U>)
@@ -181,7 +263,7 @@ struct alpha_equivalence_visitor
 
     result_t operator()(typename expr_t<P>::var_t const& x, typename expr_t<P>::var_t const& y) const
     {
-        if (x == y)
+        if (state.is_same_var(x, y))
             return std::true_type{};
         else
             return not_alpha_equivalent(x, y);
@@ -195,53 +277,56 @@ struct alpha_equivalence_visitor
             return not_alpha_equivalent(x, y);
     }
 
-    result_t operator()(typename expr_t<P>::app_t& x, typename expr_t<P>::app_t& y) const
+    result_t operator()(typename expr_t<P>::app_t const& x, typename expr_t<P>::app_t const& y) const
     {
-        return is_alpha_equivalent_impl<P>(x, y);
+        return is_alpha_equivalent_impl<P>(state, x, y);
     }
 
-    result_t operator()(typename expr_t<P>::abs_t& x, typename expr_t<P>::abs_t& y) const
+    result_t operator()(typename expr_t<P>::abs_t const& x, typename expr_t<P>::abs_t const& y) const
     {
         return is_alpha_equivalent_impl(
+            state,
             x.is_mutable, x.args, &x.ret_type.get(), &x.body,
             y.is_mutable, y.args, &y.ret_type.get(), &y.body);
     }
 
-    result_t operator()(typename expr_t<P>::pi_t& x, typename expr_t<P>::pi_t& y) const
+    result_t operator()(typename expr_t<P>::pi_t const& x, typename expr_t<P>::pi_t const& y) const
     {
         return is_alpha_equivalent_impl<P>(
+            state,
             x.is_mutable, x.args, &x.ret_type.get(), nullptr,
             y.is_mutable, y.args, &y.ret_type.get(), nullptr);
     }
 
-    result_t operator()(typename expr_t<P>::sigma_t& x, typename expr_t<P>::sigma_t& y) const
+    result_t operator()(typename expr_t<P>::sigma_t const& x, typename expr_t<P>::sigma_t const& y) const
     {
         return is_alpha_equivalent_impl<P>(
+            state,
             ast::is_mutable_t::no, x.args, nullptr, nullptr,
             ast::is_mutable_t::no, y.args, nullptr, nullptr);
     }
 
     result_t operator()(typename expr_t<P>::ref_t, typename expr_t<P>::ref_t) const { return {}; }
     result_t operator()(typename expr_t<P>::scope_t, typename expr_t<P>::scope_t) const { return {}; }
-    result_t operator()(typename expr_t<P>::addressof_t& x, typename expr_t<P>::addressof_t& y) const
+    result_t operator()(typename expr_t<P>::addressof_t const& x, typename expr_t<P>::addressof_t const& y) const
     {
-        return is_alpha_equivalent_impl(x.expr.get(), y.expr.get());
+        return is_alpha_equivalent_impl(state, x.expr.get(), y.expr.get());
     }
-    result_t operator()(typename expr_t<P>::deref_t& x, typename expr_t<P>::deref_t& y) const
+    result_t operator()(typename expr_t<P>::deref_t const& x, typename expr_t<P>::deref_t const& y) const
     {
-        return is_alpha_equivalent_impl(x.expr.get(), y.expr.get());
+        return is_alpha_equivalent_impl(state, x.expr.get(), y.expr.get());
     }
-    result_t operator()(typename expr_t<P>::scopeof_t& x, typename expr_t<P>::scopeof_t& y) const
+    result_t operator()(typename expr_t<P>::scopeof_t const& x, typename expr_t<P>::scopeof_t const& y) const
     {
-        return is_alpha_equivalent_impl(x.expr.get(), y.expr.get());
+        return is_alpha_equivalent_impl(state, x.expr.get(), y.expr.get());
     }
 
-    result_t operator()(typename expr_t<P>::array_t&, typename expr_t<P>::array_t&) const
+    result_t operator()(typename expr_t<P>::array_t const&, typename expr_t<P>::array_t const&) const
     {
         return std::true_type{};
     }
 
-    result_t operator()(typename expr_t<P>::init_list_t& x, typename expr_t<P>::init_list_t& y) const
+    result_t operator()(typename expr_t<P>::init_list_t const& x, typename expr_t<P>::init_list_t const& y) const
     {
         if (x.values.size() != y.values.size())
         {
@@ -251,14 +336,14 @@ struct alpha_equivalence_visitor
             return dep0::error_t(err.str());
         }
         for (auto const i: std::views::iota(0ul, x.values.size()))
-            if (auto eq = is_alpha_equivalent_impl(x.values[i], y.values[i]); not eq)
+            if (auto eq = is_alpha_equivalent_impl(state, x.values[i], y.values[i]); not eq)
                 return eq;
         return {};
     }
 
-    result_t operator()(typename expr_t<P>::member_t& x, typename expr_t<P>::member_t& y) const
+    result_t operator()(typename expr_t<P>::member_t const& x, typename expr_t<P>::member_t const& y) const
     {
-        auto eq = is_alpha_equivalent_impl(x.object.get(), y.object.get());
+        auto eq = is_alpha_equivalent_impl(state, x.object.get(), y.object.get());
         if (eq and x.field != y.field)
         {
             std::ostringstream err;
@@ -269,44 +354,44 @@ struct alpha_equivalence_visitor
         return eq;
     }
 
-    result_t operator()(typename expr_t<P>::subscript_t& x, typename expr_t<P>::subscript_t& y) const
+    result_t operator()(typename expr_t<P>::subscript_t const& x, typename expr_t<P>::subscript_t const& y) const
     {
-        auto eq = is_alpha_equivalent_impl(x.object.get(), y.object.get());
+        auto eq = is_alpha_equivalent_impl(state, x.object.get(), y.object.get());
         if (eq)
-            eq = is_alpha_equivalent_impl(x.index.get(), y.index.get());
+            eq = is_alpha_equivalent_impl(state, x.index.get(), y.index.get());
         return eq;
     }
 
-    result_t operator()(typename expr_t<P>::because_t& x, typename expr_t<P>::because_t& y) const
+    result_t operator()(typename expr_t<P>::because_t const& x, typename expr_t<P>::because_t const& y) const
     {
-        return is_alpha_equivalent_impl(x.value.get(), y.value.get());
+        return is_alpha_equivalent_impl(state, x.value.get(), y.value.get());
     }
 
-    result_t operator()(typename stmt_t<P>::if_else_t& x, typename stmt_t<P>::if_else_t& y) const
+    result_t operator()(typename stmt_t<P>::if_else_t const& x, typename stmt_t<P>::if_else_t const& y) const
     {
-        auto eq = is_alpha_equivalent_impl(x.cond, y.cond);
+        auto eq = is_alpha_equivalent_impl(state, x.cond, y.cond);
         if (eq)
-            eq = is_alpha_equivalent_impl(x.true_branch, y.true_branch);
+            eq = is_alpha_equivalent_impl(state, x.true_branch, y.true_branch);
         if (eq)
         {
             if (x.false_branch.has_value() xor y.false_branch.has_value())
                 return dep0::error_t("if-statement with an else branch is not alpha-equivalent to one without");
             if (x.false_branch)
-                eq = is_alpha_equivalent_impl(*x.false_branch, *y.false_branch);
+                eq = is_alpha_equivalent_impl(state, *x.false_branch, *y.false_branch);
         }
         return eq;
     }
 
-    result_t operator()(typename stmt_t<P>::return_t& x, typename stmt_t<P>::return_t& y) const
+    result_t operator()(typename stmt_t<P>::return_t const& x, typename stmt_t<P>::return_t const& y) const
     {
         if (x.expr.has_value() xor y.expr.has_value())
             return dep0::error_t("return statement with expression is not alpha-equivalent to one without");
         if (x.expr)
-            return is_alpha_equivalent_impl(*x.expr, *y.expr);
+            return is_alpha_equivalent_impl(state, *x.expr, *y.expr);
         return {};
     }
 
-    result_t operator()(typename stmt_t<P>::impossible_t&, typename stmt_t<P>::impossible_t&) const
+    result_t operator()(typename stmt_t<P>::impossible_t const&, typename stmt_t<P>::impossible_t const&) const
     {
         // whether an explicit proof of false is supplied or not is irrelevant,
         // both forms are alpha-equivalent to each other
@@ -315,22 +400,26 @@ struct alpha_equivalence_visitor
 };
 
 template <Properties P>
-dep0::expected<std::true_type> is_alpha_equivalent_impl(expr_t<P>& x, expr_t<P>& y)
+dep0::expected<std::true_type>
+is_alpha_equivalent_impl(alpha_equivalence_state_t<P>& state, expr_t<P> const& x, expr_t<P> const& y)
 {
     auto const because_x = std::get_if<typename expr_t<P>::because_t>(&x.value);
     auto const because_y = std::get_if<typename expr_t<P>::because_t>(&y.value);
     if (because_x and because_y)
-        return is_alpha_equivalent_impl(because_x->value.get(), because_y->value.get());
+        return is_alpha_equivalent_impl(state, because_x->value.get(), because_y->value.get());
     else if (because_x or because_y)
         return because_x
-            ? is_alpha_equivalent_impl(because_x->value.get(), y)
-            : is_alpha_equivalent_impl(x, because_y->value.get());
+            ? is_alpha_equivalent_impl(state, because_x->value.get(), y)
+            : is_alpha_equivalent_impl(state, x, because_y->value.get());
     else
-        return std::visit(alpha_equivalence_visitor<P>{}, x.value, y.value);
+        return std::visit(alpha_equivalence_visitor<P>{state}, x.value, y.value);
 }
 
 template <Properties P>
-dep0::expected<std::true_type> is_alpha_equivalent_impl(typename expr_t<P>::app_t& x, typename expr_t<P>::app_t& y)
+dep0::expected<std::true_type> is_alpha_equivalent_impl(
+    alpha_equivalence_state_t<P>& state,
+    typename expr_t<P>::app_t const& x,
+    typename expr_t<P>::app_t const& y)
 {
     if (x.args.size() != y.args.size())
     {
@@ -339,18 +428,25 @@ dep0::expected<std::true_type> is_alpha_equivalent_impl(typename expr_t<P>::app_
         err << "application with " << y.args.size();
         return dep0::error_t(err.str());
     }
-    if (auto eq = is_alpha_equivalent_impl(x.func.get(), y.func.get()); not eq)
+    if (auto eq = is_alpha_equivalent_impl(state, x.func.get(), y.func.get()); not eq)
         return eq;
     for (auto const i: std::views::iota(0ul, x.args.size()))
-        if (auto eq = is_alpha_equivalent_impl(x.args[i], y.args[i]); not eq)
+        if (auto eq = is_alpha_equivalent_impl(state, x.args[i], y.args[i]); not eq)
             return eq;
     return {};
 }
 
 template <Properties P>
 dep0::expected<std::true_type> is_alpha_equivalent_impl(
-    is_mutable_t const x_mutable, std::vector<func_arg_t<P>>& x_args, expr_t<P>* x_ret_type, body_t<P>* x_body,
-    is_mutable_t const y_mutable, std::vector<func_arg_t<P>>& y_args, expr_t<P>* y_ret_type, body_t<P>* y_body)
+    alpha_equivalence_state_t<P>& state,
+    is_mutable_t const x_mutable,
+    std::vector<func_arg_t<P>> const& x_args,
+    expr_t<P> const* const x_ret_type,
+    body_t<P> const* const x_body,
+    is_mutable_t const y_mutable,
+    std::vector<func_arg_t<P>> const& y_args,
+    expr_t<P> const* const y_ret_type,
+    body_t<P> const* const y_body)
 {
     if (x_mutable != y_mutable)
         return dep0::error_t(
@@ -385,53 +481,19 @@ dep0::expected<std::true_type> is_alpha_equivalent_impl(
         pretty_print(err << " is not alpha-equivalent to `", y_args[i]) << '`';
         return dep0::error_t(err.str());
     };
+    // the binders introduced by these arguments go out of scope when returning, whether equivalent or not
+    auto&& _ = boost::scope::make_scope_exit([&state, size=state.size()] { state.pop(size); });
     for (auto const i: std::views::iota(0ul, x_args.size()))
     {
-        auto& x_arg = x_args[i];
-        auto& y_arg = y_args[i];
-        if (auto eq = is_alpha_equivalent_impl(x_arg.type, y_arg.type); not eq)
+        auto const& x_arg = x_args[i];
+        auto const& y_arg = y_args[i];
+        if (auto eq = is_alpha_equivalent_impl(state, x_arg.type, y_arg.type); not eq)
         {
             auto err = not_alpha_equivalent(i);
             err.reasons.push_back(std::move(eq.error()));
             return err;
         }
-        if (x_arg.var and y_arg.var)
-        {
-            auto& x_var = *x_arg.var;
-            auto& y_var = *y_arg.var;
-            if (x_var == y_var)
-                continue;
-            x_var = x_ret_type
-                ? rename(x_var, x_args.begin() + i + 1, x_args.end(), *x_ret_type, x_body)
-                : rename<P>(x_var, x_args.begin() + i + 1, x_args.end());
-            y_var = y_ret_type
-                ? rename(y_var, y_args.begin() + i + 1, y_args.end(), *y_ret_type, y_body)
-                : rename<P>(y_var, y_args.begin() + i + 1, y_args.end());
-
-            if (x_var == y_var)
-                // by pure luck renaming assigned the same name to both
-                continue;
-            // renaming assigns the next unused index number counting upwards;
-            // so if index of x_var is greater than that of y_var, we know that `x_var` does not occur
-            // in the renamed y, and viceversa; we can therefore safely replace x_var in y (or viceversa);
-            if (x_var.idx > y_var.idx)
-            {
-                if (y_ret_type)
-                    replace(y_var, x_var, y_args.begin() + i + 1, y_args.end(), *y_ret_type, y_body);
-                else
-                    replace<P>(y_var, x_var, y_args.begin() + i + 1, y_args.end());
-                y_var = x_var; // just in case; otherwise error messages might look odd and even confusing
-            }
-            else
-            {
-                if (x_ret_type)
-                    replace(x_var, y_var, x_args.begin() + i + 1, x_args.end(), *x_ret_type, x_body);
-                else
-                    replace<P>(x_var, y_var, x_args.begin() + i + 1, x_args.end());
-                x_var = y_var; // ditto
-            }
-        }
-        else if (x_arg.var.has_value() xor y_arg.var.has_value())
+        if (x_arg.var.has_value() xor y_arg.var.has_value())
         {
             auto const occurs_free = [] <typename... Args> (Args&&...args)
             {
@@ -468,20 +530,23 @@ dep0::expected<std::true_type> is_alpha_equivalent_impl(
                     return occurs_somewhere();
             }
         }
+        // even a named argument that does not occur anywhere must shadow any outer binder with the same name
+        state.push(x_arg.var, y_arg.var);
     }
     if (x_ret_type and y_ret_type)
-        if (auto eq = is_alpha_equivalent_impl(*x_ret_type, *y_ret_type); not eq)
+        if (auto eq = is_alpha_equivalent_impl(state, *x_ret_type, *y_ret_type); not eq)
         {
             std::ostringstream err;
             pretty_print(err << "return type `", *x_ret_type) << '`';
             pretty_print(err << " is not alpha-equivalent to `", *y_ret_type) << '`';
             return dep0::error_t(err.str(), {std::move(eq.error())});
         }
-    return x_body and y_body ? is_alpha_equivalent_impl(*x_body, *y_body) : dep0::expected<std::true_type>{};
+    return x_body and y_body ? is_alpha_equivalent_impl(state, *x_body, *y_body) : dep0::expected<std::true_type>{};
 }
 
 template <Properties P>
-dep0::expected<std::true_type> is_alpha_equivalent_impl(body_t<P>& x, body_t<P>& y)
+dep0::expected<std::true_type>
+is_alpha_equivalent_impl(alpha_equivalence_state_t<P>& state, body_t<P> const& x, body_t<P> const& y)
 {
     if (x.stmts.size() != y.stmts.size())
     {
@@ -491,15 +556,16 @@ dep0::expected<std::true_type> is_alpha_equivalent_impl(body_t<P>& x, body_t<P>&
         return dep0::error_t(err.str());
     }
     for (auto const i: std::views::iota(0ul, x.stmts.size()))
-        if (auto eq = is_alpha_equivalent_impl(x.stmts[i], y.stmts[i]); not eq)
+        if (auto eq = is_alpha_equivalent_impl(state, x.stmts[i], y.stmts[i]); not eq)
             return eq;
     return {};
 }
 
 template <Properties P>
-dep0::expected<std::true_type> is_alpha_equivalent_impl(stmt_t<P>& x, stmt_t<P>& y)
+dep0::expected<std::true_type>
+is_alpha_equivalent_impl(alpha_equivalence_state_t<P>& state, stmt_t<P> const& x, stmt_t<P> const& y)
 {
-    return std::visit(alpha_equivalence_visitor<P>{}, x.value, y.value);
+    return std::visit(alpha_equivalence_visitor<P>{state}, x.value, y.value);
 }
 
 } // namespace impl
@@ -507,14 +573,8 @@ dep0::expected<std::true_type> is_alpha_equivalent_impl(stmt_t<P>& x, stmt_t<P>&
 template <Properties P>
 dep0::expected<std::true_type> is_alpha_equivalent(expr_t<P> const& x, expr_t<P> const& y)
 {
-    // TODO we should make a lazy copy somehow, because renaming might be often unnecessary.
-    // Alternatively we could try something like this:
-    // 1. make the whole implementation templated over const-ref or mutable-ref, eg via `bool mutable` flag;
-    // 2. the immutable version will return an empty optional if renaming is necessary to establish equivalence;
-    // 3. only at that point actually make the copy and try again, but the mutable-ref does not return an optional.
-    auto x2 = x;
-    auto y2 = y;
-    return impl::is_alpha_equivalent_impl(x2, y2);
+    impl::alpha_equivalence_state_t<P> state;
+    return impl::is_alpha_equivalent_impl(state, x, y);
 }
 
 } // namespace dep0::ast
@@ -18,10 +18,11 @@
 #include "dep0/ast/mutable.hpp"
 #include "dep0/ast/width.hpp"
 
+#include "dep0/recursive_wrapper.hpp"
 #include "dep0/source.hpp"
 
+#include <boost/container_hash/hash.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
-#include <boost/variant/recursive_wrapper.hpp>
 
 #include <optional>
 #include <tuple>
@@ -65,7 +66,7 @@ struct body_t
 template <Properties P>
 struct expr_t
 {
-    using rec_t = boost::recursive_wrapper<expr_t>;
+    using rec_t = dep0::recursive_wrapper<expr_t>;
     using properties_t = typename P::expr_properties_type;
 
     /** @brief Represents the `typename` keyword, whose values are types; for example `i32_t` and `%bool_t`. */
@@ -215,6 +216,13 @@ struct expr_t
         bool operator<(var_t const& that) const
             { return std::tie(name, idx, shadow_id) < std::tie(that.name, that.idx, that.shadow_id); }
         bool operator==(var_t const&) const = default;
+        friend std::size_t hash_value(var_t const& x)
+        {
+            auto seed = hash_value(x.name);
+            boost::hash_combine(seed, x.idx);
+            boost::hash_combine(seed, x.shadow_id);
+            return seed;
+        }
     };
 
     /**
@@ -250,6 +258,14 @@ struct expr_t
             return std::tie(module_name, name) < std::tie(that.module_name, that.name);
         }
         bool operator==(global_t const&) const = default;
+        friend std::size_t hash_value(global_t const& x)
+        {
+            auto seed = hash_value(x.name);
+            boost::hash_combine(seed, x.module_name.has_value());
+            if (x.module_name)
+                boost::hash_combine(seed, hash_value(*x.module_name));
+            return seed;
+        }
     };
 
     /**
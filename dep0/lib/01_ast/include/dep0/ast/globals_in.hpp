@@ -0,0 +1,46 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Declares `dep0::ast::globals_in()` and all its overloads.
+ */
+#pragma once
+
+#include "dep0/ast/ast.hpp"
+
+#include <set>
+
+namespace dep0::ast {
+
+/** @brief Add to the given set all global symbols, i.e. functions and types, that appear in the given expression. */
+template <Properties P>
+void globals_in(expr_t<P> const&, std::set<typename expr_t<P>::global_t>&);
+
+/**
+ * @brief Add to the given set all global symbols that appear in:
+ *   - any function argument
+ *   - the function return type
+ *   - the function body, if one is supplied.
+ */
+template <Properties P>
+void globals_in(
+    typename std::vector<func_arg_t<P>>::const_iterator begin,
+    typename std::vector<func_arg_t<P>>::const_iterator end,
+    expr_t<P> const& ret_type,
+    body_t<P> const* body,
+    std::set<typename expr_t<P>::global_t>&);
+
+/** @brief Overload to use for struct definitions. */
+template <Properties P>
+void globals_in(
+    typename std::vector<typename type_def_t<P>::struct_t::field_t>::const_iterator begin,
+    typename std::vector<typename type_def_t<P>::struct_t::field_t>::const_iterator end,
+    std::set<typename expr_t<P>::global_t>&);
+
+} // namespace dep0::ast
+
+#include "dep0/ast/globals_in_impl.hpp"
@@ -0,0 +1,195 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Implementation details for @ref globals_in.hpp
+ */
+#pragma once
+
+#include "dep0/ast/globals_in.hpp"
+
+#include "dep0/match.hpp"
+
+namespace dep0::ast {
+
+namespace impl {
+
+template <Properties P> using globals_t = std::set<typename expr_t<P>::global_t>;
+
+template <Properties P> void globals_in(body_t<P> const&, globals_t<P>&);
+template <Properties P> void globals_in(typename expr_t<P>::app_t const&, globals_t<P>&);
+
+template <Properties P>
+void globals_in(body_t<P> const& x, globals_t<P>& out)
+{
+    for (auto const& s: x.stmts)
+        match(
+            s.value,
+            [&] (expr_t<P>::app_t const& x)
+            {
+                globals_in<P>(x, out);
+            },
+            [&] (stmt_t<P>::if_else_t const& if_)
+            {
+                ast::globals_in(if_.cond, out);
+                globals_in(if_.true_branch, out);
+                if (if_.false_branch)
+                    globals_in(*if_.false_branch, out);
+            },
+            [&] (stmt_t<P>::return_t const& ret)
+            {
+                if (ret.expr)
+                    ast::globals_in(*ret.expr, out);
+            },
+            [&] (stmt_t<P>::impossible_t const& x)
+            {
+                if (x.reason)
+                    ast::globals_in(*x.reason, out);
+            });
+}
+
+template <Properties P>
+void globals_in(typename expr_t<P>::app_t const& x, globals_t<P>& out)
+{
+    ast::globals_in(x.func.get(), out);
+    for (auto const& arg: x.args)
+        ast::globals_in(arg, out);
+}
+
+} // namespace impl
+
+template <Properties P>
+void globals_in(expr_t<P> const& x, std::set<typename expr_t<P>::global_t>& out)
+{
+    match(
+        x.value,
+        [] (expr_t<P>::typename_t const&) { },
+        [] (expr_t<P>::true_t const&) { },
+        [] (expr_t<P>::auto_t const&) { },
+        [] (expr_t<P>::bool_t const&) { },
+        [] (expr_t<P>::cstr_t const&) { },
+        [] (expr_t<P>::unit_t const&) { },
+        [] (expr_t<P>::i8_t const&) { },
+        [] (expr_t<P>::i16_t const&) { },
+        [] (expr_t<P>::i32_t const&) { },
+        [] (expr_t<P>::i64_t const&) { },
+        [] (expr_t<P>::u8_t const&) { },
+        [] (expr_t<P>::u16_t const&) { },
+        [] (expr_t<P>::u32_t const&) { },
+        [] (expr_t<P>::u64_t const&) { },
+        [] (expr_t<P>::boolean_constant_t const&) { },
+        [] (expr_t<P>::numeric_constant_t const&) { },
+        [] (expr_t<P>::string_literal_t const&) { },
+        [&] (expr_t<P>::boolean_expr_t const& x)
+        {
+            match(
+                x.value,
+                [&] (expr_t<P>::boolean_expr_t::not_t const& x)
+                {
+                    globals_in(x.expr.get(), out);
+                },
+                [&] (auto const& x)
+                {
+                    globals_in(x.lhs.get(), out);
+                    globals_in(x.rhs.get(), out);
+                });
+        },
+        [&] (expr_t<P>::relation_expr_t const& x)
+        {
+            match(
+                x.value,
+                [&] (auto const& x)
+                {
+                    globals_in(x.lhs.get(), out);
+                    globals_in(x.rhs.get(), out);
+                });
+        },
+        [&] (expr_t<P>::arith_expr_t const& x)
+        {
+            match(
+                x.value,
+                [&] (auto const& x)
+                {
+                    globals_in(x.lhs.get(), out);
+                    globals_in(x.rhs.get(), out);
+                });
+        },
+        [] (expr_t<P>::var_t const&) { },
+        [&] (expr_t<P>::global_t const& x)
+        {
+            out.insert(x);
+        },
+        [&] (expr_t<P>::app_t const& x)
+        {
+            impl::globals_in<P>(x, out);
+        },
+        [&] (expr_t<P>::abs_t const& x)
+        {
+            globals_in<P>(x.args.begin(), x.args.end(), x.ret_type.get(), &x.body, out);
+        },
+        [&] (expr_t<P>::pi_t const& x)
+        {
+            globals_in<P>(x.args.begin(), x.args.end(), x.ret_type.get(), nullptr, out);
+        },
+        [&] (expr_t<P>::sigma_t const& x)
+        {
+            for (auto const& arg: x.args)
+                globals_in(arg.type, out);
+        },
+        [] (expr_t<P>::ref_t const&) { },
+        [] (expr_t<P>::scope_t const&) { },
+        [&] (expr_t<P>::addressof_t const& x) { globals_in(x.expr.get(), out); },
+        [&] (expr_t<P>::deref_t const& x) { globals_in(x.expr.get(), out); },
+        [&] (expr_t<P>::scopeof_t const& x) { globals_in(x.expr.get(), out); },
+        [] (expr_t<P>::array_t const&) { },
+        [&] (expr_t<P>::init_list_t const& x)
+        {
+            for (auto const& v: x.values)
+                globals_in(v, out);
+        },
+        [&] (expr_t<P>::member_t const& x)
+        {
+            globals_in(x.object.get(), out);
+        },
+        [&] (expr_t<P>::subscript_t const& x)
+        {
+            globals_in(x.object.get(), out);
+            globals_in(x.index.get(), out);
+        },
+        [&] (expr_t<P>::because_t const& x)
+        {
+            globals_in(x.value.get(), out);
+            globals_in(x.reason.get(), out);
+        });
+}
+
+template <Properties P>
+void globals_in(
+    typename std::vector<func_arg_t<P>>::const_iterator const begin,
+    typename std::vector<func_arg_t<P>>::const_iterator const end,
+    expr_t<P> const& ret_type,
+    body_t<P> const* const body,
+    std::set<typename expr_t<P>::global_t>& out)
+{
+    for (auto it = begin; it != end; ++it)
+        globals_in(it->type, out);
+    globals_in(ret_type, out);
+    if (body)
+        impl::globals_in(*body, out);
+}
+
+template <Properties P>
+void globals_in(
+    typename std::vector<typename type_def_t<P>::struct_t::field_t>::const_iterator const begin,
+    typename std::vector<typename type_def_t<P>::struct_t::field_t>::const_iterator const end,
+    std::set<typename expr_t<P>::global_t>& out)
+{
+    for (auto it = begin; it != end; ++it)
+        globals_in(it->type, out);
+}
+
+} // namespace dep0::ast
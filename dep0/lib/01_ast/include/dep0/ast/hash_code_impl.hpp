@@ -16,8 +16,10 @@
 
 #include <boost/container_hash/hash.hpp>
 
-#include <map>
+#include <algorithm>
 #include <ranges>
+#include <utility>
+#include <vector>
 
 namespace dep0::ast {
 
@@ -46,24 +48,29 @@ static std::size_t combine(std::size_t a, std::size_t const b, std::size_t const
  *   - its unique ID, if it is bound to a function argument;
  *   - or the hash of its actual name, if it is a free variable.
  *
+ * Binders are stored in a flat vector, rather than a map, because expressions typically bind very few variables
+ * and most of them bind none at all, in which case computing the hash code does not allocate any memory.
+ * Lookup scans backwards, so that the most recent binder of a name shadows any previous one.
+ *
  * @see @ref alpha_equivalence
  */
 template <typename P>
 class hash_code_state_t
 {
-    std::size_t next_id = 0ul;
-    std::map<typename expr_t<P>::var_t, std::size_t> unique_var_id;
+    std::vector<std::pair<typename expr_t<P>::var_t, std::size_t>> unique_var_id;
 
 public:
     void store(typename expr_t<P>::var_t const& x)
     {
-        unique_var_id[x] = next_id++;
+        unique_var_id.emplace_back(x, unique_var_id.size());
     }
 
-    std::optional<std::size_t> find(typename expr_t<P>::var_t const& x)
+    std::optional<std::size_t> find(typename expr_t<P>::var_t const& x) const
     {
-        auto const it = unique_var_id.find(x);
-        if (it == unique_var_id.end())
+        auto const it = std::find_if(
+            unique_var_id.rbegin(), unique_var_id.rend(),
+            [&] (auto const& binder) { return binder.first == x; });
+        if (it == unique_var_id.rend())
             return std::nullopt;
         else
             return it->second;
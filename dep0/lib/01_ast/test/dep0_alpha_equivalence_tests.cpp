@@ -88,6 +88,17 @@ BOOST_AUTO_TEST_CASE(pi_test)
     BOOST_TEST(yay(
         pi({arg(typename_(), "x"), arg(i32(), "x")}, i32()),
         pi({arg(typename_()), arg(i32())}, i32())));
+
+    // bound variables are compared by the position of their binder, even when names are swapped or shadowed
+    BOOST_TEST(yay(
+        pi({arg(typename_(), "x")}, pi({arg(typename_(), "y")}, var("x"))),
+        pi({arg(typename_(), "y")}, pi({arg(typename_(), "x")}, var("y")))));
+    BOOST_TEST(nay(
+        pi({arg(typename_(), "x")}, pi({arg(typename_(), "y")}, var("x"))),
+        pi({arg(typename_(), "y")}, pi({arg(typename_(), "x")}, var("x")))));
+    BOOST_TEST(nay(
+        pi({arg(typename_(), "x")}, pi({arg(typename_(), "x")}, var("x"))),
+        pi({arg(typename_(), "x")}, pi({arg(typename_(), "y")}, var("x")))));
 }
 
 BOOST_AUTO_TEST_CASE(abs_test)
@@ -113,6 +124,12 @@ BOOST_AUTO_TEST_CASE(abs_test)
     BOOST_TEST(yay(
         abs({arg(i32(), "x"), arg(i32(), "x")}, i32(), body(return_(var("y")))),
         abs({arg(i32()), arg(i32())}, i32(), body(return_(var("y"))))));
+    BOOST_TEST(yay(
+        abs({arg(i32(), "x"), arg(i32(), "y")}, i32(), body(return_(var("x")))),
+        abs({arg(i32(), "y"), arg(i32(), "x")}, i32(), body(return_(var("y"))))));
+    BOOST_TEST(nay(
+        abs({arg(i32(), "x"), arg(i32(), "y")}, i32(), body(return_(var("x")))),
+        abs({arg(i32(), "y"), arg(i32(), "x")}, i32(), body(return_(var("x"))))));
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -19,10 +19,55 @@
 
 namespace dep0::parser {
 
+/** @brief The implementations of the parser that can be used to parse source code. */
+enum class front_end_t
+{
+    antlr, /**< The parser generated by ANTLR4 from the grammar in `DepCParser.g4`. */
+    recursive_descent /**< A hand-written lexer and recursive-descent parser for the same grammar. */
+};
+
+/** @brief How the parser generated by ANTLR4 predicts which alternative of a rule to take. */
+enum class prediction_mode_t
+{
+    /**
+     * First try the faster SLL prediction, stopping at the first syntax error;
+     * only if that fails, parse again from the beginning with full LL prediction.
+     * SLL can only fail on inputs that are either invalid or for which full LL is required,
+     * so the resulting AST, or error, is always the same as with `ll`.
+     */
+    two_stage,
+    ll /**< Always use full LL prediction. */
+};
+
+/** @brief Options that control how source code is parsed. */
+struct parse_options_t
+{
+    /**
+     * @brief Which parser to use.
+     *
+     * Both parsers accept the same language and produce the same AST, including source locations;
+     * the hand-written one avoids building a parse tree and is therefore faster.
+     */
+    front_end_t front_end = front_end_t::antlr;
+
+    /** @brief Which prediction mode to use; only relevant for `front_end_t::antlr`. */
+    prediction_mode_t prediction_mode = prediction_mode_t::two_stage;
+};
+
 /** @brief Open the given file and parse its content. */
-expected<module_t> parse(std::filesystem::path const&) noexcept;
+expected<module_t> parse(std::filesystem::path const&, parse_options_t const& = {}) noexcept;
 
 /** @brief Parse the given source text. */
-expected<module_t> parse(source_text) noexcept;
+expected<module_t> parse(source_text, parse_options_t const& = {}) noexcept;
+
+/**
+ * @brief Parse, only once per process, a snippet of code that exercises all rules of the grammar.
+ *
+ * The prediction cache of the parser generated by ANTLR4 is shared by all files parsed in the same process.
+ * Warming it up before parsing many files in parallel avoids each thread computing, and then contending to store,
+ * the same predictions at the same time.
+ * Does nothing for `front_end_t::recursive_descent`.
+ */
+void warm_up(parse_options_t const& = {}) noexcept;
 
 }
@@ -7,6 +7,7 @@
 #include "dep0/parser/parse.hpp"
 
 #include "private/parse_cpp_int.hpp"
+#include "private/recursive_descent_parser.hpp"
 
 #include "dep0/antlr4/DepCLexer.h"
 #include "dep0/antlr4/DepCParser.h"
@@ -15,11 +16,14 @@
 #include "dep0/digit_separator.hpp"
 #include "dep0/fmap.hpp"
 #include "dep0/mmap.hpp"
+#include "dep0/stats.hpp"
 
 #include <antlr4-runtime/antlr4-runtime.h>
 
 #include <algorithm>
+#include <mutex>
 #include <optional>
+#include <string_view>
 
 namespace dep0::parser {
 
@@ -772,16 +776,24 @@ struct FirstErrorListener : antlr4::ANTLRErrorListener
     }
 };
 
-expected<module_t> parse(std::filesystem::path const& path) noexcept
+static stats_counter_t num_files("parser", "files");
+static stats_counter_t num_bytes("parser", "bytes");
+static stats_counter_t num_ll_fallbacks("parser", "ll_fallbacks");
+
+expected<module_t> parse(std::filesystem::path const& path, parse_options_t const& options) noexcept
 {
     if (auto source = mmap(path))
-        return parse(std::move(*source));
+        return parse(std::move(*source), options);
     else
         return source.error();
 }
 
-expected<module_t> parse(source_text source) noexcept
+expected<module_t> parse(source_text source, parse_options_t const& options) noexcept
 {
+    num_files.add();
+    num_bytes.add(source.size());
+    if (options.front_end == front_end_t::recursive_descent)
+        return parse_by_recursive_descent(std::move(source));
     auto input = antlr4::ANTLRInputStream(source);
     dep0::DepCLexer lexer(&input);
     FirstErrorListener error_listener{source};
@@ -793,10 +805,33 @@ expected<module_t> parse(source_text source) noexcept
         return std::move(*error_listener.error);
     dep0::DepCParser parser(&tokens);
     parser.removeErrorListeners();
-    parser.addErrorListener(&error_listener);
-    dep0::DepCParser::ModuleContext* module = parser.module();
-    if (error_listener.error)
-        return std::move(*error_listener.error);
+    dep0::DepCParser::ModuleContext* module = nullptr;
+    if (options.prediction_mode == prediction_mode_t::two_stage)
+    {
+        // SLL prediction is enough for most inputs; if it fails, either the input is invalid or it needs full LL,
+        // so bail out at the first error and parse again from the beginning with full LL and error reporting
+        parser.getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode(antlr4::atn::PredictionMode::SLL);
+        parser.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+        try
+        {
+            module = parser.module();
+        }
+        catch (antlr4::ParseCancellationException const&)
+        {
+            num_ll_fallbacks.add();
+            module = nullptr;
+            parser.reset(); // this also rewinds the token stream
+            parser.setErrorHandler(std::make_shared<antlr4::DefaultErrorStrategy>());
+            parser.getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode(antlr4::atn::PredictionMode::LL);
+        }
+    }
+    if (not module)
+    {
+        parser.addErrorListener(&error_listener);
+        module = parser.module();
+        if (error_listener.error)
+            return std::move(*error_listener.error);
+    }
     try
     {
         parse_visitor_t visitor(source);
@@ -808,4 +843,42 @@ expected<module_t> parse(source_text source) noexcept
     }
 }
 
+static constexpr std::string_view warm_up_source = R"depc(
+typedef nat_t = unsigned 64 bit integer;
+struct pair_t { i32_t first; (bool_t, cstr_t) second; };
+axiom lemma(u64_t n, true_t(n > 0) h) -> true_t(n >= 1);
+extern puts(cstr_t) -> i32_t;
+func [[builtin]] id(0 typename t, 1 t x) mutable -> t;
+func f(array_t(i32_t, 3) xs, ref_t(i32_t, scope_t) r, (i64_t) -> bool_t p) -> i32_t
+{
+    if (not p(xs[0]) and (xs[1] + -1 < 2 * 3 / 4 or xs[2] != 0))
+        return { 1, true, "two" }.first because auto;
+    else if (::id(i32_t, *&xs[0]) == std::f(scopeof(r))->x)
+    {
+        puts("hi");
+        impossible because true;
+    }
+    return (xs[2] - +1);
+}
+func g() -> unit_t { impossible; }
+)depc";
+
+void warm_up(parse_options_t const& options) noexcept
+{
+    if (options.front_end != front_end_t::antlr)
+        return;
+    static std::once_flag once;
+    std::call_once(
+        once,
+        [&]
+        {
+            // the warm-up is not part of the user's input, so it must not show up in the statistics
+            bool const collect_stats = stats_enabled();
+            enable_stats(false);
+            [[maybe_unused]] auto const result = parse(source_text::from_static_buffer(warm_up_source), options);
+            assert(result.has_value());
+            enable_stats(collect_stats);
+        });
+}
+
 }
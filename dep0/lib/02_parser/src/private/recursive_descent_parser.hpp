@@ -0,0 +1,33 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Single-function header declaring `dep0::parser::parse_by_recursive_descent()`.
+ */
+#pragma once
+
+#include "dep0/parser/ast.hpp"
+
+#include "dep0/error.hpp"
+#include "dep0/source.hpp"
+
+namespace dep0::parser {
+
+/**
+ * @brief Parse the given source text with a hand-written lexer and recursive-descent parser.
+ *
+ * The language accepted is the one described by `DepCLexer.g4` and `DepCParser.g4`
+ * and the resulting AST, including the source location of each node, is the same as the one built from ANTLR4.
+ * But this parser builds the AST directly from the stream of tokens, without an intermediate parse tree;
+ * left-recursive expressions are parsed by precedence climbing, using the same precedence that ANTLR4 derives
+ * from the order in which the alternatives of `expr` are listed in the grammar.
+ *
+ * Like ANTLR4, parsing stops at the first error.
+ */
+expected<module_t> parse_by_recursive_descent(source_text) noexcept;
+
+} // namespace dep0::parser
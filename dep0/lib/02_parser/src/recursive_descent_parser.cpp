@@ -0,0 +1,1088 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "private/recursive_descent_parser.hpp"
+
+#include "private/parse_cpp_int.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <initializer_list>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dep0::parser {
+
+namespace {
+
+/** The tokens defined in `DepCLexer.g4`, except those sent to the hidden channel. */
+enum class token_kind_t
+{
+    eof,
+    id,
+    attr,
+    integer,
+    string,
+    // keywords
+    kw_and,
+    kw_array,
+    kw_auto,
+    kw_axiom,
+    kw_because,
+    kw_bool_t,
+    kw_cstr_t,
+    kw_else,
+    kw_extern,
+    kw_false,
+    kw_func,
+    kw_i16_t,
+    kw_i32_t,
+    kw_i64_t,
+    kw_i8_t,
+    kw_if,
+    kw_impossible,
+    kw_mutable,
+    kw_not,
+    kw_or,
+    kw_ref_t,
+    kw_return,
+    kw_scopeof,
+    kw_scope_t,
+    kw_struct,
+    kw_true,
+    kw_true_t,
+    kw_typedef,
+    kw_typename,
+    kw_u16_t,
+    kw_u32_t,
+    kw_u64_t,
+    kw_u8_t,
+    kw_unit_t,
+    // punctuation
+    ampersand,
+    arrow,
+    comma,
+    dot,
+    double_colon,
+    ellipsis,
+    eq,
+    eq2,
+    gt,
+    gte,
+    lbrack,
+    lbrack2,
+    lcurly,
+    lparen,
+    lt,
+    lte,
+    minus,
+    neq,
+    plus,
+    rbrack,
+    rbrack2,
+    rcurly,
+    rparen,
+    semi,
+    slash,
+    star
+};
+
+/** Keywords sorted by their text, so that they can be found by binary search. */
+constexpr std::array<std::pair<std::string_view, token_kind_t>, 34ul> keywords{{
+    {"and", token_kind_t::kw_and},
+    {"array_t", token_kind_t::kw_array},
+    {"auto", token_kind_t::kw_auto},
+    {"axiom", token_kind_t::kw_axiom},
+    {"because", token_kind_t::kw_because},
+    {"bool_t", token_kind_t::kw_bool_t},
+    {"cstr_t", token_kind_t::kw_cstr_t},
+    {"else", token_kind_t::kw_else},
+    {"extern", token_kind_t::kw_extern},
+    {"false", token_kind_t::kw_false},
+    {"func", token_kind_t::kw_func},
+    {"i16_t", token_kind_t::kw_i16_t},
+    {"i32_t", token_kind_t::kw_i32_t},
+    {"i64_t", token_kind_t::kw_i64_t},
+    {"i8_t", token_kind_t::kw_i8_t},
+    {"if", token_kind_t::kw_if},
+    {"impossible", token_kind_t::kw_impossible},
+    {"mutable", token_kind_t::kw_mutable},
+    {"not", token_kind_t::kw_not},
+    {"or", token_kind_t::kw_or},
+    {"ref_t", token_kind_t::kw_ref_t},
+    {"return", token_kind_t::kw_return},
+    {"scope_t", token_kind_t::kw_scope_t},
+    {"scopeof", token_kind_t::kw_scopeof},
+    {"struct", token_kind_t::kw_struct},
+    {"true", token_kind_t::kw_true},
+    {"true_t", token_kind_t::kw_true_t},
+    {"typedef", token_kind_t::kw_typedef},
+    {"typename", token_kind_t::kw_typename},
+    {"u16_t", token_kind_t::kw_u16_t},
+    {"u32_t", token_kind_t::kw_u32_t},
+    {"u64_t", token_kind_t::kw_u64_t},
+    {"u8_t", token_kind_t::kw_u8_t},
+    {"unit_t", token_kind_t::kw_unit_t},
+}};
+static_assert(std::ranges::is_sorted(keywords, {}, &std::pair<std::string_view, token_kind_t>::first));
+
+struct token_t
+{
+    token_kind_t kind;
+    std::size_t begin; /**< Offset of the first character inside the source text. */
+    std::size_t end; /**< Offset one past the last character; for `eof` this is the same as `begin`. */
+    std::size_t line;
+    std::size_t col; /**< Starting from 1, like `source_loc_t`. */
+};
+
+bool is_alpha(char const c)
+{
+    return (c >= 'A' and c <= 'Z') or (c >= 'a' and c <= 'z') or c == '_';
+}
+
+bool is_digit(char const c)
+{
+    return c >= '0' and c <= '9';
+}
+
+bool is_alphanum(char const c)
+{
+    return is_alpha(c) or is_digit(c);
+}
+
+bool is_space(char const c)
+{
+    return c == ' ' or c == '\n' or c == '\t' or c == '\r' or c == '\f';
+}
+
+/**
+ * Splits the source text into tokens, following the same rules as `DepCLexer.g4`:
+ * the longest match wins and, between a keyword and an identifier of the same length, the keyword wins.
+ * Whitespaces and comments are discarded.
+ */
+class lexer_t
+{
+    source_text const m_src;
+    std::string_view const m_text;
+    std::size_t m_pos = 0ul;
+    std::size_t m_line = 1ul;
+    std::size_t m_col = 1ul;
+    std::vector<token_t> m_tokens;
+
+public:
+    explicit lexer_t(source_text const src) :
+        m_src(src),
+        m_text(src.view())
+    { }
+
+    /** @throws `error_t` if some character sequence does not form a valid token. */
+    std::vector<token_t> tokenize() &&
+    {
+        m_tokens.reserve(m_text.size() / 4ul);
+        while (m_pos < m_text.size())
+        {
+            auto const c = m_text[m_pos];
+            if (is_space(c))
+                advance(1ul);
+            else if (c == '/' and peek(1ul) == '*')
+                skip_block_comment();
+            else if (c == '/' and peek(1ul) == '/' and skip_line_comment())
+                continue;
+            else if (is_alpha(c))
+                lex_identifier_or_keyword();
+            else if (is_digit(c))
+            {
+                auto n = 1ul;
+                while (is_digit(peek(n)) or peek(n) == '\'')
+                    ++n;
+                push(token_kind_t::integer, n);
+            }
+            else if (c == '"')
+                lex_string();
+            else
+                lex_punctuation(c);
+        }
+        m_tokens.push_back(token_t{token_kind_t::eof, m_pos, m_pos, m_line, m_col});
+        return std::move(m_tokens);
+    }
+
+private:
+    char peek(std::size_t const ahead) const
+    {
+        return m_pos + ahead < m_text.size() ? m_text[m_pos + ahead] : '\0';
+    }
+
+    void advance(std::size_t const n)
+    {
+        for (auto const c: m_text.substr(m_pos, n))
+            if (c == '\n')
+            {
+                ++m_line;
+                m_col = 1ul;
+            }
+            else if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) // columns count code points, not bytes
+                ++m_col;
+        m_pos += n;
+    }
+
+    void push(token_kind_t const kind, std::size_t const n)
+    {
+        m_tokens.push_back(token_t{kind, m_pos, m_pos + n, m_line, m_col});
+        advance(n);
+    }
+
+    [[noreturn]] void unrecognized() const
+    {
+        throw error_t(
+            "token recognition error at: '" + std::string(1ul, m_text[m_pos]) + '\'',
+            source_loc_t(m_line, m_col, m_src.substr(0ul, 0ul)));
+    }
+
+    void skip_block_comment()
+    {
+        // block comments can be nested and, like in ANTLR4, an unterminated one extends to the end of the file
+        advance(2ul);
+        for (auto depth = 1ul; depth > 0ul and m_pos < m_text.size();)
+            if (m_text[m_pos] == '*' and peek(1ul) == '/')
+            {
+                --depth;
+                advance(2ul);
+            }
+            else if (m_text[m_pos] == '/' and peek(1ul) == '*')
+            {
+                ++depth;
+                advance(2ul);
+            }
+            else
+                advance(1ul);
+    }
+
+    /** @return False if the line comment is not terminated by a new line, in which case it is not a comment. */
+    bool skip_line_comment()
+    {
+        auto const new_line = m_text.find('\n', m_pos + 2ul);
+        if (new_line == std::string_view::npos)
+            return false;
+        advance(new_line + 1ul - m_pos);
+        return true;
+    }
+
+    void lex_identifier_or_keyword()
+    {
+        auto n = 1ul;
+        while (is_alphanum(peek(n)))
+            ++n;
+        auto const text = m_text.substr(m_pos, n);
+        auto const it = std::ranges::lower_bound(keywords, text, {}, &std::pair<std::string_view, token_kind_t>::first);
+        push(it != keywords.end() and it->first == text ? it->second : token_kind_t::id, n);
+    }
+
+    void lex_string()
+    {
+        // Simulate `'"' (' ' | '!' | '\\' '"' | [#-~])* '"'` and keep the longest match;
+        // a backslash can either be an ordinary character or the start of an escaped quote,
+        // so we must keep track of both possibilities at the same time.
+        bool in_string = true;
+        bool after_backslash = false;
+        std::optional<std::size_t> longest;
+        for (auto n = 1ul; (in_string or after_backslash) and m_pos + n < m_text.size(); ++n)
+        {
+            auto const c = m_text[m_pos + n];
+            bool const next_in_string = (in_string and c != '"' and (c == ' ' or c == '!' or (c >= '#' and c <= '~')))
+                or (after_backslash and c == '"');
+            after_backslash = in_string and c == '\\';
+            if (in_string and c == '"')
+                longest = n + 1ul;
+            in_string = next_in_string;
+        }
+        if (not longest)
+            unrecognized();
+        push(token_kind_t::string, *longest);
+    }
+
+    /** Lex the content of `[[ ... ]]`, which only contains attributes and does not allow whitespaces or comments. */
+    void lex_attribute()
+    {
+        while (m_pos < m_text.size())
+            if (m_text[m_pos] == ']' and peek(1ul) == ']')
+                return push(token_kind_t::rbrack2, 2ul);
+            else if (is_alpha(m_text[m_pos]))
+            {
+                auto n = 1ul;
+                while (is_alphanum(peek(n)))
+                    ++n;
+                push(token_kind_t::attr, n);
+            }
+            else
+                unrecognized();
+    }
+
+    void lex_punctuation(char const c)
+    {
+        auto const one_or_two = [&] (char const second, token_kind_t const two, token_kind_t const one)
+        {
+            peek(1ul) == second ? push(two, 2ul) : push(one, 1ul);
+        };
+        switch (c)
+        {
+        case '&': return push(token_kind_t::ampersand, 1ul);
+        case ',': return push(token_kind_t::comma, 1ul);
+        case '{': return push(token_kind_t::lcurly, 1ul);
+        case '}': return push(token_kind_t::rcurly, 1ul);
+        case '(': return push(token_kind_t::lparen, 1ul);
+        case ')': return push(token_kind_t::rparen, 1ul);
+        case ']': return push(token_kind_t::rbrack, 1ul);
+        case '+': return push(token_kind_t::plus, 1ul);
+        case ';': return push(token_kind_t::semi, 1ul);
+        case '/': return push(token_kind_t::slash, 1ul);
+        case '*': return push(token_kind_t::star, 1ul);
+        case '-': return one_or_two('>', token_kind_t::arrow, token_kind_t::minus);
+        case '=': return one_or_two('=', token_kind_t::eq2, token_kind_t::eq);
+        case '>': return one_or_two('=', token_kind_t::gte, token_kind_t::gt);
+        case '<': return one_or_two('=', token_kind_t::lte, token_kind_t::lt);
+        case '.':
+            return peek(1ul) == '.' and peek(2ul) == '.'
+                ? push(token_kind_t::ellipsis, 3ul)
+                : push(token_kind_t::dot, 1ul);
+        case ':':
+            if (peek(1ul) != ':')
+                unrecognized();
+            return push(token_kind_t::double_colon, 2ul);
+        case '!':
+            if (peek(1ul) != '=')
+                unrecognized();
+            return push(token_kind_t::neq, 2ul);
+        case '[':
+            if (peek(1ul) != '[')
+                return push(token_kind_t::lbrack, 1ul);
+            push(token_kind_t::lbrack2, 2ul);
+            return lex_attribute();
+        default:
+            unrecognized();
+        }
+    }
+};
+
+/**
+ * Precedence of the left-recursive alternatives of `expr`, as derived by ANTLR4 from their order in the grammar:
+ * the first alternative has the highest precedence, i.e. it binds tighter.
+ * Binary operators are left-associative, so their right-hand side is parsed with one level higher;
+ * instead, the operand of prefix operators is parsed with the same level as the operator itself.
+ */
+namespace precedence {
+constexpr int func_call = 23;
+constexpr int member = 21;
+constexpr int subscript = 20;
+constexpr int address_of = 19;
+constexpr int deref = 18;
+constexpr int because = 17;
+constexpr int not_ = 16;
+constexpr int mult_or_div = 15;
+constexpr int plus_or_minus = 14;
+constexpr int relation = 13;
+constexpr int equality = 12;
+constexpr int and_ = 11;
+constexpr int or_ = 10;
+} // namespace precedence
+
+std::optional<int> binary_precedence(token_kind_t const kind)
+{
+    switch (kind)
+    {
+    case token_kind_t::kw_because: return precedence::because;
+    case token_kind_t::star:
+    case token_kind_t::slash: return precedence::mult_or_div;
+    case token_kind_t::plus:
+    case token_kind_t::minus: return precedence::plus_or_minus;
+    case token_kind_t::lt:
+    case token_kind_t::lte:
+    case token_kind_t::gt:
+    case token_kind_t::gte: return precedence::relation;
+    case token_kind_t::eq2:
+    case token_kind_t::neq: return precedence::equality;
+    case token_kind_t::kw_and: return precedence::and_;
+    case token_kind_t::kw_or: return precedence::or_;
+    default: return std::nullopt;
+    }
+}
+
+bool can_start_expr(token_kind_t const kind)
+{
+    switch (kind)
+    {
+    case token_kind_t::kw_scopeof:
+    case token_kind_t::ampersand:
+    case token_kind_t::star:
+    case token_kind_t::kw_not:
+    case token_kind_t::string:
+    case token_kind_t::plus:
+    case token_kind_t::minus:
+    case token_kind_t::integer:
+    case token_kind_t::kw_true:
+    case token_kind_t::kw_false:
+    case token_kind_t::kw_array:
+    case token_kind_t::kw_auto:
+    case token_kind_t::kw_ref_t:
+    case token_kind_t::kw_scope_t:
+    case token_kind_t::kw_true_t:
+    case token_kind_t::double_colon:
+    case token_kind_t::id:
+    case token_kind_t::kw_bool_t:
+    case token_kind_t::kw_cstr_t:
+    case token_kind_t::kw_unit_t:
+    case token_kind_t::kw_i8_t:
+    case token_kind_t::kw_i16_t:
+    case token_kind_t::kw_i32_t:
+    case token_kind_t::kw_i64_t:
+    case token_kind_t::kw_u8_t:
+    case token_kind_t::kw_u16_t:
+    case token_kind_t::kw_u32_t:
+    case token_kind_t::kw_u64_t:
+    case token_kind_t::lparen:
+    case token_kind_t::lcurly:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Builds the AST from the tokens produced by `lexer_t`, one function per rule of `DepCParser.g4`.
+ *
+ * The source location of each node is computed exactly like `get_loc()` does for a parser rule context in ANTLR4,
+ * i.e. it starts from the first token of the rule and extends to its last token;
+ * for example, the location of a sub-expression `(x)` does not include the parenthesis
+ * but the location of `(x) + 1` does.
+ */
+class parser_t
+{
+    struct bracket_t
+    {
+        std::size_t match = npos; /**< Index of the matching bracket, if any. */
+        bool has_comma = false; /**< For `(`, whether a comma appears directly inside the pair of parenthesis. */
+    };
+
+    static constexpr auto npos = std::string_view::npos;
+
+    source_text const m_src;
+    std::vector<token_t> const m_tokens;
+    std::vector<bracket_t> m_brackets;
+    std::size_t m_pos = 0ul;
+    std::size_t m_end; /**< Tokens from here onwards are hidden and look like `eof`, see `parse_func_call_stmt()`. */
+
+public:
+    parser_t(source_text const src, std::vector<token_t> tokens) :
+        m_src(src),
+        m_tokens(std::move(tokens)),
+        m_brackets(m_tokens.size()),
+        m_end(m_tokens.size() - 1ul)
+    {
+        assert(not m_tokens.empty() and m_tokens.back().kind == token_kind_t::eof);
+        // match all brackets upfront, so that the few decisions that need to look past a pair of parenthesis
+        // can do so in constant time
+        std::vector<std::size_t> open;
+        for (auto const i: std::views::iota(0ul, m_tokens.size()))
+            switch (m_tokens[i].kind)
+            {
+            case token_kind_t::lparen:
+            case token_kind_t::lbrack:
+            case token_kind_t::lcurly:
+                open.push_back(i);
+                break;
+            case token_kind_t::rparen:
+            case token_kind_t::rbrack:
+            case token_kind_t::rcurly:
+                if (not open.empty() and is_matching(m_tokens[open.back()].kind, m_tokens[i].kind))
+                {
+                    m_brackets[open.back()].match = i;
+                    m_brackets[i].match = open.back();
+                    open.pop_back();
+                }
+                break;
+            case token_kind_t::comma:
+                if (not open.empty() and m_tokens[open.back()].kind == token_kind_t::lparen)
+                    m_brackets[open.back()].has_comma = true;
+                break;
+            default:
+                break;
+            }
+    }
+
+    module_t parse_module()
+    {
+        std::vector<module_t::entry_t> entries;
+        while (peek().kind != token_kind_t::eof)
+            entries.push_back(parse_module_entry());
+        return module_t{loc(0ul, m_tokens.size() - 1ul), std::move(entries)};
+    }
+
+private:
+    static bool is_matching(token_kind_t const open, token_kind_t const close)
+    {
+        return (open == token_kind_t::lparen and close == token_kind_t::rparen)
+            or (open == token_kind_t::lbrack and close == token_kind_t::rbrack)
+            or (open == token_kind_t::lcurly and close == token_kind_t::rcurly);
+    }
+
+    token_t const& peek(std::size_t const ahead = 0ul) const
+    {
+        return m_pos + ahead < m_end ? m_tokens[m_pos + ahead] : m_tokens.back();
+    }
+
+    bool accept(token_kind_t const kind)
+    {
+        if (peek().kind != kind)
+            return false;
+        ++m_pos;
+        return true;
+    }
+
+    /** @return The index of the expected token. */
+    std::size_t expect(token_kind_t const kind, std::string_view const expected)
+    {
+        if (peek().kind != kind)
+            mismatched(expected);
+        return m_pos++;
+    }
+
+    /** Like a semantic predicate `{one_of(...)}?` in the grammar, followed by the expected token. */
+    std::size_t expect_one_of(token_kind_t const kind, std::initializer_list<std::string_view> const patterns)
+    {
+        auto const& token = m_tokens[m_pos];
+        if (peek().kind != kind or std::ranges::find(patterns, text(token).view()) == patterns.end())
+        {
+            std::string err = "mismatched input `" + display(token) + "` expecting ";
+            bool first = true;
+            for (auto const& x: patterns)
+                (std::exchange(first, false) ? err : err += ", ") += '`' + std::string(x) + '`';
+            throw error_t(std::move(err), loc(token));
+        }
+        return m_pos++;
+    }
+
+    [[noreturn]] void mismatched(std::string_view const expected) const
+    {
+        auto const& token = m_tokens[m_pos];
+        throw error_t("mismatched input '" + display(token) + "' expecting " + std::string(expected), loc(token));
+    }
+
+    std::string display(token_t const& token) const
+    {
+        return token.kind == token_kind_t::eof ? "<EOF>" : std::string(text(token).view());
+    }
+
+    source_text text(token_t const& token) const
+    {
+        return m_src.substr(token.begin, token.end - token.begin);
+    }
+
+    source_text text_of(std::size_t const i) const
+    {
+        return text(m_tokens[i]);
+    }
+
+    source_loc_t loc(token_t const& token) const
+    {
+        return source_loc_t(token.line, token.col, text(token));
+    }
+
+    source_loc_t loc(std::size_t const first, std::size_t const last) const
+    {
+        auto const& a = m_tokens[first];
+        return source_loc_t(a.line, a.col, m_src.substr(a.begin, m_tokens[last].end - a.begin));
+    }
+
+    /** Location from the given token up to the last token consumed. */
+    source_loc_t loc_from(std::size_t const first) const
+    {
+        assert(first < m_pos);
+        return loc(first, m_pos - 1ul);
+    }
+
+    module_t::entry_t parse_module_entry()
+    {
+        switch (peek().kind)
+        {
+        case token_kind_t::kw_typedef: return parse_integer_def();
+        case token_kind_t::kw_struct: return parse_struct_def();
+        case token_kind_t::kw_axiom: return parse_axiom();
+        case token_kind_t::kw_extern: return parse_extern_decl();
+        case token_kind_t::kw_func: return parse_func_decl_or_def();
+        default: mismatched("{'axiom', 'extern', 'func', 'struct', 'typedef'}");
+        }
+    }
+
+    type_def_t parse_integer_def()
+    {
+        auto const first = expect(token_kind_t::kw_typedef, "'typedef'");
+        auto const name = text_of(expect(token_kind_t::id, "ID"));
+        expect(token_kind_t::eq, "'='");
+        auto const sign = text_of(expect_one_of(token_kind_t::id, {"signed", "unsigned"}));
+        auto const width = text_of(expect_one_of(token_kind_t::integer, {"8", "16", "32", "64"}));
+        expect_one_of(token_kind_t::id, {"bit"});
+        expect_one_of(token_kind_t::id, {"integer"});
+        auto const last = expect(token_kind_t::semi, "';'");
+        auto const s = sign == "unsigned" ? ast::sign_t::unsigned_v : ast::sign_t::signed_v;
+        auto const w =
+            width == "8" ? ast::width_t::_8 :
+            width == "16" ? ast::width_t::_16 :
+            width == "32" ? ast::width_t::_32 :
+            ast::width_t::_64;
+        return type_def_t{loc(first, last), type_def_t::integer_t{name, s, w}};
+    }
+
+    type_def_t parse_struct_def()
+    {
+        auto const first = expect(token_kind_t::kw_struct, "'struct'");
+        auto const name = text_of(expect(token_kind_t::id, "ID"));
+        expect(token_kind_t::lcurly, "'{'");
+        std::vector<type_def_t::struct_t::field_t> fields;
+        while (peek().kind != token_kind_t::rcurly)
+        {
+            auto type = parse_expr();
+            auto const field_name = text_of(expect(token_kind_t::id, "ID"));
+            expect(token_kind_t::semi, "';'");
+            fields.push_back(type_def_t::struct_t::field_t{std::move(type), expr_t::var_t{field_name}});
+        }
+        expect(token_kind_t::rcurly, "'}'");
+        auto const last = expect(token_kind_t::semi, "';'");
+        return type_def_t{loc(first, last), type_def_t::struct_t{name, std::move(fields)}};
+    }
+
+    axiom_t parse_axiom()
+    {
+        auto const first = expect(token_kind_t::kw_axiom, "'axiom'");
+        auto const name = text_of(expect(token_kind_t::id, "ID"));
+        auto func_type = parse_func_type();
+        auto const last = expect(token_kind_t::semi, "';'");
+        auto const loc = this->loc(first, last);
+        auto& pi = std::get<expr_t::pi_t>(func_type.value);
+        if (pi.is_mutable == ast::is_mutable_t::yes)
+            throw error_t("axioms cannot be mutable", loc);
+        return axiom_t{loc, name, std::move(pi)};
+    }
+
+    extern_decl_t parse_extern_decl()
+    {
+        auto const first = expect(token_kind_t::kw_extern, "'extern'");
+        auto const name = text_of(expect(token_kind_t::id, "ID"));
+        auto func_type = parse_func_type();
+        auto const last = expect(token_kind_t::semi, "';'");
+        // extern functions are always mutable, even if not expicitly marked so
+        auto& pi = std::get<expr_t::pi_t>(func_type.value);
+        pi.is_mutable = ast::is_mutable_t::yes;
+        return extern_decl_t{loc(first, last), name, std::move(pi)};
+    }
+
+    module_t::entry_t parse_func_decl_or_def()
+    {
+        auto const first = expect(token_kind_t::kw_func, "'func'");
+        std::optional<ast::attribute_t> attribute;
+        if (accept(token_kind_t::lbrack2))
+        {
+            attribute.emplace(ast::attribute_t{text_of(expect(token_kind_t::attr, "ATTR"))});
+            expect(token_kind_t::rbrack2, "']]'");
+        }
+        auto const name = text_of(expect(token_kind_t::id, "ID"));
+        auto func_type = parse_func_type();
+        auto& pi = std::get<expr_t::pi_t>(func_type.value);
+        if (accept(token_kind_t::semi))
+            return func_decl_t{loc_from(first), name, std::move(attribute), std::move(pi)};
+        if (peek().kind != token_kind_t::lcurly)
+            mismatched("{';', '{'}");
+        auto body = parse_body();
+        return func_def_t{
+            loc_from(first),
+            name,
+            std::move(attribute),
+            expr_t::abs_t{pi.is_mutable, std::move(pi.args), std::move(pi.ret_type), std::move(body)}};
+    }
+
+    expr_t parse_typename_or_expr()
+    {
+        if (peek().kind == token_kind_t::kw_typename)
+            return expr_t{loc(m_tokens[m_pos++]), expr_t::typename_t{}};
+        return parse_expr();
+    }
+
+    func_arg_t parse_func_arg()
+    {
+        auto const first = m_pos;
+        auto qty = ast::qty_t::many;
+        // an integer is a quantity only if something else follows that can be the type of the argument,
+        // otherwise it is the type itself, for example in `(i32_t x, 0) -> ...`
+        if (peek().kind == token_kind_t::integer
+            and (peek(1ul).kind == token_kind_t::kw_typename or can_start_expr(peek(1ul).kind)))
+            qty = text_of(expect_one_of(token_kind_t::integer, {"0", "1"})) == "0" ? ast::qty_t::zero : ast::qty_t::one;
+        auto type = parse_typename_or_expr();
+        std::optional<expr_t::var_t> var;
+        if (peek().kind == token_kind_t::id)
+            var.emplace(text_of(m_pos++));
+        return func_arg_t{loc_from(first), qty, std::move(type), std::move(var)};
+    }
+
+    expr_t parse_func_type()
+    {
+        auto const first = expect(token_kind_t::lparen, "'('");
+        std::vector<func_arg_t> args;
+        if (peek().kind != token_kind_t::rparen)
+            do
+                args.push_back(parse_func_arg());
+            while (accept(token_kind_t::comma));
+        expect(token_kind_t::rparen, "')'");
+        auto const is_mutable = accept(token_kind_t::kw_mutable) ? ast::is_mutable_t::yes : ast::is_mutable_t::no;
+        expect(token_kind_t::arrow, "'->'");
+        auto ret_type = parse_typename_or_expr();
+        return expr_t{loc_from(first), expr_t::pi_t{is_mutable, std::move(args), std::move(ret_type)}};
+    }
+
+    expr_t parse_tuple_type()
+    {
+        auto const first = expect(token_kind_t::lparen, "'('");
+        std::vector<func_arg_t> args;
+        if (peek().kind != token_kind_t::rparen)
+        {
+            // either `(x,)` or `(x, y, ...)` but not `(x, y,)`
+            args.push_back(parse_func_arg());
+            expect(token_kind_t::comma, "','");
+            if (peek().kind != token_kind_t::rparen)
+                do
+                    args.push_back(parse_func_arg());
+                while (accept(token_kind_t::comma));
+        }
+        expect(token_kind_t::rparen, "')'");
+        return expr_t{loc_from(first), expr_t::sigma_t{std::move(args)}};
+    }
+
+    body_t parse_body()
+    {
+        auto const first = expect(token_kind_t::lcurly, "'{'");
+        std::vector<stmt_t> stmts;
+        while (peek().kind != token_kind_t::rcurly and peek().kind != token_kind_t::eof)
+            stmts.push_back(parse_stmt());
+        auto const last = expect(token_kind_t::rcurly, "'}'");
+        return body_t{loc(first, last), std::move(stmts)};
+    }
+
+    body_t parse_body_or_stmt()
+    {
+        if (peek().kind == token_kind_t::lcurly)
+            return parse_body();
+        auto const first = m_pos;
+        std::vector<stmt_t> stmts;
+        stmts.push_back(parse_stmt());
+        return body_t{loc_from(first), std::move(stmts)};
+    }
+
+    stmt_t parse_stmt()
+    {
+        switch (peek().kind)
+        {
+        case token_kind_t::kw_if:
+            return parse_if_else();
+        case token_kind_t::kw_return:
+        {
+            // for `return expr;` capture the whole statement otherwise just the `return` bit, no semicolon
+            auto const first = m_pos++;
+            if (accept(token_kind_t::semi))
+                return stmt_t{loc(m_tokens[first]), stmt_t::return_t{std::nullopt}};
+            auto expr = parse_expr();
+            expect(token_kind_t::semi, "';'");
+            return stmt_t{loc_from(first), stmt_t::return_t{std::move(expr)}};
+        }
+        case token_kind_t::kw_impossible:
+        {
+            // for `impossible because expr` capture the whole statement otherwise just the `impossible` bit
+            auto const first = m_pos++;
+            if (accept(token_kind_t::semi))
+                return stmt_t{loc(m_tokens[first]), stmt_t::impossible_t{std::nullopt}};
+            expect(token_kind_t::kw_because, "{';', 'because'}");
+            auto reason = parse_expr();
+            expect(token_kind_t::semi, "';'");
+            return stmt_t{loc_from(first), stmt_t::impossible_t{std::move(reason)}};
+        }
+        default:
+            return parse_func_call_stmt();
+        }
+    }
+
+    stmt_t parse_if_else()
+    {
+        auto const first = expect(token_kind_t::kw_if, "'if'");
+        expect(token_kind_t::lparen, "'('");
+        auto cond = parse_expr();
+        expect(token_kind_t::rparen, "')'");
+        auto true_branch = parse_body_or_stmt();
+        std::optional<body_t> false_branch;
+        if (accept(token_kind_t::kw_else))
+            false_branch.emplace(parse_body_or_stmt());
+        return stmt_t{
+            loc_from(first),
+            stmt_t::if_else_t{std::move(cond), std::move(true_branch), std::move(false_branch)}};
+    }
+
+    stmt_t parse_func_call_stmt()
+    {
+        // In `func=expr '(' args ')' ';'` the expression `func` could itself end with a function call,
+        // for example in `f(x)(y);`, so the arguments of the statement are those inside the last pair of parenthesis
+        // before the semicolon, and everything before them is the function; semicolons never appear in expressions.
+        auto const first = m_pos;
+        auto semi = first;
+        while (m_tokens[semi].kind != token_kind_t::semi and m_tokens[semi].kind != token_kind_t::eof)
+            ++semi;
+        auto const open =
+            semi > first and m_tokens[semi - 1ul].kind == token_kind_t::rparen
+                ? m_brackets[semi - 1ul].match
+                : npos;
+        if (open == npos or open <= first)
+        {
+            m_pos = semi;
+            mismatched("'('");
+        }
+        auto const end = std::exchange(m_end, open);
+        auto func = parse_expr();
+        m_end = end;
+        if (m_pos != open)
+            mismatched("'('");
+        auto args = parse_exprs(token_kind_t::lparen, "'('", token_kind_t::rparen, "')'");
+        expect(token_kind_t::semi, "';'");
+        return stmt_t{loc_from(first), expr_t::app_t{std::move(func), std::move(args)}};
+    }
+
+    /** Parse a possibly empty, comma-separated list of expressions between the given pair of brackets. */
+    std::vector<expr_t> parse_exprs(
+        token_kind_t const open, std::string_view const open_text,
+        token_kind_t const close, std::string_view const close_text)
+    {
+        expect(open, open_text);
+        std::vector<expr_t> exprs;
+        if (peek().kind != close)
+            do
+                exprs.push_back(parse_expr());
+            while (accept(token_kind_t::comma));
+        expect(close, close_text);
+        return exprs;
+    }
+
+    expr_t parse_expr(int const min_precedence = 0)
+    {
+        auto const first = m_pos;
+        auto lhs = parse_primary();
+        while (true)
+        {
+            auto const kind = peek().kind;
+            if (kind == token_kind_t::lparen and precedence::func_call >= min_precedence)
+            {
+                auto args = parse_exprs(token_kind_t::lparen, "'('", token_kind_t::rparen, "')'");
+                lhs = expr_t{loc_from(first), expr_t::app_t{std::move(lhs), std::move(args)}};
+            }
+            else if ((kind == token_kind_t::dot or kind == token_kind_t::arrow) and precedence::member >= min_precedence)
+            {
+                ++m_pos;
+                auto const field = text_of(expect(token_kind_t::id, "ID"));
+                auto const loc = loc_from(first);
+                lhs = expr_t{
+                    loc,
+                    expr_t::member_t{
+                        kind == token_kind_t::arrow ? expr_t{loc, expr_t::deref_t{std::move(lhs)}} : std::move(lhs),
+                        field}};
+            }
+            else if (kind == token_kind_t::lbrack and precedence::subscript >= min_precedence)
+            {
+                ++m_pos;
+                auto index = parse_expr();
+                expect(token_kind_t::rbrack, "']'");
+                lhs = expr_t{loc_from(first), expr_t::subscript_t{std::move(lhs), std::move(index)}};
+            }
+            else if (auto const p = binary_precedence(kind); p and *p >= min_precedence)
+            {
+                ++m_pos;
+                auto rhs = parse_expr(*p + 1);
+                lhs = make_binary_expr(kind, loc_from(first), std::move(lhs), std::move(rhs));
+            }
+            else
+                return lhs;
+        }
+    }
+
+    static expr_t make_binary_expr(token_kind_t const kind, source_loc_t const loc, expr_t lhs, expr_t rhs)
+    {
+        using boolean_expr_t = expr_t::boolean_expr_t;
+        using relation_expr_t = expr_t::relation_expr_t;
+        using arith_expr_t = expr_t::arith_expr_t;
+        switch (kind)
+        {
+        case token_kind_t::kw_because:
+            return expr_t{loc, expr_t::because_t{std::move(lhs), std::move(rhs)}};
+        case token_kind_t::star:
+            return expr_t{loc, arith_expr_t{arith_expr_t::mult_t{std::move(lhs), std::move(rhs)}}};
+        case token_kind_t::slash:
+            return expr_t{loc, arith_expr_t{arith_expr_t::div_t{std::move(lhs), std::move(rhs)}}};
+        case token_kind_t::plus:
+            return expr_t{loc, arith_expr_t{arith_expr_t::plus_t{std::move(lhs), std::move(rhs)}}};
+        case token_kind_t::minus:
+            return expr_t{loc, arith_expr_t{arith_expr_t::minus_t{std::move(lhs), std::move(rhs)}}};
+        case token_kind_t::lt:
+            return expr_t{loc, relation_expr_t{relation_expr_t::lt_t{std::move(lhs), std::move(rhs)}}};
+        case token_kind_t::lte:
+            return expr_t{loc, relation_expr_t{relation_expr_t::lte_t{std::move(lhs), std::move(rhs)}}};
+        case token_kind_t::gt:
+            return expr_t{loc, relation_expr_t{relation_expr_t::gt_t{std::move(lhs), std::move(rhs)}}};
+        case token_kind_t::gte:
+            return expr_t{loc, relation_expr_t{relation_expr_t::gte_t{std::move(lhs), std::move(rhs)}}};
+        case token_kind_t::eq2:
+            return expr_t{loc, relation_expr_t{relation_expr_t::eq_t{std::move(lhs), std::move(rhs)}}};
+        case token_kind_t::neq:
+            return expr_t{loc, relation_expr_t{relation_expr_t::neq_t{std::move(lhs), std::move(rhs)}}};
+        case token_kind_t::kw_and:
+            return expr_t{loc, boolean_expr_t{boolean_expr_t::and_t{std::move(lhs), std::move(rhs)}}};
+        case token_kind_t::kw_or:
+            return expr_t{loc, boolean_expr_t{boolean_expr_t::or_t{std::move(lhs), std::move(rhs)}}};
+        default:
+            assert(false and "not a binary operator");
+            throw error_t("unexpected binary operator", loc);
+        }
+    }
+
+    expr_t parse_primary()
+    {
+        auto const first = m_pos;
+        auto const kind = peek().kind;
+        auto const single_token = [&] (auto value)
+        {
+            ++m_pos;
+            return expr_t{loc(m_tokens[first]), std::move(value)};
+        };
+        auto const prefix = [&] <typename T> (int const operand_precedence)
+        {
+            ++m_pos;
+            auto expr = parse_expr(operand_precedence);
+            return expr_t{loc_from(first), T{std::move(expr)}};
+        };
+        switch (kind)
+        {
+        case token_kind_t::kw_scopeof:
+        {
+            ++m_pos;
+            expect(token_kind_t::lparen, "'('");
+            auto expr = parse_expr();
+            expect(token_kind_t::rparen, "')'");
+            return expr_t{loc_from(first), expr_t::scopeof_t(std::move(expr), 0ul)};
+        }
+        case token_kind_t::ampersand:
+            return prefix.template operator()<expr_t::addressof_t>(precedence::address_of);
+        case token_kind_t::star:
+            return prefix.template operator()<expr_t::deref_t>(precedence::deref);
+        case token_kind_t::kw_not:
+        {
+            ++m_pos;
+            auto expr = parse_expr(precedence::not_);
+            return expr_t{loc_from(first), expr_t::boolean_expr_t{expr_t::boolean_expr_t::not_t{std::move(expr)}}};
+        }
+        case token_kind_t::string:
+        {
+            auto const s = text_of(first);
+            assert(s.size() >= 2 and "literal string must contain enclosing quotes");
+            return single_token(expr_t::string_literal_t{s.substr(1, s.size()-2)});
+        }
+        case token_kind_t::plus:
+        case token_kind_t::minus:
+        case token_kind_t::integer:
+        {
+            bool const negative = kind == token_kind_t::minus;
+            if (kind != token_kind_t::integer)
+                ++m_pos;
+            auto const value = text_of(expect(token_kind_t::integer, "INT"));
+            return expr_t{
+                loc_from(first),
+                expr_t::numeric_constant_t{negative ? -parse_cpp_int(value.view()) : parse_cpp_int(value.view())}};
+        }
+        case token_kind_t::kw_true: return single_token(expr_t::boolean_constant_t{true});
+        case token_kind_t::kw_false: return single_token(expr_t::boolean_constant_t{false});
+        case token_kind_t::kw_array: return single_token(expr_t::array_t{});
+        case token_kind_t::kw_auto: return single_token(expr_t::auto_t{});
+        case token_kind_t::kw_ref_t: return single_token(expr_t::ref_t{});
+        case token_kind_t::kw_scope_t: return single_token(expr_t::scope_t{});
+        case token_kind_t::kw_true_t: return single_token(expr_t::true_t{});
+        case token_kind_t::double_colon:
+        {
+            ++m_pos;
+            auto const symbol_name = text_of(expect(token_kind_t::id, "ID"));
+            return expr_t{loc_from(first), expr_t::global_t{source_text::from_literal(""), symbol_name}};
+        }
+        case token_kind_t::id:
+            if (peek(1ul).kind == token_kind_t::double_colon)
+            {
+                m_pos += 2ul;
+                auto const symbol_name = text_of(expect(token_kind_t::id, "ID"));
+                return expr_t{loc_from(first), expr_t::global_t{text_of(first), symbol_name}};
+            }
+            return single_token(expr_t::var_t{text_of(first)});
+        case token_kind_t::kw_bool_t: return single_token(expr_t::bool_t{});
+        case token_kind_t::kw_cstr_t: return single_token(expr_t::cstr_t{});
+        case token_kind_t::kw_unit_t: return single_token(expr_t::unit_t{});
+        case token_kind_t::kw_i8_t: return single_token(expr_t::i8_t{});
+        case token_kind_t::kw_i16_t: return single_token(expr_t::i16_t{});
+        case token_kind_t::kw_i32_t: return single_token(expr_t::i32_t{});
+        case token_kind_t::kw_i64_t: return single_token(expr_t::i64_t{});
+        case token_kind_t::kw_u8_t: return single_token(expr_t::u8_t{});
+        case token_kind_t::kw_u16_t: return single_token(expr_t::u16_t{});
+        case token_kind_t::kw_u32_t: return single_token(expr_t::u32_t{});
+        case token_kind_t::kw_u64_t: return single_token(expr_t::u64_t{});
+        case token_kind_t::lparen:
+            return parse_parenthesized();
+        case token_kind_t::lcurly:
+        {
+            auto values = parse_exprs(token_kind_t::lcurly, "'{'", token_kind_t::rcurly, "'}'");
+            return expr_t{loc_from(first), expr_t::init_list_t{std::move(values)}};
+        }
+        default:
+            mismatched("an expression");
+        }
+    }
+
+    /** Parse either a function type, a tuple type or a sub-expression, depending on what follows `)`. */
+    expr_t parse_parenthesized()
+    {
+        // In ANTLR4, `(x) -> ...` is ambiguous between a function type and the member of a sub-expression;
+        // the ambiguity is resolved in favour of the function type, because it comes first in the grammar.
+        if (auto const close = m_brackets[m_pos].match; close != npos and close < m_end)
+        {
+            auto const next = close + 1ul < m_end ? m_tokens[close + 1ul].kind : token_kind_t::eof;
+            if (next == token_kind_t::kw_mutable or next == token_kind_t::arrow)
+                return parse_func_type();
+            if (close == m_pos + 1ul or m_brackets[m_pos].has_comma)
+                return parse_tuple_type();
+        }
+        // parenthesis are not part of the location of a sub-expression
+        ++m_pos;
+        auto expr = parse_expr();
+        expect(token_kind_t::rparen, "')'");
+        return expr;
+    }
+};
+
+} // namespace
+
+expected<module_t> parse_by_recursive_descent(source_text source) noexcept
+{
+    try
+    {
+        parser_t parser(source, lexer_t(source).tokenize());
+        return parser.parse_module();
+    }
+    catch (error_t const& e)
+    {
+        return e;
+    }
+}
+
+} // namespace dep0::parser
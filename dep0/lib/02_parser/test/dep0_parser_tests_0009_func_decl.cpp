@@ -201,6 +201,50 @@ BOOST_AUTO_TEST_CASE(pass_004)
     }
 }
 
+BOOST_AUTO_TEST_CASE(pass_005)
+{
+    BOOST_TEST_REQUIRE(pass("0009_func_decl/pass_005.depc"));
+    BOOST_TEST_REQUIRE(pass_result->entries.size() == 4ul);
+    {
+        auto const f = std::get_if<dep0::parser::func_decl_t>(&pass_result->entries[0ul]);
+        BOOST_TEST_REQUIRE(f);
+        BOOST_TEST(f->name == "t");
+        BOOST_TEST_REQUIRE(f->signature.args.size() == 1ul);
+        BOOST_TEST(is_arg(f->signature.args[0ul], is_bool, std::nullopt));
+        BOOST_TEST(is_typename(f->signature.ret_type.get()));
+    }
+    {
+        auto const f = std::get_if<dep0::parser::func_def_t>(&pass_result->entries[1ul]);
+        BOOST_TEST_REQUIRE(f);
+        BOOST_TEST(f->name == "f");
+        BOOST_TEST_REQUIRE(f->value.args.size() == 1ul);
+        BOOST_TEST(is_arg(f->value.args[0ul], app_of(var("t"), constant(true)), "x"));
+        BOOST_TEST(is_app_of(f->value.ret_type.get(), var("t"), not_of(constant(false))));
+        BOOST_TEST_REQUIRE(f->value.body.stmts.size() == 1ul);
+        BOOST_TEST(is_return_of(f->value.body.stmts[0ul], var("x")));
+    }
+    {
+        auto const f = std::get_if<dep0::parser::func_def_t>(&pass_result->entries[2ul]);
+        BOOST_TEST_REQUIRE(f);
+        BOOST_TEST(f->name == "t");
+        BOOST_TEST_REQUIRE(f->value.args.size() == 1ul);
+        BOOST_TEST(is_arg(f->value.args[0ul], is_bool, std::nullopt));
+        BOOST_TEST(is_typename(f->value.ret_type.get()));
+        BOOST_TEST_REQUIRE(f->value.body.stmts.size() == 1ul);
+        BOOST_TEST(is_return_of(f->value.body.stmts[0ul], is_i32));
+    }
+    {
+        auto const f = std::get_if<dep0::parser::func_def_t>(&pass_result->entries[3ul]);
+        BOOST_TEST_REQUIRE(f);
+        BOOST_TEST(f->name == "g");
+        BOOST_TEST_REQUIRE(f->value.args.size() == 1ul);
+        BOOST_TEST(is_arg(f->value.args[0ul], app_of(var("t"), not_of(constant(false))), "x"));
+        BOOST_TEST(is_i32(f->value.ret_type.get()));
+        BOOST_TEST_REQUIRE(f->value.body.stmts.size() == 1ul);
+        BOOST_TEST(is_return_of(f->value.body.stmts[0ul], var("x")));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(typecheck_error_000)
 {
     BOOST_TEST_REQUIRE(pass("0009_func_decl/typecheck_error_000.depc"));
@@ -237,5 +281,15 @@ BOOST_AUTO_TEST_CASE(typecheck_error_001)
     }
 }
 
+BOOST_AUTO_TEST_CASE(typecheck_error_002)
+{
+    BOOST_TEST_REQUIRE(pass("0009_func_decl/typecheck_error_002.depc"));
+    BOOST_TEST_REQUIRE(pass_result->entries.size() == 4ul);
+    BOOST_TEST(std::holds_alternative<dep0::parser::func_decl_t>(pass_result->entries[0ul]));
+    BOOST_TEST(std::holds_alternative<dep0::parser::func_def_t>(pass_result->entries[1ul]));
+    BOOST_TEST(std::holds_alternative<dep0::parser::func_def_t>(pass_result->entries[2ul]));
+    BOOST_TEST(std::holds_alternative<dep0::parser::func_def_t>(pass_result->entries[3ul]));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -346,5 +346,8 @@ BOOST_AUTO_TEST_CASE(typecheck_error_002)
 }
 
 BOOST_AUTO_TEST_CASE(typecheck_error_003) { BOOST_TEST_REQUIRE(pass("0012_auto_expr/typecheck_error_003.depc")); }
+BOOST_AUTO_TEST_CASE(typecheck_error_004) { BOOST_TEST_REQUIRE(pass("0012_auto_expr/typecheck_error_004.depc")); }
+BOOST_AUTO_TEST_CASE(typecheck_error_005) { BOOST_TEST_REQUIRE(pass("0012_auto_expr/typecheck_error_005.depc")); }
+BOOST_AUTO_TEST_CASE(typecheck_error_006) { BOOST_TEST_REQUIRE(pass("0012_auto_expr/typecheck_error_006.depc")); }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Tests for the hand-written front end, `front_end_t::recursive_descent`, using ANTLR as the reference.
+ * On valid input the two must build the same AST, including source locations.
+ * On invalid input the hand-written parser stops at the first error, whereas ANTLR recovers and carries on;
+ * since only the first error is reported, both must report it at the same place.
+ */
+#define BOOST_TEST_MODULE dep0_parser_tests_recursive_descent
+#include <boost/test/unit_test.hpp>
+
+#include "parser_tests_fixture.hpp"
+
+#include "dep0/parser/parse.hpp"
+
+#include <cstddef>
+#include <sstream>
+
+using namespace dep0::parser;
+
+/** Check that both front ends reject the given source, reporting the first error at the given line and column. */
+static boost::test_tools::predicate_result
+same_first_error(char const* const text, std::size_t const line, std::size_t const col)
+{
+    auto const source = dep0::source_text::from_literal(text);
+    bool ok = true;
+    std::ostringstream message;
+    for (auto const front_end: {front_end_t::antlr, front_end_t::recursive_descent})
+    {
+        auto const name = front_end == front_end_t::antlr ? "antlr" : "recursive-descent";
+        auto const parsed = parse(source, parse_options_t{front_end});
+        if (parsed)
+        {
+            ok = false;
+            message << name << " accepted invalid input; ";
+        }
+        else if (not parsed.error().location)
+        {
+            ok = false;
+            message << name << " reported `" << parsed.error().error << "` without location; ";
+        }
+        else if (parsed.error().location->line != line or parsed.error().location->col != col)
+        {
+            ok = false;
+            message
+                << name << " reported `" << parsed.error().error << "` at " << parsed.error().location->line << ':'
+                << parsed.error().location->col << " instead of " << line << ':' << col << "; ";
+        }
+    }
+    auto result = boost::test_tools::predicate_result(ok);
+    result.message() << message.str();
+    return result;
+}
+
+BOOST_FIXTURE_TEST_SUITE(dep0_parser_tests_recursive_descent, ParserTestsFixture)
+
+BOOST_AUTO_TEST_CASE(all_files)
+{
+    auto const files = all_testfiles();
+    BOOST_TEST_REQUIRE(not files.empty());
+    for (auto const& file: files)
+    {
+        BOOST_TEST_CONTEXT(file)
+        {
+            auto const expected = parse(testfiles / file, parse_options_t{front_end_t::antlr});
+            auto const actual = parse(testfiles / file, parse_options_t{front_end_t::recursive_descent});
+            BOOST_TEST_REQUIRE(expected.has_value() == actual.has_value());
+            if (expected)
+                BOOST_TEST(is_same_module(*expected, *actual));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(missing_token)
+{
+    BOOST_TEST(same_first_error("func f() -> i32_t { return 0 }", 1ul, 30ul));
+}
+
+BOOST_AUTO_TEST_CASE(unexpected_eof)
+{
+    BOOST_TEST(same_first_error("func f() -> i32_t\n{\n    if (true)\n    {\n        return 0;\n    }\n", 7ul, 1ul));
+}
+
+BOOST_AUTO_TEST_CASE(only_first_of_many_errors)
+{
+    // ANTLR recovers from the first error and reports the second one as well, but that is discarded
+    BOOST_TEST(same_first_error("func f() -> i32_t { return 0 }\nfunc g() -> i32_t { return 1 }\n", 1ul, 30ul));
+}
+
+BOOST_AUTO_TEST_CASE(lexer_error_before_parser_error)
+{
+    // all input is tokenized before parsing starts, so a later lexer error wins over an earlier syntax error
+    auto const text = "func f() -> i32_t { return 0 }\nfunc g() -> i32_t { return $; }\n";
+    BOOST_TEST(same_first_error(text, 2ul, 28ul));
+    auto const parsed = parse(dep0::source_text::from_literal(text), parse_options_t{front_end_t::recursive_descent});
+    BOOST_TEST_REQUIRE(parsed.has_error());
+    BOOST_TEST(parsed.error().error == "token recognition error at: '$'");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
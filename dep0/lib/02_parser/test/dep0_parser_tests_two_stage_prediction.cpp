@@ -0,0 +1,110 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Tests for `prediction_mode_t::two_stage`, which parses with SLL prediction and falls back to full LL
+ * only if that fails. Whichever stage succeeds, the AST or the error must be the same as with full LL only;
+ * the `parser.ll_fallbacks` statistic tells which stage it was.
+ */
+#define BOOST_TEST_MODULE dep0_parser_tests_two_stage_prediction
+#include <boost/test/unit_test.hpp>
+
+#include "parser_tests_fixture.hpp"
+
+#include "dep0/parser/parse.hpp"
+
+#include "dep0/stats.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace dep0::parser;
+
+/** Return how many times two-stage prediction fell back to full LL since statistics were last reset. */
+static std::uint64_t num_ll_fallbacks()
+{
+    auto const values = dep0::snapshot_stats();
+    auto const it = std::ranges::find_if(
+        values,
+        [] (dep0::stats_value_t const& x) { return x.component == "parser" and x.name == "ll_fallbacks"; });
+    return it == values.end() ? 0ul : it->value;
+}
+
+BOOST_FIXTURE_TEST_SUITE(dep0_parser_tests_two_stage_prediction, ParserTestsFixture)
+
+BOOST_AUTO_TEST_CASE(all_files)
+{
+    auto const files = all_testfiles();
+    BOOST_TEST_REQUIRE(not files.empty());
+    auto const ll = parse_options_t{front_end_t::antlr, prediction_mode_t::ll};
+    auto const two_stage = parse_options_t{front_end_t::antlr, prediction_mode_t::two_stage};
+    for (auto const& file: files)
+    {
+        BOOST_TEST_CONTEXT(file)
+        {
+            auto const expected = parse(testfiles / file, ll);
+            auto const actual = parse(testfiles / file, two_stage);
+            BOOST_TEST_REQUIRE(expected.has_value() == actual.has_value());
+            if (expected)
+                BOOST_TEST(is_same_module(*expected, *actual));
+            else
+            {
+                auto const& x = expected.error();
+                auto const& y = actual.error();
+                BOOST_TEST(x.error == y.error);
+                BOOST_TEST_REQUIRE(x.location.has_value() == y.location.has_value());
+                if (x.location)
+                {
+                    BOOST_TEST(x.location->line == y.location->line);
+                    BOOST_TEST(x.location->col == y.location->col);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(no_fallback_without_conflict)
+{
+    auto const source = dep0::source_text::from_literal("func f() -> i32_t\n{\n    return 0;\n}\n");
+    dep0::reset_stats();
+    dep0::enable_stats();
+    auto const result = parse(source, parse_options_t{front_end_t::antlr, prediction_mode_t::two_stage});
+    auto const fallbacks = num_ll_fallbacks();
+    dep0::enable_stats(false);
+    BOOST_TEST(result.has_value());
+    BOOST_TEST(fallbacks == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(ll_fallback_after_sll_conflict)
+{
+    // In `g(0);` the arguments can either extend the expression `g` or belong to the call statement itself.
+    // Only the enclosing `funcCallStmt` tells them apart, but SLL prediction ignores the enclosing rules;
+    // so it resolves the conflict by extending the expression, then fails at `;` and falls back to full LL.
+    auto const source = dep0::source_text::from_literal("func f() -> unit_t\n{\n    g(0);\n}\n");
+    dep0::reset_stats();
+    dep0::enable_stats();
+    auto const expected = parse(source, parse_options_t{front_end_t::antlr, prediction_mode_t::ll});
+    auto const fallbacks_before = num_ll_fallbacks();
+    auto const actual = parse(source, parse_options_t{front_end_t::antlr, prediction_mode_t::two_stage});
+    auto const fallbacks_after = num_ll_fallbacks();
+    dep0::enable_stats(false);
+    BOOST_TEST(fallbacks_before == 0ul);
+    BOOST_TEST(fallbacks_after == 1ul);
+    BOOST_TEST_REQUIRE(expected.has_value());
+    BOOST_TEST_REQUIRE(actual.has_value());
+    BOOST_TEST(is_same_module(*expected, *actual));
+}
+
+BOOST_AUTO_TEST_CASE(warm_up_is_idempotent)
+{
+    warm_up();
+    warm_up();
+    auto const result = parse(testfiles / "0000_basics" / "pass_000.depc");
+    BOOST_TEST(result.has_value());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -8,6 +8,140 @@
 
 #include "dep0/parser/parse.hpp"
 
+#include "dep0/ast/pretty_print.hpp"
+
+#include <algorithm>
+#include <ranges>
+#include <sstream>
+#include <string>
+
+using namespace dep0::parser;
+
+static std::string to_string(module_t const& m)
+{
+    std::ostringstream str;
+    dep0::ast::pretty_print(str, m);
+    return str.str();
+}
+
+/**
+ * Collect the source location of all nodes, in depth-first order.
+ * Together with the pretty-printed module, this is enough to tell whether two ASTs are the same.
+ */
+struct locations_t
+{
+    std::vector<dep0::source_loc_t> result;
+
+    void add(expr_t const& x)
+    {
+        result.push_back(x.properties);
+        dep0::match(
+            x.value,
+            [this] (expr_t::boolean_expr_t const& x)
+            {
+                dep0::match(
+                    x.value,
+                    [this] (expr_t::boolean_expr_t::not_t const& x) { add(x.expr.get()); },
+                    [this] (auto const& x) { add(x.lhs.get()); add(x.rhs.get()); });
+            },
+            [this] (expr_t::relation_expr_t const& x)
+            {
+                dep0::match(x.value, [this] (auto const& x) { add(x.lhs.get()); add(x.rhs.get()); });
+            },
+            [this] (expr_t::arith_expr_t const& x)
+            {
+                dep0::match(x.value, [this] (auto const& x) { add(x.lhs.get()); add(x.rhs.get()); });
+            },
+            [this] (expr_t::app_t const& x) { add(x); },
+            [this] (expr_t::abs_t const& x) { add(x.args); add(x.ret_type.get()); add(x.body); },
+            [this] (expr_t::pi_t const& x) { add(x); },
+            [this] (expr_t::sigma_t const& x) { add(x.args); },
+            [this] (expr_t::addressof_t const& x) { add(x.expr.get()); },
+            [this] (expr_t::deref_t const& x) { add(x.expr.get()); },
+            [this] (expr_t::scopeof_t const& x) { add(x.expr.get()); },
+            [this] (expr_t::init_list_t const& x) { for (auto const& v: x.values) add(v); },
+            [this] (expr_t::member_t const& x) { add(x.object.get()); },
+            [this] (expr_t::subscript_t const& x) { add(x.object.get()); add(x.index.get()); },
+            [this] (expr_t::because_t const& x) { add(x.value.get()); add(x.reason.get()); },
+            [] (auto const&) { });
+    }
+
+    void add(expr_t::app_t const& x)
+    {
+        add(x.func.get());
+        for (auto const& arg: x.args)
+            add(arg);
+    }
+
+    void add(expr_t::pi_t const& x)
+    {
+        add(x.args);
+        add(x.ret_type.get());
+    }
+
+    void add(std::vector<func_arg_t> const& args)
+    {
+        for (auto const& arg: args)
+        {
+            result.push_back(arg.properties);
+            add(arg.type);
+        }
+    }
+
+    void add(body_t const& x)
+    {
+        result.push_back(x.properties);
+        for (auto const& s: x.stmts)
+        {
+            result.push_back(s.properties);
+            dep0::match(
+                s.value,
+                [this] (expr_t::app_t const& x) { add(x); },
+                [this] (stmt_t::if_else_t const& x)
+                {
+                    add(x.cond);
+                    add(x.true_branch);
+                    if (x.false_branch)
+                        add(*x.false_branch);
+                },
+                [this] (stmt_t::return_t const& x) { if (x.expr) add(*x.expr); },
+                [this] (stmt_t::impossible_t const& x) { if (x.reason) add(*x.reason); });
+        }
+    }
+
+    void add(module_t const& m)
+    {
+        result.push_back(m.properties);
+        for (auto const& entry: m.entries)
+            dep0::match(
+                entry,
+                [this] (type_def_t const& x)
+                {
+                    result.push_back(x.properties);
+                    if (auto const s = std::get_if<type_def_t::struct_t>(&x.value))
+                        for (auto const& field: s->fields)
+                            add(field.type);
+                },
+                [this] (axiom_t const& x) { result.push_back(x.properties); add(x.signature); },
+                [this] (extern_decl_t const& x) { result.push_back(x.properties); add(x.signature); },
+                [this] (func_decl_t const& x) { result.push_back(x.properties); add(x.signature); },
+                [this] (func_def_t const& x)
+                {
+                    result.push_back(x.properties);
+                    add(x.value.args);
+                    add(x.value.ret_type.get());
+                    add(x.value.body);
+                });
+    }
+};
+
+static std::vector<dep0::source_loc_t> locations_of(module_t const& m)
+{
+    locations_t locations;
+    locations.add(m);
+    return std::move(locations.result);
+}
+
 boost::test_tools::predicate_result ParserTestsFixture::pass(std::filesystem::path const file)
 {
     auto parse_result = dep0::parser::parse(testfiles / file);
@@ -30,3 +164,42 @@ boost::test_tools::predicate_result ParserTestsFixture::fail(std::filesystem::pa
     return res;
 }
 
+
+std::vector<std::filesystem::path> ParserTestsFixture::all_testfiles() const
+{
+    std::vector<std::filesystem::path> result;
+    for (auto const& entry: std::filesystem::recursive_directory_iterator(testfiles))
+        if (entry.path().extension() == ".depc")
+            result.push_back(std::filesystem::relative(entry.path(), testfiles));
+    std::ranges::sort(result);
+    return result;
+}
+
+boost::test_tools::predicate_result ParserTestsFixture::is_same_module(module_t const& a, module_t const& b)
+{
+    if (auto const x = to_string(a), y = to_string(b); x != y)
+    {
+        auto res = boost::test_tools::predicate_result(false);
+        res.message() << "Modules differ:\n" << x << "\nversus:\n" << y;
+        return res;
+    }
+    auto const xs = locations_of(a);
+    auto const ys = locations_of(b);
+    if (xs.size() != ys.size())
+    {
+        auto res = boost::test_tools::predicate_result(false);
+        res.message() << "Number of source locations differ: " << xs.size() << " != " << ys.size();
+        return res;
+    }
+    for (auto const i: std::views::iota(0ul, xs.size()))
+        if (xs[i].line != ys[i].line or xs[i].col != ys[i].col or xs[i].txt.view() != ys[i].txt.view())
+        {
+            auto res = boost::test_tools::predicate_result(false);
+            res.message()
+                << "Source location " << i << " differs: "
+                << xs[i].line << ':' << xs[i].col << " `" << xs[i].txt.view() << "` != "
+                << ys[i].line << ':' << ys[i].col << " `" << ys[i].txt.view() << '`';
+            return res;
+        }
+    return true;
+}
@@ -16,6 +16,7 @@
 #include <cstdlib>
 #include <optional>
 #include <filesystem>
+#include <vector>
 
 struct ParserTestsFixture
 {
@@ -26,6 +27,13 @@ struct ParserTestsFixture
     boost::test_tools::predicate_result pass(std::filesystem::path);
     boost::test_tools::predicate_result fail(std::filesystem::path);
 
+    /** @return All test files, relative to `testfiles` and sorted by name. */
+    std::vector<std::filesystem::path> all_testfiles() const;
+
+    /** Check that two modules are the same, including the source location of every node. */
+    static boost::test_tools::predicate_result
+    is_same_module(dep0::parser::module_t const&, dep0::parser::module_t const&);
+
     template <typename... Args>
     static constexpr auto app_of(Args&&... args)
     {
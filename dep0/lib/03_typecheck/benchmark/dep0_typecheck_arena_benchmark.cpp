@@ -0,0 +1,109 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Measures the effect of `dep0::arena_t` on parsing and typechecking.
+ *
+ * Usage: `dep0_typecheck_arena_benchmark <heap|arena> [--iterations=N] <input-files>...`
+ *
+ * Every input file is parsed and typechecked `N` times (by default 10), each time in a fresh arena if requested.
+ * It reports the number of heap allocations, some arena statistics, the elapsed time and the peak RSS.
+ * Since peak RSS never decreases, each allocation mode should be benchmarked in its own process.
+ */
+#include "dep0/parser/parse.hpp"
+#include "dep0/typecheck/check.hpp"
+#include "dep0/typecheck/environment.hpp"
+
+#include "dep0/arena.hpp"
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <vector>
+
+static std::atomic<std::size_t> num_heap_allocations = 0ul;
+
+void* operator new(std::size_t const size)
+{
+    num_heap_allocations.fetch_add(1ul, std::memory_order_relaxed);
+    if (auto const p = std::malloc(size > 0ul ? size : 1ul))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* const p) noexcept { std::free(p); }
+void operator delete(void* const p, std::size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv)
+{
+    auto const args = std::vector<std::string_view>(argv + 1, argv + argc);
+    if (args.empty() or (args[0] != "heap" and args[0] != "arena"))
+    {
+        std::cerr << "usage: dep0_typecheck_arena_benchmark <heap|arena> [--iterations=N] <input-files>...\n";
+        return 1;
+    }
+    bool const use_arena = args[0] == "arena";
+    std::size_t iterations = 10ul;
+    std::vector<std::filesystem::path> input_files;
+    for (auto const arg: args | std::views::drop(1))
+        if (arg.starts_with("--iterations="))
+            iterations = std::strtoul(arg.substr(13).data(), nullptr, 10);
+        else
+            input_files.emplace_back(arg);
+
+    auto const base_env = dep0::typecheck::make_base_env();
+    if (not base_env)
+    {
+        std::cerr << "failed to build the base environment" << std::endl;
+        return 1;
+    }
+
+    dep0::arena_t::statistics_t arena_stats{};
+    std::size_t num_failures = 0ul;
+    auto const heap_allocations_before = num_heap_allocations.load();
+    auto const start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0ul; i < iterations; ++i)
+        for (auto const& f: input_files)
+        {
+            auto arena = std::optional<dep0::arena_t>{};
+            auto const scope = use_arena ? dep0::arena_scope_t(arena.emplace()) : dep0::arena_scope_t(nullptr);
+            auto const module = dep0::parser::parse(f);
+            if (not module or not dep0::typecheck::check(*base_env, *module))
+                ++num_failures;
+            if (arena)
+            {
+                auto const stats = arena->statistics();
+                arena_stats.num_allocations += stats.num_allocations;
+                arena_stats.num_reused += stats.num_reused;
+                arena_stats.reserved_bytes += stats.reserved_bytes;
+            }
+        }
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+    auto const heap_allocations = num_heap_allocations.load() - heap_allocations_before;
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout
+        << "mode:               " << args[0] << '\n'
+        << "input files:        " << input_files.size() << " (of which " << num_failures / iterations << " failed)\n"
+        << "iterations:         " << iterations << '\n'
+        << "heap allocations:   " << heap_allocations << '\n'
+        << "arena allocations:  " << arena_stats.num_allocations << '\n'
+        << "arena reused:       " << arena_stats.num_reused << '\n'
+        << "arena reserved:     " << arena_stats.reserved_bytes / 1024ul << " KiB\n"
+        << "elapsed:            " << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms\n"
+        << "peak RSS:           " << usage.ru_maxrss << " KiB" << std::endl;
+    return 0;
+}
@@ -17,10 +17,9 @@
 #include "dep0/ast/ast.hpp"
 #include "dep0/ast/concepts.hpp"
 
+#include "dep0/recursive_wrapper.hpp"
 #include "dep0/source.hpp"
 
-#include <boost/variant/recursive_wrapper.hpp>
-
 #include <optional>
 #include <ostream>
 
@@ -58,7 +57,7 @@ struct env_t; // environment.hpp depends on expr_t; so we forward declare env_t
 struct legal_module_t
 {
     derivation_t<module_t> derivation;
-    boost::recursive_wrapper<env_t> env;
+    dep0::recursive_wrapper<env_t> env;
 
     bool operator==(legal_module_t const&) const = default;
 };
@@ -74,7 +73,7 @@ struct legal_axiom_t
 {
     source_loc_t origin;
     derivation_t<axiom_t> derivation;
-    boost::recursive_wrapper<sort_t> sort;
+    dep0::recursive_wrapper<sort_t> sort;
     bool operator==(legal_axiom_t const&) const = default;
 };
 
@@ -82,7 +81,7 @@ struct legal_extern_decl_t
 {
     source_loc_t origin;
     derivation_t<extern_decl_t> derivation;
-    boost::recursive_wrapper<sort_t> sort;
+    dep0::recursive_wrapper<sort_t> sort;
     bool operator==(legal_extern_decl_t const&) const = default;
 };
 
@@ -90,7 +89,7 @@ struct legal_func_decl_t
 {
     source_loc_t origin;
     derivation_t<func_decl_t> derivation;
-    boost::recursive_wrapper<sort_t> sort;
+    dep0::recursive_wrapper<sort_t> sort;
     bool operator==(legal_func_decl_t const&) const = default;
 };
 
@@ -98,7 +97,7 @@ struct legal_func_def_t
 {
     source_loc_t origin;
     derivation_t<func_def_t> derivation;
-    boost::recursive_wrapper<sort_t> sort;
+    dep0::recursive_wrapper<sort_t> sort;
     bool operator==(legal_func_def_t const&) const = default;
 };
 
@@ -123,7 +122,7 @@ struct legal_stmt_t
 struct legal_expr_t
 {
     derivation_t<expr_t> derivation;
-    boost::recursive_wrapper<sort_t> sort;
+    dep0::recursive_wrapper<sort_t> sort;
     bool operator==(legal_expr_t const&) const = default;
 };
 
@@ -137,5 +136,5 @@ std::ostream& pretty_print(std::ostream&, sort_t const&, std::size_t indent = 0u
 
 // it is not sufficient to only forward declare `env_t`,
 // we also need to include it here in order to make its destructor visible,
-// otherwise `boost::recursive_wrapper` does not compile
+// otherwise `dep0::recursive_wrapper` does not compile
 #include "dep0/typecheck/environment.hpp"
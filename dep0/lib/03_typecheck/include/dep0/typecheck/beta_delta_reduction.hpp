@@ -16,6 +16,42 @@
 
 namespace dep0::typecheck {
 
+/**
+ * @brief The algorithms that `beta_delta_normalize()` can use, which are expected to produce alpha-equivalent results.
+ * @see @ref beta_delta_reduction
+ */
+enum class normalizer_t
+{
+    /** @brief Alternate passes of beta-reduction, by capture-avoiding substitution, and delta-unfolding. */
+    substitution,
+
+    /**
+     * @brief Normalization by evaluation: the expression is evaluated in a single pass, under an environment
+     * that binds the arguments of each function being applied to their normal form, instead of substituting them.
+     */
+    evaluation
+};
+
+/**
+ * @brief RAII object that selects the algorithm used by `beta_delta_normalize()` in the calling thread,
+ * until it is destroyed; after that, the previous algorithm is restored.
+ *
+ * Without any active scope, `normalizer_t::substitution` is used.
+ */
+class normalizer_scope_t
+{
+    normalizer_t const m_previous;
+
+public:
+    explicit normalizer_scope_t(normalizer_t);
+    normalizer_scope_t(normalizer_scope_t const&) = delete;
+    normalizer_scope_t& operator=(normalizer_scope_t const&) = delete;
+    ~normalizer_scope_t();
+};
+
+/** @brief Return the algorithm currently used by `beta_delta_normalize()` in the calling thread. */
+normalizer_t current_normalizer();
+
 /**
  * @brief Perform a combined beta-delta normalization inside the given module.
  * @remarks Delta-unfolding is only performed inside a direct application,
@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -11,14 +11,84 @@
 #pragma once
 
 #include "dep0/typecheck/ast.hpp"
+#include "dep0/typecheck/beta_delta_reduction.hpp"
 #include "dep0/typecheck/environment.hpp"
+#include "dep0/typecheck/profile.hpp"
 
 #include "dep0/parser/ast.hpp"
 
 #include "dep0/error.hpp"
 
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
 namespace dep0::typecheck {
 
+/**
+ * @brief Limits the amount of work that Proof Search can do to find a value of some type,
+ * for example when the value of an argument is `auto` or a `true_t(...)` proof must be found.
+ *
+ * The budget is measured in steps, where each step is a single attempt to make progress on a branch of the
+ * search space, so that the outcome of a search depends only on the input program and not on the machine load.
+ * Each individual search has its own budget, it does not carry over to the next search.
+ */
+struct proof_search_budget_t
+{
+    /** @brief Maximum number of steps that a single search can take before giving up. */
+    std::size_t fuel = 100'000ul;
+
+    /** @brief Maximum depth of the search tree; a branch deeper than this fails immediately. */
+    std::size_t max_depth = 10ul;
+
+    /**
+     * @brief Optional wall-clock limit for a single search, as a safety net on top of `fuel`.
+     * @warning Setting a timeout makes the outcome of typechecking depend on how fast the machine is.
+     */
+    std::optional<std::chrono::milliseconds> timeout = std::nullopt;
+
+    /**
+     * @brief Maximum number of threads that a single search can use to explore alternative proofs concurrently.
+     *
+     * With more than one thread, each alternative at the root of the search tree is explored independently
+     * and the one that succeeds in the fewest steps wins, ties going to the alternative that comes first;
+     * so the proof found does not depend on timing nor on the number of threads, as long as there are at least two.
+     * Either way, a search takes at most `fuel` steps in total: the alternatives that succeed or fail immediately
+     * take the steps they need and the rest is split evenly across all other alternatives.
+     *
+     * @warning Because each alternative only gets a share of `fuel`, a proof that a single thread finds
+     * might need more steps than its alternative is given; so going from one thread to more than one can make
+     * a search fail, and hence a file stop typechecking, as well as change the proof found.
+     */
+    std::size_t threads = 1ul;
+};
+
+/** @brief Options that change the behaviour of `dep0::typecheck::check()`. */
+struct check_options_t
+{
+    /** @brief The Proof Search budget used by default for all entries of the module. */
+    proof_search_budget_t proof_search;
+
+    /**
+     * @brief Overrides the Proof Search fuel for the functions with the given names.
+     * The override applies both to the function definition and to its declaration, if any.
+     */
+    std::map<std::string, std::size_t, std::less<>> proof_search_fuel_overrides;
+
+    /** @brief The algorithm used by `beta_delta_normalize()` whilst typechecking the module. */
+    normalizer_t normalizer = normalizer_t::substitution;
+
+    /**
+     * @brief If set, the profile of every function definition checked is appended to this vector,
+     * whether or not it typechecks; the vector is only accessed by the thread calling `check()`.
+     */
+    std::vector<func_profile_t>* profile = nullptr;
+};
+
 /**
  * @brief Run type-checking on the given module inside the given enviornment.
  *
@@ -30,6 +100,6 @@ namespace dep0::typecheck {
  *   - completely empty (i.e. default-constructed) when type-checking the prelude module
  *   - or the base environment (i.e. with prelude pre-imported) when type-checking a user module.
  */
-expected<module_t> check(env_t const&, parser::module_t const&) noexcept;
+expected<module_t> check(env_t const&, parser::module_t const&, check_options_t const& = {}) noexcept;
 
 } // namespace dep0::typecheck
@@ -16,6 +16,7 @@
 #include "dep0/error.hpp"
 #include "dep0/scope_map.hpp"
 
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <set>
@@ -73,6 +74,9 @@ public:
         expr_t::var_t var;  /**< Copy of the variable to which this declaration was bound, eg `x` in `0 i32_t x`. */
         ast::qty_t qty;     /**< Quantity of the variable declaration, eg `0` in `0 i32_t x`. */
         expr_t type;        /**< Type of the variable declaration, eg `i32_t` in `0 i32_t x`. */
+
+    private:
+        std::size_t ordinal = 0ul; /**< How many declarations were added before this one, including all parents. */
     };
 
     /** @brief The default context is unscoped, which reduces the risk of compiler bugs when typechecking references. */
@@ -107,6 +111,11 @@ public:
      *
      * For example, if `xs` has type `array_t(i32_t, n)`, rewriting from `n` to `2` will
      * return a new context where `xs` has type `array_t(i32_t, 2)`.
+     *
+     * Declarations added to the new context afterwards are not rewritten.
+     *
+     * @remarks This is cheap because the new context only records the rewrite;
+     * the type of each declaration is rewritten the first time it is looked up and then remembered.
      */
     ctx_t rewrite(expr_t const& from, expr_t const& to) const;
 
@@ -142,17 +151,26 @@ public:
     dep0::expected<expr_t::var_t> try_emplace(source_text, std::optional<source_loc_t>, ast::qty_t, expr_t type);
 
 private:
+    struct rewrite_t;
+
     enum class scope_flavour_t { scoped_v, unscoped_v };
     scope_flavour_t m_flavour = scope_flavour_t::unscoped_v;
     std::size_t m_scope_id = 0ul;
+    std::size_t m_num_decls = 0ul; // including all parents; used to assign `decl_t::ordinal`
     scope_map<source_text, expr_t::var_t> m_index;
     scope_map<expr_t::var_t, decl_t> m_values;
+    std::shared_ptr<rewrite_t const> m_rewrites; // the most recent rewrite, if any, which links to the previous ones
 
     ctx_t(
         scope_flavour_t,
         std::size_t new_scope_id,
+        std::size_t num_decls,
         scope_map<source_text, expr_t::var_t>,
-        scope_map<expr_t::var_t, decl_t>);
+        scope_map<expr_t::var_t, decl_t>,
+        std::shared_ptr<rewrite_t const>);
+
+    /** @brief Return the given declaration with its type rewritten by all rewrites recorded after it was added. */
+    decl_t const& rewritten(decl_t const&) const;
 };
 
 // non-member functions
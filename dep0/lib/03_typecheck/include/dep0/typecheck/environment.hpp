@@ -104,4 +104,12 @@ private:
  */
 dep0::expected<env_t> make_base_env();
 
+/**
+ * @brief Build a new environment with the given prelude module already pre-imported.
+ *
+ * This is useful when the prelude module was loaded from somewhere else rather than typechecked from source,
+ * for example from an image created at build time via `dep0::typecheck::serialize()`.
+ */
+dep0::expected<env_t> make_base_env(module_t const& prelude);
+
 } // namespace dep0::typecheck
@@ -0,0 +1,81 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Declares `dep0::typecheck::expr_interner_t` and `dep0::typecheck::interned_expr_t`.
+ */
+#pragma once
+
+#include "dep0/typecheck/ast.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+
+namespace dep0::typecheck {
+
+/**
+ * @brief Unique ID of an expression interned by some `expr_interner_t`.
+ *
+ * Two IDs obtained from the same interner are equal if and only if the original expressions are equivalent,
+ * so they can be compared and hashed in constant time, regardless of how big the expressions are.
+ * Comparing IDs obtained from different interners is meaningless.
+ */
+struct interned_expr_t
+{
+    std::size_t id;
+
+    bool operator==(interned_expr_t const&) const = default;
+};
+
+/**
+ * @brief Stores at most one copy of each expression, up to alpha-equivalence, and assigns it a unique ID.
+ *
+ * Two expressions are considered equivalent if they are alpha-equivalent and so are their types.
+ * The hash code of an expression is computed only once, when it is first interned;
+ * after that, lookup tables that need to find equivalent expressions many times can use `interned_expr_t` as key,
+ * rather than computing the hash code and performing the alpha-equivalence check on every lookup.
+ *
+ * @remarks This class is not thread-safe.
+ */
+class expr_interner_t
+{
+    std::deque<expr_t> m_exprs; // deque, so references returned by `operator[]` are never invalidated
+    std::unordered_multimap<std::size_t, std::size_t> m_ids_by_hash;
+
+    std::optional<interned_expr_t> find(expr_t const&, std::size_t hash) const;
+
+public:
+    /** @return The unique ID of the given expression, storing a copy of it if no equivalent one was interned yet. */
+    interned_expr_t intern(expr_t const&);
+
+    /** @return The unique ID of an expression equivalent to the given one, if it was interned already. */
+    std::optional<interned_expr_t> find(expr_t const&) const;
+
+    /** @return The first expression that was interned with the given ID. */
+    expr_t const& operator[](interned_expr_t) const;
+
+    /** @return The number of distinct expressions interned so far. */
+    std::size_t size() const;
+};
+
+} // namespace dep0::typecheck
+
+namespace std {
+
+template <>
+struct hash<dep0::typecheck::interned_expr_t>
+{
+    size_t operator()(dep0::typecheck::interned_expr_t const& x) const noexcept
+    {
+        return hash<size_t>{}(x.id);
+    }
+};
+
+} // namespace std
@@ -0,0 +1,39 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Declares `dep0::typecheck::func_profile_t`, collected by `check()` if requested via `check_options_t`.
+ */
+#pragma once
+
+#include "dep0/source.hpp"
+
+#include <chrono>
+#include <cstddef>
+
+namespace dep0::typecheck {
+
+/**
+ * @brief Where the typechecker spent its time whilst checking a single function definition.
+ *
+ * Times spent in Proof Search and normalization overlap, because normalization also happens during Proof Search.
+ * Proof Search time is measured only by the thread that starts each outermost search, so it never exceeds the total;
+ * but normalizations performed by the threads of a parallel search are summed, so their time can exceed it.
+ */
+struct func_profile_t
+{
+    source_text name;
+    source_loc_t origin;
+    std::chrono::nanoseconds time{}; /**< @brief Total time spent checking the definition. */
+    std::size_t proof_search_goals = 0ul; /**< @brief Number of searches, excluding those reused from the cache. */
+    std::size_t proof_search_tasks = 0ul; /**< @brief Number of steps taken by all searches. */
+    std::chrono::nanoseconds proof_search_time{};
+    std::size_t normalizations = 0ul;
+    std::chrono::nanoseconds normalization_time{};
+};
+
+} // namespace dep0::typecheck
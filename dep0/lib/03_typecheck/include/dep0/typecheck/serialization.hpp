@@ -0,0 +1,74 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Declares `dep0::typecheck::serialize()`, `dep0::typecheck::deserialize()` and their file-based versions.
+ */
+#pragma once
+
+#include "dep0/typecheck/ast.hpp"
+#include "dep0/typecheck/environment.hpp"
+
+#include "dep0/error.hpp"
+#include "dep0/source.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+
+namespace dep0::typecheck {
+
+/**
+ * @brief Version of the binary format produced by `serialize()`.
+ *
+ * It must be bumped every time the layout of the typechecked AST changes,
+ * for example when adding a new kind of expression, so that stale images are rejected rather than misread.
+ */
+inline constexpr std::uint32_t serialization_format_version = 1u;
+
+/**
+ * @brief Serialize a legal module into a compact binary image that can later be loaded by `deserialize()`.
+ *
+ * The image starts with a small header containing the format version,
+ * followed by a table of all names and source snippets used by the module, each stored only once.
+ */
+std::string serialize(module_t const&);
+
+/**
+ * @brief Load a legal module from an image previously produced by `serialize()`, without typechecking it again.
+ *
+ * Like `dep0::typecheck::check()`, all entries are added to a new environment extending the given base one;
+ * this must be equivalent to the environment that the module was originally typechecked in,
+ * for example the base environment returned by `make_base_env()` or an empty one for the prelude module itself.
+ *
+ * All names and source snippets of the returned module refer directly to the given buffer,
+ * which is kept alive by them, so no copies are made.
+ *
+ * @remarks The typing context in which each expression was typechecked is not stored, so it is always empty.
+ *
+ * @return The module contained in the given image or an error if it is malformed or of a different format version.
+ */
+dep0::expected<module_t> deserialize(env_t const&, source_text);
+
+/**
+ * @brief Write the image of a legal module, as produced by `serialize()`, to the given file.
+ *
+ * The image is first written to a temporary file in the same directory, which is then renamed;
+ * so a concurrent `read_image()` either sees the previous image, if any, or the new one but never a partial one.
+ */
+dep0::expected<std::true_type> write_image(std::filesystem::path const&, module_t const&);
+
+/**
+ * @brief Memory-map the given file and load the module image it contains, as per `deserialize()`.
+ *
+ * The file stays mapped for as long as any name or source snippet of the returned module is alive.
+ * The returned module can then be imported, under any name, via `env_t::import()`.
+ */
+dep0::expected<module_t> read_image(env_t const&, std::filesystem::path const&);
+
+} // namespace dep0::typecheck
@@ -0,0 +1,76 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Build-time tool that typechecks the prelude module and writes a C++ source file embedding its image.
+ *
+ * The generated file defines `dep0::typecheck::prelude_image()`.
+ */
+#include "private/prelude.hpp"
+
+#include "dep0/typecheck/environment.hpp"
+#include "dep0/typecheck/serialization.hpp"
+
+#include "dep0/error.hpp"
+#include "dep0/source.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <output-file>" << std::endl;
+        return 1;
+    }
+    auto const prelude = dep0::typecheck::build_prelude_module();
+    if (not prelude)
+    {
+        dep0::pretty_print(std::cerr, prelude.error()) << std::endl;
+        return 1;
+    }
+    auto const image = std::make_shared<std::string const>(dep0::typecheck::serialize(*prelude));
+    // make sure the image can be loaded back, otherwise better to fail the build now rather than at startup
+    auto const text = dep0::source_text(dep0::make_source_handle<std::shared_ptr<std::string const>>(image), *image);
+    if (auto const loaded = dep0::typecheck::deserialize(dep0::typecheck::env_t{}, text); not loaded)
+    {
+        dep0::pretty_print(std::cerr, loaded.error()) << std::endl;
+        return 1;
+    }
+    std::ofstream out(argv[1]);
+    out << "// generated by dep0_prelude_image_generator; do not edit\n";
+    out << "#include \"dep0/typecheck/prelude_image.hpp\"\n\n";
+    out << "#include <string_view>\n\n";
+    out << "namespace dep0::typecheck {\n\n";
+    out << "static unsigned char const image[] = {";
+    for (std::size_t i = 0ul; i < image->size(); ++i)
+    {
+        if (i % 16ul == 0ul)
+            out << "\n   ";
+        out << " 0x" << std::hex << std::setw(2) << std::setfill('0')
+            << static_cast<unsigned>(static_cast<std::uint8_t>((*image)[i])) << ',';
+    }
+    out << "\n};\n\n";
+    out << "source_text prelude_image()\n";
+    out << "{\n";
+    out << "    return source_text::from_static_buffer(\n";
+    out << "        std::string_view(reinterpret_cast<char const*>(image), sizeof(image)));\n";
+    out << "}\n\n";
+    out << "} // namespace dep0::typecheck\n";
+    out.close();
+    if (not out)
+    {
+        std::cerr << "failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
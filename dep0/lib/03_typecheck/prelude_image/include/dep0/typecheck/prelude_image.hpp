@@ -0,0 +1,27 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Single-function header declaring `dep0::typecheck::prelude_image()`.
+ */
+#pragma once
+
+#include "dep0/source.hpp"
+
+namespace dep0::typecheck {
+
+/**
+ * @brief Return the image of the prelude module, which was typechecked and serialized when building the compiler.
+ *
+ * It can be loaded via `dep0::typecheck::deserialize()` from an empty environment,
+ * which is much cheaper than parsing and typechecking the prelude module from source.
+ *
+ * @remarks The image is a constant buffer embedded in the binary, so it is safe to share it between threads.
+ */
+source_text prelude_image();
+
+} // namespace dep0::typecheck
@@ -6,6 +6,8 @@
  */
 #include "private/beta_delta_equivalence.hpp"
 
+#include "private/normal_form_cache.hpp"
+
 #include "dep0/typecheck/beta_delta_reduction.hpp"
 
 #include "dep0/ast/alpha_equivalence.hpp"
@@ -76,6 +78,14 @@ is_beta_delta_equivalent(expr_t const& x, expr_t const& y)
     auto eq = is_alpha_equivalent(x, y);
     if (not eq)
     {
+        if (auto const cache = normal_form_cache_t::current())
+        {
+            auto const& x2 = cache->normalize(x);
+            auto const& y2 = cache->normalize(y);
+            if (x2.changed or y2.changed)
+                eq = is_alpha_equivalent(x2.expr, y2.expr);
+            return eq;
+        }
         auto x2 = x;
         auto y2 = y;
         if (beta_delta_normalize(x2) | beta_delta_normalize(y2)) // don't short-circuit
@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -9,13 +9,40 @@
 #include "private/beta_reduction.hpp"
 #include "private/delta_unfold.hpp"
 #include "private/derivation_rules.hpp"
+#include "private/normalization_by_evaluation.hpp"
+#include "private/normalization_stats.hpp"
+#include "private/profile.hpp"
 
 #include "dep0/match.hpp"
+#include "dep0/stats.hpp"
 
 #include <cassert>
 
 namespace dep0::typecheck {
 
+static thread_local normalizer_t active_normalizer = normalizer_t::substitution;
+
+static stats_counter_t num_normalizations("typecheck", "normalizations");
+
+stats_counter_t num_beta_steps("typecheck", "beta_steps");
+stats_counter_t num_delta_steps("typecheck", "delta_steps");
+
+normalizer_scope_t::normalizer_scope_t(normalizer_t const normalizer) :
+    m_previous(active_normalizer)
+{
+    active_normalizer = normalizer;
+}
+
+normalizer_scope_t::~normalizer_scope_t()
+{
+    active_normalizer = m_previous;
+}
+
+normalizer_t current_normalizer()
+{
+    return active_normalizer;
+}
+
 namespace impl {
 
 static bool beta_delta_normalize(axiom_t&);
@@ -88,6 +115,8 @@ bool beta_delta_normalize(sort_t& sort)
 
 bool beta_delta_normalize(body_t& body)
 {
+    if (active_normalizer == normalizer_t::evaluation)
+        return normalize_by_evaluation(body);
     bool changed = beta_normalize(body);
     while (delta_unfold(body))
     {
@@ -109,9 +138,16 @@ bool beta_delta_normalize(module_t& m)
 
 bool beta_delta_normalize(expr_t& expr)
 {
+    num_normalizations.add();
+    if (auto const profile = current_func_profile())
+        profile->normalizations.fetch_add(1ul, std::memory_order_relaxed);
+    auto const timer = profile_timer_t(profile_timer_kind_t::normalization);
+    if (active_normalizer == normalizer_t::evaluation)
+        return normalize_by_evaluation(expr);
     bool changed = beta_normalize(expr);
     while (delta_unfold(expr))
     {
+        num_delta_steps.add();
         changed = true;
         beta_normalize(expr);
     }
@@ -7,6 +7,7 @@
 #include "private/beta_reduction.hpp"
 
 #include "private/drop_unreachable_stmts.hpp"
+#include "private/normalization_stats.hpp"
 #include "private/substitute.hpp"
 
 #include "dep0/typecheck/is_impossible.hpp"
@@ -128,8 +129,11 @@ bool beta_normalize(expr_t::app_t& app)
     {
         if (abs->args.size() > 0ul)
         {
+            auto& pi = std::get<expr_t::pi_t>(std::get<expr_t>(app.func.get().properties.sort.get()).value);
             assert(abs->args.size() == app.args.size()); // always true for legal terms
+            assert(pi.args.size() == app.args.size()); // always true for legal terms
             for (auto const i: std::views::iota(0ul, abs->args.size()))
+            {
                 if (auto const& arg = abs->args[i]; arg.var)
                     substitute(
                         *arg.var,
@@ -138,14 +142,24 @@ bool beta_normalize(expr_t::app_t& app)
                         abs->args.end(),
                         abs->ret_type.get(),
                         &abs->body);
-            // at this point all arguments of the abstraction have been substituted,
+                // the arguments of the function type need not have the same names as those of the abstraction
+                if (auto const& arg = pi.args[i]; arg.var)
+                    substitute(
+                        *arg.var,
+                        app.args[i],
+                        pi.args.begin() + i + 1,
+                        pi.args.end(),
+                        pi.ret_type.get(),
+                        nullptr);
+            }
+            // at this point all arguments of the abstraction and of its type have been substituted,
             // so we can remove them and normalize the new body;
             // also note that now the function type becomes a pi-type with no arguments
-            // TODO we should also perform substitution inside the function type but we need a test first
-            std::get<expr_t::pi_t>(std::get<expr_t>(app.func.get().properties.sort.get()).value).args.clear();
+            pi.args.clear();
             app.args.clear();
             abs->args.clear();
             changed = true;
+            num_beta_steps.add();
             beta_normalize(abs->body);
         }
     }
@@ -205,6 +219,18 @@ bool beta_normalize(expr_t::because_t& x)
 } // namespace impl
 
 bool beta_normalize(body_t& body)
+{
+    // First pass: drop all unreachable statements and normalize those that survive.
+    bool changed = drop_unreachable_stmts(body);
+    for (auto& s: body.stmts)
+        changed |= impl::beta_normalize(s);
+    // Second pass: drop unnecessary statements, like immutable function calls or dead branches.
+    // This may occasionally benefit from a look-ahead so we do it after the normalization pass above.
+    changed |= simplify_normalized_stmts(body);
+    return changed;
+}
+
+bool simplify_normalized_stmts(body_t& body)
 {
     // NB taking `stmts` by value because we are about to perform a destructive self-assignment
     auto const replace_with = [&] (std::vector<stmt_t>::iterator it, std::vector<stmt_t> stmts)
@@ -215,12 +241,7 @@ bool beta_normalize(body_t& body)
         body.stmts.erase(new_end, body.stmts.end());
         return it; // the first statement is obviously reachable, so `it` is still valid
     };
-    // First pass: drop all unreachable statements and normalize those that survive.
-    bool changed = drop_unreachable_stmts(body);
-    for (auto& s: body.stmts)
-        changed |= impl::beta_normalize(s);
-    // Second pass: drop unnecessary statements, like immutable function calls or dead branches.
-    // This may occasionally benefit from a look-ahead so we do it after the normalization pass above.
+    bool changed = false;
     for (auto it = body.stmts.begin(); it != body.stmts.end();)
         it = match(
             it->value,
@@ -12,7 +12,10 @@
 #include "private/cpp_int_limits.hpp"
 #include "private/c_types.hpp"
 #include "private/derivation_rules.hpp"
+#include "private/normal_form_cache.hpp"
+#include "private/profile.hpp"
 #include "private/proof_search.hpp"
+#include "private/proof_search_cache.hpp"
 #include "private/returns_from_all_branches.hpp"
 #include "private/substitute.hpp"
 #include "private/type_assign.hpp"
@@ -26,11 +29,13 @@
 #include "dep0/fmap.hpp"
 #include "dep0/match.hpp"
 #include "dep0/scope_map.hpp"
+#include "dep0/stats.hpp"
 
 #include <boost/hana.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <iterator>
 #include <numeric>
 #include <ranges>
@@ -39,6 +44,9 @@
 
 namespace dep0::typecheck {
 
+static stats_counter_t num_modules("typecheck", "modules");
+static stats_counter_t num_func_defs("typecheck", "func_defs");
+
 /** If the given type is integral return both its sign and width. */
 static std::optional<std::pair<ast::sign_t, ast::width_t>> get_sign_and_width(env_t const& env, sort_t const& sort)
 {
@@ -71,8 +79,23 @@ static bool has_attribute(func_decl_t const& x, std::string_view const attribute
     return x.attribute and x.attribute->value == attribute;
 }
 
-expected<module_t> check(env_t const& base_env, parser::module_t const& x) noexcept
+/** Returns the Proof Search budget to use for the function with the given name, taking overrides into account. */
+static proof_search_budget_t get_budget(check_options_t const& options, source_text const& name)
+{
+    auto budget = options.proof_search;
+    auto const& overrides = options.proof_search_fuel_overrides;
+    if (auto const it = overrides.find(name.view()); it != overrides.end())
+        budget.fuel = it->second;
+    return budget;
+}
+
+expected<module_t> check(env_t const& base_env, parser::module_t const& x, check_options_t const& options) noexcept
 {
+    num_modules.add();
+    auto const budget_scope = proof_search_budget_scope_t(options.proof_search);
+    auto const normalizer_scope = normalizer_scope_t(options.normalizer);
+    proof_search_cache_t const proof_cache; // shared by all searches in this module
+    normal_form_cache_t const normal_form_cache; // shared by all equivalence checks in this module
     auto env = base_env.extend();
     std::vector<std::pair<expr_t::global_t, source_loc_t>> decls; // helps checking that all functions are defined
     auto entries =
@@ -88,12 +111,32 @@ expected<module_t> check(env_t const& base_env, parser::module_t const& x) noexc
                     [&] (parser::extern_decl_t const& x) -> expected<entry_t> { return check_extern_decl(env, x); },
                     [&] (parser::func_decl_t const& x) -> expected<entry_t>
                     {
+                        auto const function_scope = proof_search_budget_scope_t(get_budget(options, x.name));
                         auto const& result = check_func_decl(env, x);
                         if (result and not has_attribute(*result, "builtin"))
                             decls.emplace_back(expr_t::global_t{std::nullopt, x.name}, x.properties);
                         return result;
                     },
-                    [&] (parser::func_def_t const& f) -> expected<entry_t> { return check_func_def(env, f); });
+                    [&] (parser::func_def_t const& f) -> expected<entry_t>
+                    {
+                        auto const function_scope = proof_search_budget_scope_t(get_budget(options, f.name));
+                        if (not options.profile)
+                            return check_func_def(env, f);
+                        func_profile_counters_t counters;
+                        auto const start = std::chrono::steady_clock::now();
+                        auto result = [&]
+                        {
+                            auto const profile_scope = func_profile_scope_t(&counters);
+                            return check_func_def(env, f);
+                        }();
+                        auto& profile = options.profile->emplace_back(func_profile_t{
+                            .name = f.name,
+                            .origin = f.properties,
+                            .time = std::chrono::steady_clock::now() - start
+                        });
+                        counters.copy_to(profile);
+                        return result;
+                    });
             });
     if (not entries)
         return std::move(entries.error());
@@ -236,6 +279,7 @@ expected<func_decl_t> check_func_decl(env_t& env, parser::func_decl_t const& dec
 
 expected<func_def_t> check_func_def(env_t& env, parser::func_def_t const& f)
 {
+    num_func_defs.add();
     ctx_t ctx(ctx_t::scoped_t{});
     usage_t usage;
     auto abs = type_assign_abs(env, ctx, f.value, f.properties, f.name, usage, ast::qty_t::one);
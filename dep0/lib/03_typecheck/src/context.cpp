@@ -16,27 +16,84 @@
 #include "private/rewrite.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <deque>
 #include <iterator>
+#include <map>
+#include <mutex>
 #include <numeric>
 #include <ranges>
 #include <sstream>
 
 namespace dep0::typecheck {
 
+/**
+ * @brief A rewrite `from = to` recorded by `ctx_t::rewrite()`, which applies to all declarations added before it.
+ *
+ * Rewrites are chained from the most recent to the oldest and each remembers the declarations it has rewritten,
+ * so that a declaration is rewritten at most once by each rewrite, even if many contexts share it.
+ */
+struct ctx_t::rewrite_t
+{
+    std::shared_ptr<rewrite_t const> prev;
+    expr_t from;
+    expr_t to;
+    std::size_t num_decls; // only declarations whose ordinal is smaller than this are rewritten
+
+    // the same context may be looked up from multiple threads, for example during proof search
+    mutable std::mutex mutex;
+    mutable std::map<expr_t::var_t, decl_t const*> results;
+    mutable std::deque<decl_t> storage; // owns the declarations whose type was actually changed
+
+    rewrite_t(std::shared_ptr<rewrite_t const> prev, expr_t from, expr_t to, std::size_t const num_decls) :
+        prev(std::move(prev)), from(std::move(from)), to(std::move(to)), num_decls(num_decls)
+    { }
+
+    /** @brief Return the given declaration after applying this and all previous rewrites that apply to it. */
+    decl_t const& apply(decl_t const& decl) const
+    {
+        assert(decl.ordinal < num_decls);
+        {
+            auto const lock = std::lock_guard(mutex);
+            if (auto const it = results.find(decl.var); it != results.end())
+                return *it->second;
+        }
+        // previous rewrites have at most the same number of declarations, so check if they apply too
+        auto const& before = prev and decl.ordinal < prev->num_decls ? prev->apply(decl) : decl;
+        auto new_type = typecheck::rewrite(from, to, before.type);
+        auto const lock = std::lock_guard(mutex);
+        if (auto const it = results.find(decl.var); it != results.end())
+            return *it->second; // another thread got here first
+        decl_t const* result = &before;
+        if (new_type)
+        {
+            auto& copy = storage.emplace_back(before);
+            copy.type = std::move(*new_type);
+            result = &copy;
+        }
+        results.emplace(decl.var, result);
+        return *result;
+    }
+};
+
 ctx_t::ctx_t(scoped_t) : m_flavour(scope_flavour_t::scoped_v), m_scope_id(0) { }
 
 ctx_t::ctx_t(
     scope_flavour_t const flavour,
     std::size_t const scope_id,
+    std::size_t const num_decls,
     scope_map<source_text, expr_t::var_t> index,
-    scope_map<expr_t::var_t, decl_t> values
+    scope_map<expr_t::var_t, decl_t> values,
+    std::shared_ptr<rewrite_t const> rewrites
 ) :
     m_flavour(flavour),
     m_scope_id(scope_id),
+    m_num_decls(num_decls),
     m_index(std::move(index)),
-    m_values(std::move(values))
+    m_values(std::move(values)),
+    m_rewrites(std::move(rewrites))
 { }
 
 // const member functions
@@ -48,46 +105,56 @@ std::optional<std::size_t> ctx_t::scope() const
 
 ctx_t ctx_t::extend() const
 {
-    return ctx_t(m_flavour, m_scope_id + 1ul, m_index.extend(), m_values.extend());
+    return ctx_t(m_flavour, m_scope_id + 1ul, m_num_decls, m_index.extend(), m_values.extend(), m_rewrites);
 }
 
 ctx_t ctx_t::extend_scoped() const
 {
-    return ctx_t(scope_flavour_t::scoped_v, m_scope_id + 1ul, m_index.extend(), m_values.extend());
+    return ctx_t(
+        scope_flavour_t::scoped_v, m_scope_id + 1ul, m_num_decls, m_index.extend(), m_values.extend(), m_rewrites);
 }
 
 ctx_t ctx_t::extend_unscoped() const
 {
-    return ctx_t(scope_flavour_t::unscoped_v, m_scope_id + 1ul, m_index.extend(), m_values.extend());
+    return ctx_t(
+        scope_flavour_t::unscoped_v, m_scope_id + 1ul, m_num_decls, m_index.extend(), m_values.extend(), m_rewrites);
 }
 
 ctx_t ctx_t::rewrite(expr_t const& from, expr_t const& to) const
 {
-    auto new_values = m_values.deep_copy();
-    for (auto& [_, decl]: std::ranges::subrange(new_values.cbegin(), new_values.cend()))
-        if (auto new_type = typecheck::rewrite(from, to, decl.type))
-            // TODO remove const_cast
-            const_cast<expr_t&>(decl.type) = std::move(*new_type);
-    return ctx_t(m_flavour, m_scope_id, m_index.extend(), std::move(new_values));
+    // declarations are not copied: they are rewritten on lookup, but only those added before this point
+    return ctx_t(
+        m_flavour,
+        m_scope_id,
+        m_num_decls,
+        m_index.extend(),
+        m_values.extend(),
+        std::make_shared<rewrite_t const>(m_rewrites, from, to, m_num_decls));
 }
 
 std::vector<std::reference_wrapper<ctx_t::decl_t const>> ctx_t::decls() const
 {
     std::vector<std::reference_wrapper<ctx_t::decl_t const>> result;
     for (auto const& v: std::views::values(std::ranges::subrange(m_values.cbegin(), m_values.cend())))
-        result.push_back(std::cref(v));
+        result.push_back(std::cref(rewritten(v)));
     return result;
 }
 
 ctx_t::decl_t const* ctx_t::operator[](expr_t::var_t const& var) const
 {
-    return m_values[var];
+    auto const decl = m_values[var];
+    return decl ? &rewritten(*decl) : nullptr;
 }
 
 ctx_t::decl_t const* ctx_t::operator[](source_text const& name) const
 {
     auto const var = m_index[name];
-    return var ? m_values[*var] : nullptr;
+    return var ? (*this)[*var] : nullptr;
+}
+
+ctx_t::decl_t const& ctx_t::rewritten(decl_t const& decl) const
+{
+    return m_rewrites and decl.ordinal < m_rewrites->num_decls ? m_rewrites->apply(decl) : decl;
 }
 
 
@@ -95,11 +162,13 @@ ctx_t::decl_t const* ctx_t::operator[](source_text const& name) const
 
 void ctx_t::add_unnamed(ast::qty_t const qty, expr_t type)
 {
-    static std::size_t unnamed_idx = 0;
+    // atomic because multiple input files might be typechecked concurrently
+    static std::atomic<std::size_t> unnamed_idx = 0;
     static const source_text empty = source_text::from_literal("auto");
-    auto const var = expr_t::var_t{empty, 0ul, unnamed_idx++};
-    bool const inserted = m_values.try_emplace(var, std::nullopt, scope(), var, qty, std::move(type)).second;
+    auto const var = expr_t::var_t{empty, 0ul, unnamed_idx.fetch_add(1ul, std::memory_order_relaxed)};
+    auto const [it, inserted] = m_values.try_emplace(var, std::nullopt, scope(), var, qty, std::move(type));
     assert(inserted and "failed to add unnamed variable to context");
+    it->second.ordinal = m_num_decls++;
 }
 
 dep0::expected<expr_t::var_t>
@@ -111,13 +180,14 @@ ctx_t::try_emplace(source_text name, std::optional<source_loc_t> const loc, ast:
     auto const [it, inserted] = m_index.try_emplace(name, var);
     if (inserted)
     {
-        bool const inserted = m_values.try_emplace(var, loc, scope(), var, qty, std::move(type)).second;
-        assert(inserted and "failed to add named variable to context");
+        auto const [decl_it, decl_inserted] = m_values.try_emplace(var, loc, scope(), var, qty, std::move(type));
+        assert(decl_inserted and "failed to add named variable to context");
+        decl_it->second.ordinal = m_num_decls++;
         return var;
     }
     else
     {
-        auto const prev = m_values[*prev_var];
+        auto const prev = (*this)[*prev_var];
         assert(prev and "failed to find previous declaration of existing variable name");
         std::ostringstream err;
         err << "cannot redefine `" << name << '`';
@@ -437,17 +437,13 @@ bool delta_unfold(body_t& body)
     return false;
 }
 
-bool delta_unfold(expr_t& expr)
+bool delta_reduce(expr_t& expr)
 {
-    if (auto const type = std::get_if<expr_t>(&expr.properties.sort.get()))
-        if (delta_unfold(*type))
-            return true;
-    // for boolean_expr_t, relation_expr_t,  etc, prefer primitive reduction over further unfolding
     return match(
         expr.value,
         [&] (expr_t::boolean_expr_t& x)
         {
-            bool const changed = match(
+            return match(
                 x.value,
                 [&] (expr_t::boolean_expr_t::not_t const& x)
                 {
@@ -470,11 +466,10 @@ bool delta_unfold(expr_t& expr)
                         }
                     return false;
                 });
-            return changed or impl::delta_unfold(x);
         },
         [&] (expr_t::relation_expr_t& x)
         {
-            bool const changed = match(
+            return match(
                 x.value,
                 [&] <typename T> (T const& x)
                 {
@@ -494,11 +489,10 @@ bool delta_unfold(expr_t& expr)
                         }
                     return false;
                 });
-            return changed or impl::delta_unfold(x);
         },
         [&] (expr_t::arith_expr_t& x)
         {
-            bool const changed = match(
+            return match(
                 x.value,
                 [&] <typename T> (T const& x)
                 {
@@ -518,7 +512,6 @@ bool delta_unfold(expr_t& expr)
                         }
                     return false;
                 });
-            return changed or impl::delta_unfold(x);
         },
         [&] (expr_t::addressof_t& x)
         {
@@ -528,7 +521,7 @@ bool delta_unfold(expr_t& expr)
                 changed = true;
                 destructive_self_assign(expr, std::move(deref->expr.get()));
             }
-            return changed or impl::delta_unfold(x);
+            return changed;
         },
         [&] (expr_t::deref_t& x)
         {
@@ -538,7 +531,7 @@ bool delta_unfold(expr_t& expr)
                 changed = true;
                 destructive_self_assign(expr, std::move(ref->expr.get()));
             }
-            return changed or impl::delta_unfold(x);
+            return changed;
         },
         [&] (expr_t::member_t& member)
         {
@@ -553,7 +546,7 @@ bool delta_unfold(expr_t& expr)
                                     changed = true;
                                     destructive_self_assign(expr, std::move(init_list->values[*i]));
                                 }
-            return changed or impl::delta_unfold(member);
+            return changed;
         },
         [&] (expr_t::subscript_t& subscript)
         {
@@ -566,11 +559,11 @@ bool delta_unfold(expr_t& expr)
                         auto const i_ = i->value.template convert_to<std::size_t>();
                         destructive_self_assign(expr, std::move(init_list->values[i_]));
                     }
-            return changed or impl::delta_unfold(subscript);
+            return changed;
         },
         [&] (expr_t::app_t& app)
         {
-            bool const changed = match(
+            return match(
                 is_builtin_call(app),
                 [] (is_builtin_call_result::no_t) { return false; },
                 [&] (is_builtin_call_result::slice_t const& slice)
@@ -587,9 +580,17 @@ bool delta_unfold(expr_t& expr)
                     else
                         return false;
                 });
-            return changed or impl::delta_unfold(app);
         },
-        [&] (auto& x) { return impl::delta_unfold(x); });
+        [] (auto const&) { return false; });
+}
+
+bool delta_unfold(expr_t& expr)
+{
+    if (auto const type = std::get_if<expr_t>(&expr.properties.sort.get()))
+        if (delta_unfold(*type))
+            return true;
+    // for boolean_expr_t, relation_expr_t,  etc, prefer primitive reduction over further unfolding
+    return delta_reduce(expr) or match(expr.value, [] (auto& x) { return impl::delta_unfold(x); });
 }
 
 } // namespace dep0::typecheck
@@ -205,11 +205,16 @@ dep0::expected<std::true_type> env_t::try_emplace(expr_t::global_t global, value
 
 dep0::expected<env_t> make_base_env()
 {
-    dep0::typecheck::env_t base_env;
     auto const prelude = dep0::typecheck::build_prelude_module();
     if (not prelude)
         return prelude.error();
-    if (auto const imported = base_env.import(dep0::source_text::from_literal(""), *prelude); not imported)
+    return make_base_env(*prelude);
+}
+
+dep0::expected<env_t> make_base_env(module_t const& prelude)
+{
+    dep0::typecheck::env_t base_env;
+    if (auto const imported = base_env.import(dep0::source_text::from_literal(""), prelude); not imported)
         return imported.error();
     return std::move(base_env);
 }
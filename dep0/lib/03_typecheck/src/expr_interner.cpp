@@ -0,0 +1,77 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "dep0/typecheck/expr_interner.hpp"
+
+#include "dep0/ast/alpha_equivalence.hpp"
+#include "dep0/ast/hash_code.hpp"
+
+#include <boost/hana.hpp>
+
+#include <cassert>
+#include <ranges>
+
+namespace dep0::typecheck {
+
+static bool is_equivalent(expr_t const& x, expr_t const& y)
+{
+    // TODO should this be beta-delta equivalence instead? needs a test
+    return is_alpha_equivalent(x, y).has_value()
+        and std::visit(
+            boost::hana::overload(
+                [] (expr_t const& x_type, expr_t const& y_type)
+                {
+                    return is_alpha_equivalent(x_type, y_type).has_value();
+                },
+                [] (kind_t, kind_t)
+                {
+                    return true;
+                },
+                [] <typename T, typename U> requires (not std::is_same_v<T, U>)
+                (T const&, U const&)
+                {
+                    return false;
+                }),
+            x.properties.sort.get(), y.properties.sort.get());
+}
+
+std::optional<interned_expr_t> expr_interner_t::find(expr_t const& x, std::size_t const hash) const
+{
+    auto const [begin, end] = m_ids_by_hash.equal_range(hash);
+    for (auto const& [_, id]: std::ranges::subrange(begin, end))
+        if (is_equivalent(m_exprs[id], x))
+            return interned_expr_t{id};
+    return std::nullopt;
+}
+
+interned_expr_t expr_interner_t::intern(expr_t const& x)
+{
+    auto const hash = ast::hash_code(x);
+    if (auto const id = find(x, hash))
+        return *id;
+    auto const id = m_exprs.size();
+    m_exprs.push_back(x);
+    m_ids_by_hash.emplace(hash, id);
+    return interned_expr_t{id};
+}
+
+std::optional<interned_expr_t> expr_interner_t::find(expr_t const& x) const
+{
+    return find(x, ast::hash_code(x));
+}
+
+expr_t const& expr_interner_t::operator[](interned_expr_t const x) const
+{
+    assert(x.id < m_exprs.size());
+    return m_exprs[x.id];
+}
+
+std::size_t expr_interner_t::size() const
+{
+    return m_exprs.size();
+}
+
+} // namespace dep0::typecheck
@@ -0,0 +1,218 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "private/normal_form_cache.hpp"
+
+#include "dep0/typecheck/beta_delta_reduction.hpp"
+
+#include "dep0/stats.hpp"
+#include "dep0/tracing.hpp"
+
+#include "dep0/match.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+
+namespace dep0::typecheck {
+
+static thread_local normal_form_cache_t* current_cache = nullptr;
+
+static stats_counter_t num_hits("typecheck", "normal_form_cache_hits");
+static stats_counter_t num_misses("typecheck", "normal_form_cache_misses");
+
+/** Value stored for a global symbol that was not found in the environment of the expression referring to it. */
+static constexpr auto not_found = std::numeric_limits<std::size_t>::max();
+
+static void globals_in(expr_t const&, std::vector<std::size_t>&);
+
+static void globals_in(body_t const& x, std::vector<std::size_t>& out)
+{
+    for (auto const& s: x.stmts)
+        match(
+            s.value,
+            [&] (expr_t::app_t const& x)
+            {
+                globals_in(x.func.get(), out);
+                for (auto const& arg: x.args)
+                    globals_in(arg, out);
+            },
+            [&] (stmt_t::if_else_t const& if_)
+            {
+                globals_in(if_.cond, out);
+                globals_in(if_.true_branch, out);
+                if (if_.false_branch)
+                    globals_in(*if_.false_branch, out);
+            },
+            [&] (stmt_t::return_t const& ret)
+            {
+                if (ret.expr)
+                    globals_in(*ret.expr, out);
+            },
+            [&] (stmt_t::impossible_t const& x)
+            {
+                if (x.reason)
+                    globals_in(*x.reason, out);
+            });
+}
+
+/**
+ * Append to the given vector the kind of entry, i.e. the index inside `env_t::value_type`,
+ * that each global symbol appearing in the given expression refers to,
+ * in the environment in which that occurrence was typechecked.
+ */
+static void globals_in(expr_t const& x, std::vector<std::size_t>& out)
+{
+    auto const args_in = [&] (std::vector<func_arg_t> const& args)
+    {
+        for (auto const& arg: args)
+            globals_in(arg.type, out);
+    };
+    match(
+        x.value,
+        [&] (expr_t::boolean_expr_t const& x)
+        {
+            match(
+                x.value,
+                [&] (expr_t::boolean_expr_t::not_t const& x) { globals_in(x.expr.get(), out); },
+                [&] (auto const& x)
+                {
+                    globals_in(x.lhs.get(), out);
+                    globals_in(x.rhs.get(), out);
+                });
+        },
+        [&] (expr_t::relation_expr_t const& x)
+        {
+            match(
+                x.value,
+                [&] (auto const& x)
+                {
+                    globals_in(x.lhs.get(), out);
+                    globals_in(x.rhs.get(), out);
+                });
+        },
+        [&] (expr_t::arith_expr_t const& x)
+        {
+            match(
+                x.value,
+                [&] (auto const& x)
+                {
+                    globals_in(x.lhs.get(), out);
+                    globals_in(x.rhs.get(), out);
+                });
+        },
+        [&] (expr_t::global_t const& g)
+        {
+            auto const entry = (*x.properties.derivation.properties.env)[g];
+            out.push_back(entry ? entry->index() : not_found);
+        },
+        [&] (expr_t::app_t const& x)
+        {
+            globals_in(x.func.get(), out);
+            for (auto const& arg: x.args)
+                globals_in(arg, out);
+        },
+        [&] (expr_t::abs_t const& x)
+        {
+            args_in(x.args);
+            globals_in(x.ret_type.get(), out);
+            globals_in(x.body, out);
+        },
+        [&] (expr_t::pi_t const& x)
+        {
+            args_in(x.args);
+            globals_in(x.ret_type.get(), out);
+        },
+        [&] (expr_t::sigma_t const& x) { args_in(x.args); },
+        [&] (expr_t::addressof_t const& x) { globals_in(x.expr.get(), out); },
+        [&] (expr_t::deref_t const& x) { globals_in(x.expr.get(), out); },
+        [&] (expr_t::scopeof_t const& x) { globals_in(x.expr.get(), out); },
+        [&] (expr_t::init_list_t const& x)
+        {
+            for (auto const& v: x.values)
+                globals_in(v, out);
+        },
+        [&] (expr_t::member_t const& x) { globals_in(x.object.get(), out); },
+        [&] (expr_t::subscript_t const& x)
+        {
+            globals_in(x.object.get(), out);
+            globals_in(x.index.get(), out);
+        },
+        [&] (expr_t::because_t const& x)
+        {
+            globals_in(x.value.get(), out);
+            globals_in(x.reason.get(), out);
+        },
+        [] (auto const&) { });
+}
+
+normal_form_cache_t::normal_form_cache_t() :
+    m_previous(current_cache)
+{
+    current_cache = this;
+}
+
+normal_form_cache_t::~normal_form_cache_t()
+{
+    current_cache = m_previous;
+}
+
+normal_form_cache_t* normal_form_cache_t::current()
+{
+    return current_cache;
+}
+
+normal_form_cache_t::entry_t const*
+normal_form_cache_t::find(interned_expr_t const id, std::vector<std::size_t> const& globals) const
+{
+    auto const it = m_entries_by_expr.find(id);
+    if (it == m_entries_by_expr.end())
+        return nullptr;
+    // equivalent expressions contain the same global symbols in the same order, so comparing kinds is enough
+    for (auto const i: it->second)
+        if (m_entries[i].globals == globals)
+            return &m_entries[i];
+    return nullptr;
+}
+
+normal_form_cache_t::normal_form_t const& normal_form_cache_t::normalize(expr_t const& x)
+{
+    std::vector<std::size_t> globals;
+    globals_in(x, globals);
+    auto lock = std::unique_lock(m_mutex);
+    auto const id = m_exprs.intern(x);
+    if (auto const entry = find(id, globals))
+    {
+        num_hits.add();
+        TRACE_COUNTER(TRACE_TYPECHECKING, "normal_form_cache_hits", ++m_hits);
+        return entry->normal_form;
+    }
+    lock.unlock();
+    auto normal_form = normal_form_t{x, false};
+    normal_form.changed = beta_delta_normalize(normal_form.expr);
+    lock.lock();
+    num_misses.add();
+    TRACE_COUNTER(TRACE_TYPECHECKING, "normal_form_cache_misses", ++m_misses);
+    // another thread might have stored an equivalent normal form in the meantime, in which case that one is kept
+    if (auto const entry = find(id, globals))
+        return entry->normal_form;
+    auto& entry = m_entries.emplace_back(entry_t{std::move(globals), std::move(normal_form)});
+    m_entries_by_expr[id].push_back(m_entries.size() - 1ul);
+    return entry.normal_form;
+}
+
+normal_form_cache_scope_t::normal_form_cache_scope_t(normal_form_cache_t* const cache) :
+    m_previous(current_cache)
+{
+    current_cache = cache;
+}
+
+normal_form_cache_scope_t::~normal_form_cache_scope_t()
+{
+    current_cache = m_previous;
+}
+
+} // namespace dep0::typecheck
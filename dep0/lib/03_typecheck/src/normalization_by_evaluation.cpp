@@ -0,0 +1,352 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "private/normalization_by_evaluation.hpp"
+
+#include "private/beta_reduction.hpp"
+#include "private/delta_unfold.hpp"
+#include "private/drop_unreachable_stmts.hpp"
+#include "private/normalization_stats.hpp"
+
+#include "dep0/typecheck/is_mutable.hpp"
+
+#include "dep0/ast/occurs_in.hpp"
+#include "dep0/ast/rename.hpp"
+
+#include "dep0/destructive_self_assign.hpp"
+#include "dep0/match.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <optional>
+#include <ranges>
+#include <vector>
+
+namespace dep0::typecheck {
+
+namespace impl {
+
+/**
+ * Binds a variable to the normal form of the argument passed for it, if any.
+ * A binding without value is introduced by a function argument that is not being applied, for example inside
+ * a Pi-Type; it shadows any outer binding of the same variable, which must then be left as it is.
+ */
+struct binding_t
+{
+    expr_t::var_t var;
+    std::optional<expr_t> value;
+};
+
+/**
+ * The environment under which expressions are evaluated; the innermost binding of each variable comes last.
+ *
+ * The values stored here are already in normal form and their free variables refer to the scope in which
+ * the result of the evaluation is being built, not to this environment; so a value is never evaluated again
+ * after being looked up, which is what allows the evaluation to proceed in a single pass.
+ */
+using bindings_t = std::vector<binding_t>;
+
+static bool eval(bindings_t&, body_t&);
+static bool eval(bindings_t&, stmt_t&);
+static bool eval(bindings_t&, expr_t&);
+
+static bool eval(bindings_t&, expr_t::typename_t&) { return false; }
+static bool eval(bindings_t&, expr_t::true_t&) { return false; }
+static bool eval(bindings_t&, expr_t::auto_t&) { return false; }
+static bool eval(bindings_t&, expr_t::bool_t&) { return false; }
+static bool eval(bindings_t&, expr_t::cstr_t&) { return false; }
+static bool eval(bindings_t&, expr_t::unit_t&) { return false; }
+static bool eval(bindings_t&, expr_t::i8_t&) { return false; }
+static bool eval(bindings_t&, expr_t::i16_t&) { return false; }
+static bool eval(bindings_t&, expr_t::i32_t&) { return false; }
+static bool eval(bindings_t&, expr_t::i64_t&) { return false; }
+static bool eval(bindings_t&, expr_t::u8_t&) { return false; }
+static bool eval(bindings_t&, expr_t::u16_t&) { return false; }
+static bool eval(bindings_t&, expr_t::u32_t&) { return false; }
+static bool eval(bindings_t&, expr_t::u64_t&) { return false; }
+static bool eval(bindings_t&, expr_t::boolean_constant_t&) { return false; }
+static bool eval(bindings_t&, expr_t::numeric_constant_t&) { return false; }
+static bool eval(bindings_t&, expr_t::string_literal_t&) { return false; }
+static bool eval(bindings_t&, expr_t::boolean_expr_t&);
+static bool eval(bindings_t&, expr_t::relation_expr_t&);
+static bool eval(bindings_t&, expr_t::arith_expr_t&);
+static bool eval(bindings_t&, expr_t::var_t&) { return false; } // bound variables are replaced by `eval(expr_t&)`
+static bool eval(bindings_t&, expr_t::global_t&) { return false; }
+static bool eval(bindings_t&, expr_t::app_t&);
+static bool eval(bindings_t&, expr_t::abs_t&);
+static bool eval(bindings_t&, expr_t::pi_t&);
+static bool eval(bindings_t&, expr_t::sigma_t&);
+static bool eval(bindings_t&, expr_t::ref_t&) { return false; }
+static bool eval(bindings_t&, expr_t::scope_t&) { return false; }
+static bool eval(bindings_t& bindings, expr_t::addressof_t& x) { return eval(bindings, x.expr.get()); }
+static bool eval(bindings_t& bindings, expr_t::deref_t& x) { return eval(bindings, x.expr.get()); }
+static bool eval(bindings_t& bindings, expr_t::scopeof_t& x) { return eval(bindings, x.expr.get()); }
+static bool eval(bindings_t&, expr_t::array_t&) { return false; }
+static bool eval(bindings_t&, expr_t::init_list_t&);
+static bool eval(bindings_t&, expr_t::member_t&);
+static bool eval(bindings_t&, expr_t::subscript_t&);
+static bool eval(bindings_t&, expr_t::because_t&);
+
+/** Return the value bound to the given variable, or `nullptr` if it is unbound or shadowed. */
+static expr_t const* lookup(bindings_t const& bindings, expr_t::var_t const& var)
+{
+    auto const innermost = bindings | std::views::reverse;
+    auto const it = std::ranges::find(innermost, var, &binding_t::var);
+    return it != innermost.end() and it->value ? &*it->value : nullptr;
+}
+
+/** Return true if the given variable appears anywhere inside any value, so binding it would capture that value. */
+static bool captures(bindings_t const& bindings, expr_t::var_t const& var)
+{
+    return std::ranges::any_of(
+        bindings,
+        [&] (binding_t const& b)
+        {
+            return b.value and ast::occurs_in(var, *b.value, ast::occurrence_style::anywhere);
+        });
+}
+
+/**
+ * Evaluate, in order, the given function arguments and then the return type and the body, if any.
+ * Each argument shadows any outer binding of the same variable and,
+ * if its variable appears in some value that might be looked up from within its scope, it is renamed first;
+ * this is the same capture-avoidance that `substitute()` performs.
+ */
+static bool eval(bindings_t& bindings, std::vector<func_arg_t>& args, expr_t* const ret_type, body_t* const body)
+{
+    auto const outer_size = bindings.size();
+    bool changed = false;
+    for (auto it = args.begin(); it != args.end(); ++it)
+    {
+        changed |= eval(bindings, it->type);
+        if (not it->var)
+            continue;
+        // renaming picks a fresh index for the scope of the argument but not necessarily for the values
+        while (captures(bindings, *it->var))
+            it->var = ret_type
+                ? ast::rename(*it->var, std::next(it), args.end(), *ret_type, body)
+                : ast::rename<properties_t>(*it->var, std::next(it), args.end());
+        bindings.push_back(binding_t{*it->var, std::nullopt});
+    }
+    if (ret_type)
+        changed |= eval(bindings, *ret_type);
+    if (body)
+        changed |= eval(bindings, *body);
+    bindings.erase(bindings.begin() + outer_size, bindings.end());
+    return changed;
+}
+
+/**
+ * Apply the Lambda-Abstraction in function position to the arguments of the given application,
+ * which must already be in normal form, by evaluating its return type and body
+ * under the given environment extended with one binding for each argument.
+ * The return type of its Pi-Type is evaluated in the same way, binding the arguments of the Pi-Type instead,
+ * because their names need not be the same as those of the abstraction.
+ * Afterwards, like in `beta_normalize()`, there are no arguments left, neither in the application
+ * nor in the abstraction nor in its type.
+ */
+static void apply(bindings_t& bindings, expr_t::app_t& app)
+{
+    auto& abs = std::get<expr_t::abs_t>(app.func.get().value);
+    auto& pi = std::get<expr_t::pi_t>(std::get<expr_t>(app.func.get().properties.sort.get()).value);
+    assert(abs.args.size() == app.args.size()); // always true for legal terms
+    assert(pi.args.size() == app.args.size()); // always true for legal terms
+    auto const outer_size = bindings.size();
+    // the arguments are still needed for the abstraction, so here they can only be copied, and only if used
+    for (auto const i: std::views::iota(0ul, pi.args.size()))
+        if (auto const& arg = pi.args[i];
+            arg.var and ast::occurs_in(*arg.var, pi.ret_type.get(), ast::occurrence_style::free))
+            bindings.push_back(binding_t{*arg.var, app.args[i]});
+    if (bindings.size() > outer_size)
+    {
+        eval(bindings, pi.ret_type.get());
+        bindings.erase(bindings.begin() + outer_size, bindings.end());
+    }
+    for (auto const i: std::views::iota(0ul, abs.args.size()))
+        if (auto const& arg = abs.args[i]; arg.var)
+            bindings.push_back(binding_t{*arg.var, std::move(app.args[i])});
+    eval(bindings, abs.ret_type.get());
+    eval(bindings, abs.body);
+    bindings.erase(bindings.begin() + outer_size, bindings.end());
+    pi.args.clear();
+    app.args.clear();
+    abs.args.clear();
+    num_beta_steps.add();
+}
+
+bool eval(bindings_t& bindings, body_t& body)
+{
+    // same two passes as `beta_normalize()`, except that each statement only needs to be evaluated once
+    bool changed = drop_unreachable_stmts(body);
+    for (auto& s: body.stmts)
+        changed |= eval(bindings, s);
+    changed |= simplify_normalized_stmts(body);
+    return changed;
+}
+
+bool eval(bindings_t& bindings, stmt_t& stmt)
+{
+    return match(
+        stmt.value,
+        [&] (expr_t::app_t& app) { return eval(bindings, app); },
+        [&] (stmt_t::if_else_t& if_)
+        {
+            bool changed = eval(bindings, if_.cond);
+            changed |= eval(bindings, if_.true_branch);
+            if (if_.false_branch)
+                changed |= eval(bindings, *if_.false_branch);
+            return changed;
+        },
+        [&] (stmt_t::return_t& ret) { return ret.expr and eval(bindings, *ret.expr); },
+        [&] (stmt_t::impossible_t& x) { return x.reason and eval(bindings, *x.reason); });
+}
+
+bool eval(bindings_t& bindings, expr_t::boolean_expr_t& x)
+{
+    return match(
+        x.value,
+        [&] (expr_t::boolean_expr_t::not_t& x) { return eval(bindings, x.expr.get()); },
+        [&] (auto& x) -> bool { return eval(bindings, x.lhs.get()) | eval(bindings, x.rhs.get()); });
+}
+
+bool eval(bindings_t& bindings, expr_t::relation_expr_t& x)
+{
+    return match(x.value, [&] (auto& x) -> bool { return eval(bindings, x.lhs.get()) | eval(bindings, x.rhs.get()); });
+}
+
+bool eval(bindings_t& bindings, expr_t::arith_expr_t& x)
+{
+    return match(x.value, [&] (auto& x) -> bool { return eval(bindings, x.lhs.get()) | eval(bindings, x.rhs.get()); });
+}
+
+bool eval(bindings_t& bindings, expr_t::app_t& app)
+{
+    bool changed = false;
+    for (auto& arg: app.args)
+        changed |= eval(bindings, arg);
+    if (std::ranges::any_of(app.args, [] (expr_t const& arg) { return is_mutable(arg); }))
+        // mutable arguments cannot be pushed inside the body, see `beta_normalize()`
+        return eval(bindings, app.func.get()) or changed;
+    // The body of a Lambda-Abstraction is only evaluated after its arguments have been bound;
+    // its free variables refer to the current environment, so that is the one to extend.
+    if (auto const abs = std::get_if<expr_t::abs_t>(&app.func.get().value); abs and abs->args.size() > 0ul)
+    {
+        if (auto const type = std::get_if<expr_t>(&app.func.get().properties.sort.get()))
+            eval(bindings, *type);
+        apply(bindings, app);
+        return true;
+    }
+    changed |= eval(bindings, app.func.get());
+    // From here on the function is in normal form, so its free variables do not refer to the current environment
+    // and, if it is applied, its body must be evaluated in a new environment.
+    // Global functions are unfolded under the same conditions as in `delta_unfold()`;
+    // note that they must be looked up in the environment where the function was defined, not where it is applied.
+    if (auto const global = std::get_if<expr_t::global_t>(&app.func.get().value))
+    {
+        if (is_mutable(app))
+            return changed;
+        auto const& env = *app.func.get().properties.derivation.properties.env;
+        auto const func_def = std::get_if<func_def_t>(env[*global]);
+        if (not func_def)
+            return changed;
+        app.func.get().value = func_def->value;
+        num_delta_steps.add();
+    }
+    else if (auto const abs = std::get_if<expr_t::abs_t>(&app.func.get().value); not abs or abs->args.empty())
+        return changed;
+    bindings_t closed;
+    apply(closed, app);
+    return true;
+}
+
+bool eval(bindings_t& bindings, expr_t::abs_t& abs)
+{
+    return eval(bindings, abs.args, &abs.ret_type.get(), &abs.body);
+}
+
+bool eval(bindings_t& bindings, expr_t::pi_t& pi)
+{
+    return eval(bindings, pi.args, &pi.ret_type.get(), nullptr);
+}
+
+bool eval(bindings_t& bindings, expr_t::sigma_t& sigma)
+{
+    return eval(bindings, sigma.args, nullptr, nullptr);
+}
+
+bool eval(bindings_t& bindings, expr_t::init_list_t& init_list)
+{
+    bool changed = false;
+    for (auto& v: init_list.values)
+        changed |= eval(bindings, v);
+    return changed;
+}
+
+bool eval(bindings_t& bindings, expr_t::member_t& x)
+{
+    return eval(bindings, x.object.get());
+}
+
+bool eval(bindings_t& bindings, expr_t::subscript_t& x)
+{
+    return eval(bindings, x.object.get()) | eval(bindings, x.index.get());
+}
+
+bool eval(bindings_t& bindings, expr_t::because_t& x)
+{
+    return eval(bindings, x.value.get()) | eval(bindings, x.reason.get());
+}
+
+bool eval(bindings_t& bindings, expr_t& expr)
+{
+    if (auto const var = std::get_if<expr_t::var_t>(&expr.value))
+        if (auto const value = lookup(bindings, *var))
+        {
+            // the value is already in normal form, including its type, so there is nothing else to do
+            expr = *value;
+            return true;
+        }
+    bool changed = false;
+    if (auto const type = std::get_if<expr_t>(&expr.properties.sort.get()))
+        changed |= eval(bindings, *type);
+    match(
+        expr.value,
+        [&] (expr_t::app_t& app)
+        {
+            changed |= eval(bindings, app);
+            // if this reduced to a parameterless single return statement, we can extract the returned expression
+            if (app.args.empty())
+                if (auto* const abs = std::get_if<expr_t::abs_t>(&app.func.get().value))
+                    if (abs->body.stmts.size() == 1ul)
+                        if (auto* const ret = std::get_if<stmt_t::return_t>(&abs->body.stmts[0].value))
+                            if (ret->expr)
+                            {
+                                changed = true;
+                                destructive_self_assign(expr, std::move(*ret->expr));
+                            }
+        },
+        [&] (auto& x) { changed |= eval(bindings, x); });
+    // all sub-expressions are now in normal form, so primitive reductions can only happen at the root
+    while (delta_reduce(expr))
+        changed = true;
+    return changed;
+}
+
+} // namespace impl
+
+bool normalize_by_evaluation(body_t& body)
+{
+    impl::bindings_t bindings;
+    return impl::eval(bindings, body);
+}
+
+bool normalize_by_evaluation(expr_t& expr)
+{
+    impl::bindings_t bindings;
+    return impl::eval(bindings, expr);
+}
+
+} // namespace dep0::typecheck
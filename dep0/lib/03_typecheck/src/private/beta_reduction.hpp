@@ -30,4 +30,13 @@ bool beta_normalize(body_t&);
  */
 bool beta_normalize(expr_t&);
 
+/**
+ * @brief Drop unnecessary statements, like immutable function calls or dead branches,
+ * from a body whose statements are already in normal form.
+ * This is the last step of `beta_normalize(body_t&)`.
+ * @return true if any branch was dropped or lifted.
+ * @see @ref beta_reduction
+ */
+bool simplify_normalized_stmts(body_t&);
+
 } // namespace dep0::typecheck
@@ -6,7 +6,7 @@
  */
 /**
  * @file
- * @brief Declares `dep0::typecheck::delta_unfold()` and associated overloads.
+ * @brief Declares `dep0::typecheck::delta_unfold()`, `dep0::typecheck::delta_reduce()` and associated overloads.
  * @see @ref delta_reduction
  */
 #pragma once
@@ -31,4 +31,12 @@ bool delta_unfold(body_t&);
  */
 bool delta_unfold(expr_t&);
 
+/**
+ * @brief Try to perform one primitive reduction at the root of the given expression, without looking any deeper;
+ * for example `1 + 2` or `{x, y}[0]`, but not `f(1 + 2)`.
+ * @return True if the expression was reduced.
+ * @see @ref delta_reduction
+ */
+bool delta_reduce(expr_t&);
+
 } // namespace dep0::typecheck
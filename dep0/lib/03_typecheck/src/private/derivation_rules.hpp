@@ -205,6 +205,20 @@ expr_t make_legal_expr(env_t const& env, ctx_t const& ctx, sort_t sort, Args&&..
     };
 }
 
+/**
+ * @brief Overload of `make_legal_expr()` that shares existing references to an environment and a context,
+ * for example when loading expressions that were already typechecked and later serialized.
+ */
+template <typename... Args>
+expr_t make_legal_expr(env_ref_t env, ctx_ref_t ctx, sort_t sort, Args&&... args)
+{
+    return expr_t{
+        derivation_rules::make_derivation<expr_t>(std::move(env), std::move(ctx)),
+        std::move(sort),
+        std::forward<Args>(args)...
+    };
+}
+
 template <typename T, typename... Args>
 derivation_t<T> derivation_rules::make_derivation(Args&&... args)
 {
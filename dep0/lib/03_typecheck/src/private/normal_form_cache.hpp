@@ -0,0 +1,108 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Declares `dep0::typecheck::normal_form_cache_t`.
+ */
+#pragma once
+
+#include "dep0/typecheck/ast.hpp"
+#include "dep0/typecheck/expr_interner.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace dep0::typecheck {
+
+/**
+ * @brief Remembers the beta-delta normal form of all expressions normalized by `is_beta_delta_equivalent()`
+ * whilst typechecking a module, so that each distinct expression is normalized at most once,
+ * for example an array size like `n - 1` that appears in many types.
+ *
+ * The normal form of an expression does not only depend on the expression itself
+ * but also on the environment in which each of its global symbols was typechecked;
+ * for example `f(1)` can be delta-unfolded only if `f` was already defined, not merely declared.
+ * Within a module, the only way in which a global symbol can change is from a declaration to a definition;
+ * so each normal form is stored together with the kind of entry that each global symbol referred to,
+ * and it is reused for an equivalent expression only if all its global symbols refer to the same kind of entries.
+ *
+ * Whilst an object of this type is alive, it is used by all equivalence checks performed from the same thread,
+ * after which the previous one, if any, is restored; other threads can use it via `normal_form_cache_scope_t`.
+ *
+ * @remarks This class is thread-safe, so that all workers of a parallel Proof Search can share the same cache.
+ */
+class normal_form_cache_t
+{
+public:
+    /** @brief The result of normalizing an expression. */
+    struct normal_form_t
+    {
+        expr_t expr;
+        bool changed; /**< Whether `expr` is different from the original expression. */
+    };
+
+private:
+    struct entry_t
+    {
+        std::vector<std::size_t> globals; /**< The kind of entry referred to by each global symbol, in order. */
+        normal_form_t normal_form;
+    };
+
+    normal_form_cache_t* const m_previous;
+    std::mutex m_mutex; // guards all the following containers
+    expr_interner_t m_exprs;
+    std::unordered_map<interned_expr_t, std::vector<std::size_t>> m_entries_by_expr; // indices into `m_entries`
+    std::deque<entry_t> m_entries; // deque, so references returned by `normalize()` are never invalidated
+    std::atomic<std::size_t> m_hits = 0ul;
+    std::atomic<std::size_t> m_misses = 0ul;
+
+    entry_t const* find(interned_expr_t, std::vector<std::size_t> const& globals) const;
+
+public:
+    normal_form_cache_t();
+    normal_form_cache_t(normal_form_cache_t const&) = delete;
+    normal_form_cache_t& operator=(normal_form_cache_t const&) = delete;
+    ~normal_form_cache_t();
+
+    /** @return The cache currently active in the calling thread, if any. */
+    static normal_form_cache_t* current();
+
+    /**
+     * @brief Return the beta-delta normal form of the given expression, normalizing a copy of it only if
+     * the normal form of an equivalent expression, typechecked in a compatible environment, was not found.
+     *
+     * The returned expression might use different names for bound variables than the given one,
+     * so it is only suitable to be compared up to alpha-equivalence.
+     * Either way, the hit or miss is recorded and reported to the trace.
+     * Normalization happens without holding any lock, so many threads can normalize different expressions at once.
+     */
+    normal_form_t const& normalize(expr_t const&);
+
+    std::size_t hits() const { return m_hits; } /**< @brief Number of times that `normalize()` found a result. */
+    std::size_t misses() const { return m_misses; } /**< @brief Number of times that it did not. */
+};
+
+/**
+ * @brief Whilst an object of this type is alive, the given cache, if any, is used by all equivalence checks
+ * performed from the calling thread, after which the previous one, if any, is restored.
+ */
+class normal_form_cache_scope_t
+{
+    normal_form_cache_t* const m_previous;
+
+public:
+    explicit normal_form_cache_scope_t(normal_form_cache_t*);
+    normal_form_cache_scope_t(normal_form_cache_scope_t const&) = delete;
+    normal_form_cache_scope_t& operator=(normal_form_cache_scope_t const&) = delete;
+    ~normal_form_cache_scope_t();
+};
+
+} // namespace dep0::typecheck
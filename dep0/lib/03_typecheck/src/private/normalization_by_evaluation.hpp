@@ -0,0 +1,36 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Declares `dep0::typecheck::normalize_by_evaluation()` and associated overloads.
+ * @see @ref beta_delta_reduction
+ */
+#pragma once
+
+#include "dep0/typecheck/ast.hpp"
+
+namespace dep0::typecheck {
+
+/**
+ * @brief Perform a combined beta-delta normalization of the given body, in a single pass, by evaluating it.
+ *
+ * Instead of substituting the arguments of a function application inside the body of the function,
+ * and then normalizing the result again, the body is evaluated only once under an environment that binds
+ * each argument to its normal form; every variable bound in the environment is then replaced by its value
+ * as soon as it is reached, and so are delta-unfolding and primitive reductions, like `1 + 2`.
+ * The result is expected to be alpha-equivalent to the one obtained by alternating
+ * `beta_normalize()` and `delta_unfold()` until neither of them can make any further progress.
+ *
+ * @return True if the body was changed.
+ * @see @ref beta_delta_reduction
+ */
+bool normalize_by_evaluation(body_t&);
+
+/** @brief Overload of `normalize_by_evaluation()` for expressions, including their types. */
+bool normalize_by_evaluation(expr_t&);
+
+} // namespace dep0::typecheck
@@ -0,0 +1,23 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Declares the statistics updated by both normalizers, see `dep0::typecheck::normalizer_t`.
+ */
+#pragma once
+
+#include "dep0/stats.hpp"
+
+namespace dep0::typecheck {
+
+/** @brief Number of function applications reduced, by substitution or by evaluation. */
+extern stats_counter_t num_beta_steps;
+
+/** @brief Number of function definitions unfolded. */
+extern stats_counter_t num_delta_steps;
+
+} // namespace dep0::typecheck
@@ -0,0 +1,91 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Internal machinery to collect a `dep0::typecheck::func_profile_t`.
+ */
+#pragma once
+
+#include "dep0/typecheck/profile.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace dep0::typecheck {
+
+/** @brief Counters of the function definition being checked, which Proof Search may update from many threads. */
+struct func_profile_counters_t
+{
+    std::atomic<std::size_t> proof_search_goals = 0ul;
+    std::atomic<std::size_t> proof_search_tasks = 0ul;
+    std::atomic<std::int64_t> proof_search_time = 0; /**< In nanoseconds. */
+    std::atomic<std::size_t> normalizations = 0ul;
+    std::atomic<std::int64_t> normalization_time = 0; /**< In nanoseconds. */
+
+    /** @brief Copy the current value of all counters into the given profile. */
+    void copy_to(func_profile_t&) const;
+};
+
+/** @brief How many timers of each kind, indexed by `profile_timer_kind_t`, are running on a thread. */
+using running_profile_timers_t = std::array<std::size_t, 2ul>;
+
+/**
+ * @brief Whilst an object of this type is alive, the given counters, if any, are updated by all work performed
+ * by the calling thread, after which the previous ones, if any, are restored.
+ *
+ * A thread working on behalf of another one must also pass the timers running on that thread,
+ * so that it does not measure again the time already being measured there.
+ */
+class func_profile_scope_t
+{
+    func_profile_counters_t* const m_previous;
+    running_profile_timers_t const m_previous_timers;
+
+public:
+    explicit func_profile_scope_t(func_profile_counters_t*, running_profile_timers_t = {});
+    func_profile_scope_t(func_profile_scope_t const&) = delete;
+    func_profile_scope_t& operator=(func_profile_scope_t const&) = delete;
+    ~func_profile_scope_t();
+};
+
+/** @return The counters currently active in the calling thread, or `nullptr` if nothing is being profiled. */
+func_profile_counters_t* current_func_profile();
+
+/** @return The timers currently running on the calling thread. */
+running_profile_timers_t running_profile_timers();
+
+/** @brief Which time of `func_profile_counters_t` a `profile_timer_t` adds to, also used as index of timers. */
+enum class profile_timer_kind_t
+{
+    proof_search,
+    normalization
+};
+
+/**
+ * @brief Adds the time elapsed between its construction and destruction to the counters currently active, if any.
+ *
+ * Only the outermost timer of each kind on the calling thread measures anything,
+ * so that recursive searches or normalizations are not counted twice;
+ * this includes timers running on the thread on whose behalf the calling thread is working, if any.
+ */
+class profile_timer_t
+{
+    func_profile_counters_t* const m_counters;
+    profile_timer_kind_t const m_kind;
+    bool const m_outermost;
+    std::chrono::steady_clock::time_point m_start;
+
+public:
+    explicit profile_timer_t(profile_timer_kind_t);
+    profile_timer_t(profile_timer_t const&) = delete;
+    profile_timer_t& operator=(profile_timer_t const&) = delete;
+    ~profile_timer_t();
+};
+
+} // namespace dep0::typecheck
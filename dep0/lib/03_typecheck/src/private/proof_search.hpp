@@ -11,8 +11,10 @@
 #pragma once
 
 #include "dep0/typecheck/ast.hpp"
+#include "dep0/typecheck/check.hpp"
 #include "dep0/typecheck/context.hpp"
 #include "dep0/typecheck/environment.hpp"
+#include "dep0/typecheck/expr_interner.hpp"
 
 #include "private/usage.hpp"
 
@@ -131,6 +133,7 @@ public:
     env_t const& env;
     ctx_t const& ctx;
     std::shared_ptr<expr_t const> const target; // TODO use some `shared_ref` since can never be nullptr or `type_t`
+    interned_expr_t const target_id; /**< @brief Unique ID of `target`, shared by all tasks with equivalent targets. */
     ast::is_mutable_t const is_mutable_allowed;
     ast::qty_t const usage_multiplier;
     std::shared_ptr<usage_t> usage;
@@ -147,6 +150,8 @@ public:
         ast::qty_t usage_multiplier,
         std::function<void(search_task_t&)>);
 
+    ~search_task_t();
+
     static std::shared_ptr<search_task_t> create(
         std::string name,
         std::weak_ptr<search_task_t> parent,
@@ -211,9 +216,29 @@ public:
     void when_any(std::vector<std::shared_ptr<search_task_t>>);
 };
 
+/**
+ * @brief RAII object that sets the budget of all searches started by `search_proof()` in the calling thread,
+ * until it is destroyed; after that, the previous budget is restored.
+ *
+ * Without any active scope, searches use a default-constructed `proof_search_budget_t`.
+ */
+class proof_search_budget_scope_t
+{
+    proof_search_budget_t const m_budget;
+    proof_search_budget_t const* const m_previous;
+
+public:
+    explicit proof_search_budget_scope_t(proof_search_budget_t);
+    proof_search_budget_scope_t(proof_search_budget_scope_t const&) = delete;
+    proof_search_budget_scope_t& operator=(proof_search_budget_scope_t const&) = delete;
+    ~proof_search_budget_scope_t();
+};
+
 /**
  * @brief Starts a brand new search for a value of the given type in the given environment and context.
  *
+ * The search is bounded by the budget of the current `proof_search_budget_scope_t`.
+ *
  * If none can be found, returns an empty optional.
  *
  * A term is only viable if its use does not exceed what is allowed by the context.
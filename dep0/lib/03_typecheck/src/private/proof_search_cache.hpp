@@ -0,0 +1,93 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Declares `dep0::typecheck::proof_search_cache_t`.
+ */
+#pragma once
+
+#include "dep0/typecheck/ast.hpp"
+#include "dep0/typecheck/context.hpp"
+#include "dep0/typecheck/expr_interner.hpp"
+
+#include "private/usage.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dep0::typecheck {
+
+/**
+ * @brief Remembers the result of all successful proof searches performed whilst typechecking a module,
+ * so that the same goal does not need to be searched again, for example at every call site of a function
+ * that takes the same `auto` argument.
+ *
+ * Each result is stored together with the context variables that occur free in it, and their types.
+ * A result can be reused in a different context only if all those variables are also declared there,
+ * with the same types, because then it is guaranteed to have the same type in the new context.
+ * Hypotheses `true_t(cond)` are stored too, even if they do not occur in the result,
+ * because a proof of `true_t(cond)` can be just `{}` when the context already contains such a hypothesis.
+ *
+ * A result found by an erased search might apply axioms, so it can only be reused by another erased search.
+ *
+ * Whilst an object of this type is alive, it is used by all searches started from the same thread,
+ * after which the previous one, if any, is restored.
+ */
+class proof_search_cache_t
+{
+    struct entry_t
+    {
+        expr_t result;
+        ast::is_mutable_t is_mutable_allowed; /**< Whether `result` might use mutable functions. */
+        bool erased; /**< Whether `result` was found with a usage multiplier of zero, so it might apply axioms. */
+        std::vector<std::pair<expr_t::var_t, expr_t>> free_vars; /**< Including all `true_t` hypotheses. */
+    };
+
+    proof_search_cache_t* const m_previous;
+    expr_interner_t m_targets;
+    std::unordered_map<interned_expr_t, std::vector<entry_t>> m_entries;
+    std::size_t m_hits = 0ul;
+    std::size_t m_misses = 0ul;
+
+public:
+    proof_search_cache_t();
+    proof_search_cache_t(proof_search_cache_t const&) = delete;
+    proof_search_cache_t& operator=(proof_search_cache_t const&) = delete;
+    ~proof_search_cache_t();
+
+    /** @return The cache currently active in the calling thread, if any. */
+    static proof_search_cache_t* current();
+
+    /**
+     * @brief Look for a previous result that can be used in the given context for the given target type.
+     *
+     * If one is found, its usage is added to the given usage object, as if it had been found by a new search.
+     * Either way, the hit or miss is recorded and reported to the trace.
+     */
+    std::optional<expr_t> try_reuse(
+        ctx_t const&,
+        expr_t const& target,
+        ast::is_mutable_t is_mutable_allowed,
+        usage_t&,
+        ast::qty_t usage_multiplier);
+
+    /** @brief Store a new result that was found in the given context for the given target type. */
+    void store(
+        ctx_t const&,
+        expr_t const& target,
+        ast::is_mutable_t is_mutable_allowed,
+        ast::qty_t usage_multiplier,
+        expr_t const& result);
+
+    std::size_t hits() const { return m_hits; } /**< @brief Number of times that `try_reuse()` found a result. */
+    std::size_t misses() const { return m_misses; } /**< @brief Number of times that it did not. */
+};
+
+} // namespace dep0::typecheck
@@ -17,7 +17,11 @@
 #include "private/proof_search.hpp"
 #include "private/usage.hpp"
 
+#include <functional>
 #include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace dep0::typecheck {
 
@@ -29,4 +33,13 @@ namespace dep0::typecheck {
  */
 void search_app(search_task_t&);
 
+/**
+ * @brief Return the alternative tactics that `search_app()` would try for the given target, in the same order.
+ *
+ * There is one alternative for each axiom or function in the environment that could return a value of the target type,
+ * each paired with the name of that axiom or function.
+ */
+std::vector<std::pair<std::string, std::function<void(search_task_t&)>>>
+search_app_alternatives(env_t const&, expr_t const& target, ast::is_mutable_t is_mutable_allowed, ast::qty_t);
+
 } // namespace dep0::typecheck
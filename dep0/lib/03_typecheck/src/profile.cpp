@@ -0,0 +1,74 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "private/profile.hpp"
+
+namespace dep0::typecheck {
+
+static thread_local func_profile_counters_t* current_counters = nullptr;
+static thread_local running_profile_timers_t running_timers{};
+
+void func_profile_counters_t::copy_to(func_profile_t& profile) const
+{
+    profile.proof_search_goals = proof_search_goals.load(std::memory_order_relaxed);
+    profile.proof_search_tasks = proof_search_tasks.load(std::memory_order_relaxed);
+    profile.proof_search_time = std::chrono::nanoseconds(proof_search_time.load(std::memory_order_relaxed));
+    profile.normalizations = normalizations.load(std::memory_order_relaxed);
+    profile.normalization_time = std::chrono::nanoseconds(normalization_time.load(std::memory_order_relaxed));
+}
+
+func_profile_scope_t::func_profile_scope_t(
+    func_profile_counters_t* const counters,
+    running_profile_timers_t const timers
+) :
+    m_previous(current_counters),
+    m_previous_timers(running_timers)
+{
+    current_counters = counters;
+    running_timers = timers;
+}
+
+func_profile_scope_t::~func_profile_scope_t()
+{
+    current_counters = m_previous;
+    running_timers = m_previous_timers;
+}
+
+func_profile_counters_t* current_func_profile()
+{
+    return current_counters;
+}
+
+running_profile_timers_t running_profile_timers()
+{
+    return running_timers;
+}
+
+profile_timer_t::profile_timer_t(profile_timer_kind_t const kind) :
+    m_counters(current_counters),
+    m_kind(kind),
+    m_outermost(m_counters and running_timers[static_cast<std::size_t>(kind)]++ == 0ul)
+{
+    if (m_outermost)
+        m_start = std::chrono::steady_clock::now();
+}
+
+profile_timer_t::~profile_timer_t()
+{
+    if (not m_counters)
+        return;
+    --running_timers[static_cast<std::size_t>(m_kind)];
+    if (not m_outermost)
+        return;
+    auto const elapsed = std::chrono::nanoseconds(std::chrono::steady_clock::now() - m_start).count();
+    auto& total =
+        m_kind == profile_timer_kind_t::proof_search
+        ? m_counters->proof_search_time
+        : m_counters->normalization_time;
+    total.fetch_add(elapsed, std::memory_order_relaxed);
+}
+
+} // namespace dep0::typecheck
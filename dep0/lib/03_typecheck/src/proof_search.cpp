@@ -6,42 +6,113 @@
  */
 #include "private/proof_search.hpp"
 
+#include "private/normal_form_cache.hpp"
+#include "private/profile.hpp"
+#include "private/proof_search_cache.hpp"
 #include "private/tactics/search_app.hpp"
 #include "private/tactics/search_trivial_value.hpp"
 #include "private/tactics/search_true_t.hpp"
 #include "private/tactics/search_var.hpp"
 
-#include "dep0/ast/alpha_equivalence.hpp"
-#include "dep0/ast/hash_code.hpp"
+#include "dep0/typecheck/beta_delta_reduction.hpp"
+
+#include "dep0/ast/pretty_print.hpp"
 
 #include "dep0/match.hpp"
+#include "dep0/stats.hpp"
 #include "dep0/tracing.hpp"
 
 #include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <chrono>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 static std::atomic<std::uint64_t> next_task_id = 0ul;
 
 namespace dep0::typecheck {
 
+static stats_counter_t num_goals("proof_search", "goals");
+static stats_counter_t num_goals_proved("proof_search", "goals_proved");
+static stats_counter_t num_tasks_created("proof_search", "tasks_created");
+static stats_counter_t num_tasks_destroyed("proof_search", "tasks_destroyed");
+static stats_counter_t num_tasks_run("proof_search", "tasks_run");
+static stats_maximum_t max_depth_reached("proof_search", "max_depth_reached");
+
+static proof_search_budget_t const default_budget;
+static thread_local proof_search_budget_t const* current_budget = &default_budget;
+
+proof_search_budget_scope_t::proof_search_budget_scope_t(proof_search_budget_t budget) :
+    m_budget(std::move(budget)),
+    m_previous(current_budget)
+{
+    current_budget = &m_budget;
+}
+
+proof_search_budget_scope_t::~proof_search_budget_scope_t()
+{
+    current_budget = m_previous;
+}
+
 struct search_depth_friend_t { };
 search_depth_t::search_depth_t(search_depth_friend_t const&, std::size_t const value) : m_value(value) { }
 
+/**
+ * Shared by all alternatives of a parallel search, so that they can agree on the winner regardless of timing.
+ *
+ * The rank of an alternative is given by the round in which it succeeds and, in case of a tie, by its index;
+ * each alternative only keeps running while it can still beat the best rank found so far,
+ * so the alternative with the lowest rank is never cancelled and always wins.
+ */
+struct search_race_t
+{
+    std::size_t const num_alternatives;
+    std::atomic<std::size_t> best = std::numeric_limits<std::size_t>::max();
+
+    std::size_t rank(std::size_t const round, std::size_t const index) const
+    {
+        return round * num_alternatives + index;
+    }
+
+    bool can_win(std::size_t const rank) const
+    {
+        return rank < best.load(std::memory_order_relaxed);
+    }
+
+    void succeeded(std::size_t const rank)
+    {
+        auto current = best.load(std::memory_order_relaxed);
+        while (rank < current and not best.compare_exchange_weak(current, rank, std::memory_order_relaxed));
+    }
+};
+
 struct search_state_t
 {
-    struct eq_t { bool operator()(expr_t const&, expr_t const&) const; };
+    /**
+     * Interns the target type of all tasks, so that the cache and loop detection only need to compare IDs.
+     * Must be declared before `main_task`, which interns its own target on construction.
+     */
+    expr_interner_t interner;
 
     /**
      * Caches the result of previous searches, in case we need to search again for a value of the same type.
-     * The key is the target type and the value is the result of a previous search.
+     * The key is the interned target type and the value is the result of a previous search.
      */
-    using cache_t = std::unordered_map<expr_t, expr_t, std::hash<expr_t>, eq_t>;
+    using cache_t = std::unordered_map<interned_expr_t, expr_t>;
     cache_t cache;
 
-    std::chrono::steady_clock::time_point const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    std::size_t fuel; /**< Number of steps left before giving up. */
+    std::size_t const max_depth;
+    std::optional<std::chrono::steady_clock::time_point> const deadline;
+
+    search_race_t const* race = nullptr; /**< Only set if this state explores one alternative of a parallel search. */
+    std::size_t rank = 0ul; /**< The rank this alternative would get if it succeeded in the current round. */
 
     env_t const& env;
     ctx_t const& ctx;
@@ -49,51 +120,51 @@ struct search_state_t
     std::shared_ptr<search_task_t> main_task;
 
     search_state_t(
+        proof_search_budget_t const& budget,
         env_t const& env,
         ctx_t const& ctx,
         expr_t const& target,
         ast::is_mutable_t const is_mutable_allowed,
         std::shared_ptr<usage_t> usage,
-        ast::qty_t const usage_multiplier)
-    :   env(env),
+        ast::qty_t const usage_multiplier,
+        std::string name = "main_task",
+        std::size_t const depth = 0ul,
+        std::function<void(search_task_t&)> tactic = proof_search)
+    :   fuel(budget.fuel),
+        max_depth(budget.max_depth),
+        deadline(
+            budget.timeout
+            ? std::optional{std::chrono::steady_clock::now() + *budget.timeout}
+            : std::nullopt),
+        env(env),
         ctx(ctx),
         main_task(search_task_t::create(
-            "main_task",
+            std::move(name),
             std::weak_ptr<search_task_t>(),
             *this,
-            search_depth_t(search_depth_friend_t{}, 0ul),
+            search_depth_t(search_depth_friend_t{}, depth),
             std::make_shared<expr_t>(target),
             is_mutable_allowed,
             std::move(usage),
             usage_multiplier,
-            proof_search))
+            std::move(tactic)))
     { }
 
-    bool expired() const { return std::chrono::steady_clock::now() > deadline; }
+    /**
+     * Consume one step of the budget, if there is any left; return false if the search must give up,
+     * including when this state explores an alternative of a parallel search that can no longer win.
+     */
+    bool consume_fuel()
+    {
+        if (fuel == 0ul or (race and not race->can_win(rank)))
+            return false;
+        if (deadline and std::chrono::steady_clock::now() > *deadline)
+            return false;
+        --fuel;
+        return true;
+    }
 };
 
-bool search_state_t::eq_t::operator()(expr_t const& x, expr_t const& y) const
-{
-    // TODO should this be beta-delta equivalence instead? needs a test
-    return is_alpha_equivalent(x, y).has_value()
-        and std::visit(
-            boost::hana::overload(
-                [] (expr_t const& x_type, expr_t const& y_type)
-                {
-                    return is_alpha_equivalent(x_type, y_type).has_value();
-                },
-                [] (kind_t, kind_t)
-                {
-                    return true;
-                },
-                [] <typename T, typename U> requires (not std::is_same_v<T, U>)
-                (T const&, U const&)
-                {
-                    return false;
-                }),
-            x.properties.sort.get(), y.properties.sort.get());
-}
-
 search_task_t::search_task_t(
     private_t,
     std::string name,
@@ -121,10 +192,23 @@ search_task_t::search_task_t(
     env(st.env),
     ctx(st.ctx),
     target(std::move(target)),
+    target_id([&]
+    {
+        // sub-tasks very often share the same target as their parent, in which case there is no need to intern it
+        auto const p = this->parent.lock();
+        return p and p->target == this->target ? p->target_id : st.interner.intern(*this->target);
+    }()),
     is_mutable_allowed(is_mutable_allowed),
     usage(std::move(usage)),
     usage_multiplier(usage_multiplier)
-{ }
+{
+    num_tasks_created.add();
+}
+
+search_task_t::~search_task_t()
+{
+    num_tasks_destroyed.add();
+}
 
 std::shared_ptr<search_task_t> search_task_t::create(
     std::string name,
@@ -178,7 +262,7 @@ void search_task_t::set_failed()
 void search_task_t::set_result(expr_t x)
 {
     assert(not done());
-    state.cache.try_emplace(*target, x);
+    state.cache.try_emplace(target_id, x);
     m_status = succeeded_t{std::move(x)};
 }
 
@@ -187,8 +271,12 @@ void search_task_t::run()
     assert(not done());
     if (done())
         return;
-    if (depth.value() > 10ul or state.expired())
+    if (depth.value() > state.max_depth or not state.consume_fuel())
         return set_failed();
+    num_tasks_run.add();
+    if (auto const profile = current_func_profile())
+        profile->proof_search_tasks.fetch_add(1ul, std::memory_order_relaxed);
+    max_depth_reached.record(depth.value());
     TRACE_EVENT(TRACE_PROOF_SEARCH, perfetto::DynamicString(name), perfetto::Flow(task_id),
         "target", m_target_str, "depth", depth.value());
     match(
@@ -250,31 +338,170 @@ void search_task_t::when_any(std::vector<std::shared_ptr<search_task_t>> tasks)
     m_kind = any_t{std::move(tasks)};
 }
 
-std::optional<expr_t>
-search_proof(
+/** Explore the whole search tree with the calling thread only and return the final state of the search. */
+static std::unique_ptr<search_state_t>
+sequential_search(
+    proof_search_budget_t const& budget,
     env_t const& env,
     ctx_t const& ctx,
     expr_t const& target,
     ast::is_mutable_t const is_mutable_allowed,
-    usage_t& usage,
+    usage_t const& usage,
     ast::qty_t const usage_multiplier)
 {
     auto st =
-        search_state_t(
+        std::make_unique<search_state_t>(
+            budget,
             env,
             ctx,
             target,
             is_mutable_allowed,
             std::make_shared<usage_t>(usage.extend()),
             usage_multiplier);
-    TRACE_EVENT(TRACE_PROOF_SEARCH, "search_proof()");
     do
-        st.main_task->run();
-    while (not st.main_task->done());
+        st->main_task->run();
+    while (not st->main_task->done());
+    return st;
+}
+
+/**
+ * Explore independently, and possibly concurrently, each alternative that `proof_search()` would try
+ * at the root of the search tree, and return the state of the winning alternative, if any.
+ * Tactics that either succeed or fail immediately are tried first by the calling thread,
+ * so that extra threads are only started if the search is not trivial.
+ */
+static std::unique_ptr<search_state_t>
+parallel_search(
+    proof_search_budget_t const& budget,
+    env_t const& env,
+    ctx_t const& ctx,
+    expr_t const& target,
+    ast::is_mutable_t const is_mutable_allowed,
+    usage_t const& usage,
+    ast::qty_t const usage_multiplier)
+{
+    std::vector<std::pair<std::string, std::function<void(search_task_t&)>>> alternatives{
+        {"search_var", search_var},
+        {"search_true_t", search_true_t},
+        {"search_trivial_value", search_trivial_value}
+    };
+    auto const num_quick = alternatives.size();
+    std::ranges::move(
+        search_app_alternatives(env, target, is_mutable_allowed, usage_multiplier),
+        std::back_inserter(alternatives));
+    // all states are constructed upfront by the calling thread, which is the only one allowed to touch `usage`
+    auto race = search_race_t{alternatives.size()};
+    std::vector<std::unique_ptr<search_state_t>> states;
+    states.reserve(alternatives.size());
+    for (auto& [name, tactic]: alternatives)
+    {
+        states.push_back(std::make_unique<search_state_t>(
+            budget,
+            env,
+            ctx,
+            target,
+            is_mutable_allowed,
+            std::make_shared<usage_t>(usage.extend()),
+            usage_multiplier,
+            std::move(name),
+            1ul, // same depth as the sub-tasks of `proof_search()`
+            std::move(tactic)));
+        states.back()->race = &race;
+    }
+    auto const explore = [&] (std::size_t const index)
+    {
+        auto& st = *states[index];
+        for (auto round = 0ul; not st.main_task->done(); ++round)
+        {
+            st.rank = race.rank(round, index);
+            if (not race.can_win(st.rank))
+                return;
+            st.main_task->run();
+        }
+        if (st.main_task->succeeded())
+            race.succeeded(st.rank);
+    };
+    // fuel is split upfront, rather than drawn from a shared counter, so that the outcome does not depend on timing
+    auto fuel = budget.fuel;
+    for (auto const i: std::views::iota(0ul, num_quick))
+    {
+        states[i]->fuel = fuel;
+        explore(i);
+        fuel = states[i]->fuel;
+    }
+    if (auto const num_others = states.size() - num_quick; num_others > 0ul)
+        for (auto const i: std::views::iota(0ul, num_others))
+            states[num_quick + i]->fuel = fuel / num_others + (i < fuel % num_others ? 1ul : 0ul);
+    if (race.best == std::numeric_limits<std::size_t>::max())
+    {
+        // the remaining alternatives are handed out one at a time to whichever thread is free first
+        std::atomic<std::size_t> next = num_quick;
+        auto const work = [&]
+        {
+            for (auto i = next++; i < states.size(); i = next++)
+                explore(i);
+        };
+        auto const num_threads = std::min(budget.threads, states.size() - num_quick);
+        std::vector<std::jthread> workers;
+        for (auto i = 1ul; i < num_threads; ++i)
+            workers.emplace_back(
+                [
+                    &,
+                    normalizer = current_normalizer(),
+                    normal_form_cache = normal_form_cache_t::current(),
+                    profile = current_func_profile(),
+                    running_timers = running_profile_timers()
+                ]
+                {
+                    // thread-local settings are not inherited, so workers must normalize like the calling thread does,
+                    // reusing the same normal forms, and count their work towards the same profile
+                    // without timing again what the calling thread is already timing
+                    auto const normalizer_scope = normalizer_scope_t(normalizer);
+                    auto const normal_form_cache_scope = normal_form_cache_scope_t(normal_form_cache);
+                    auto const profile_scope = func_profile_scope_t(profile, running_timers);
+                    work();
+                });
+        work();
+    } // joins all workers, so from now on all states are only accessed by the calling thread
+    auto const winner = std::ranges::find_if(states, [&] (auto const& st)
+    {
+        return st->main_task->succeeded() and st->rank == race.best;
+    });
+    return winner == states.end() ? nullptr : std::move(*winner);
+}
+
+std::optional<expr_t>
+search_proof(
+    env_t const& env,
+    ctx_t const& ctx,
+    expr_t const& target,
+    ast::is_mutable_t const is_mutable_allowed,
+    usage_t& usage,
+    ast::qty_t const usage_multiplier)
+{
+    auto const cache = proof_search_cache_t::current();
+    if (cache)
+        if (auto result = cache->try_reuse(ctx, target, is_mutable_allowed, usage, usage_multiplier))
+            return result;
+    num_goals.add();
+    if (auto const profile = current_func_profile())
+        profile->proof_search_goals.fetch_add(1ul, std::memory_order_relaxed);
+    auto const timer = profile_timer_t(profile_timer_kind_t::proof_search);
+    TRACE_EVENT(TRACE_PROOF_SEARCH, "search_proof()");
+    auto const& budget = *current_budget;
+    auto const st =
+        budget.threads > 1ul
+        ? parallel_search(budget, env, ctx, target, is_mutable_allowed, usage, usage_multiplier)
+        : sequential_search(budget, env, ctx, target, is_mutable_allowed, usage, usage_multiplier);
     std::optional<expr_t> result;
-    if (st.main_task->succeeded())
-        if (usage.try_add(ctx, *st.main_task->usage))
-            result.emplace(std::move(st.main_task->result()));
+    if (st and st->main_task->succeeded())
+        if (usage.try_add(ctx, *st->main_task->usage))
+        {
+            num_goals_proved.add();
+            result.emplace(std::move(st->main_task->result()));
+            if (cache)
+                cache->store(ctx, target, is_mutable_allowed, usage_multiplier, *result);
+        }
     return result;
 }
 
@@ -302,7 +529,7 @@ static bool detect_loop(search_task_t& task)
     auto p = task.parent;
     while (auto q = p.lock())
     {
-        if (search_state_t::eq_t{}(*q->target, *task.target))
+        if (q->target_id == task.target_id)
             return true;
         p = q->parent;
     }
@@ -311,7 +538,7 @@ static bool detect_loop(search_task_t& task)
 
 static void proof_search_impl(search_task_t& task, bool const run_search_app)
 {
-    if (auto const it = task.state.cache.find(*task.target); it != task.state.cache.end())
+    if (auto const it = task.state.cache.find(task.target_id); it != task.state.cache.end())
     {
         if (task.usage->try_add(task.ctx, it->second, task.usage_multiplier))
         {
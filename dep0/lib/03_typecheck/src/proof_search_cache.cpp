@@ -0,0 +1,119 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "private/proof_search_cache.hpp"
+
+#include "dep0/ast/alpha_equivalence.hpp"
+#include "dep0/ast/occurs_in.hpp"
+
+#include "dep0/stats.hpp"
+#include "dep0/tracing.hpp"
+
+#include <algorithm>
+
+namespace dep0::typecheck {
+
+static thread_local proof_search_cache_t* current_cache = nullptr;
+
+static stats_counter_t num_hits("proof_search", "cache_hits");
+static stats_counter_t num_misses("proof_search", "cache_misses");
+
+/** Return true if the given type is some `true_t(cond)`; false otherwise. */
+static bool is_true_t(expr_t const& type)
+{
+    auto const app = std::get_if<expr_t::app_t>(&type.value);
+    return app and std::holds_alternative<expr_t::true_t>(app->func.get().value);
+}
+
+proof_search_cache_t::proof_search_cache_t() :
+    m_previous(current_cache)
+{
+    current_cache = this;
+}
+
+proof_search_cache_t::~proof_search_cache_t()
+{
+    current_cache = m_previous;
+}
+
+proof_search_cache_t* proof_search_cache_t::current()
+{
+    return current_cache;
+}
+
+std::optional<expr_t> proof_search_cache_t::try_reuse(
+    ctx_t const& ctx,
+    expr_t const& target,
+    ast::is_mutable_t const is_mutable_allowed,
+    usage_t& usage,
+    ast::qty_t const usage_multiplier)
+{
+    auto const is_viable = [&] (entry_t const& entry)
+    {
+        if (entry.is_mutable_allowed == ast::is_mutable_t::yes and is_mutable_allowed == ast::is_mutable_t::no)
+            return false;
+        if (entry.erased and usage_multiplier != ast::qty_t::zero)
+            return false;
+        return std::ranges::all_of(
+            entry.free_vars,
+            [&] (auto const& var_and_type)
+            {
+                auto const decl = ctx[var_and_type.first];
+                return decl and is_alpha_equivalent(decl->type, var_and_type.second).has_value();
+            });
+    };
+    std::optional<expr_t> result;
+    if (auto const id = m_targets.find(target))
+        if (auto const it = m_entries.find(*id); it != m_entries.end())
+            for (auto const& entry: it->second)
+                if (is_viable(entry) and usage.try_add(ctx, entry.result, usage_multiplier))
+                {
+                    result.emplace(entry.result);
+                    break;
+                }
+    if (result)
+    {
+        num_hits.add();
+        TRACE_COUNTER(TRACE_PROOF_SEARCH, "proof_search_cache_hits", ++m_hits);
+    }
+    else
+    {
+        num_misses.add();
+        TRACE_COUNTER(TRACE_PROOF_SEARCH, "proof_search_cache_misses", ++m_misses);
+    }
+    return result;
+}
+
+void proof_search_cache_t::store(
+    ctx_t const& ctx,
+    expr_t const& target,
+    ast::is_mutable_t const is_mutable_allowed,
+    ast::qty_t const usage_multiplier,
+    expr_t const& result)
+{
+    // the result might rely on any hypothesis `true_t(cond)` without mentioning it, so all of them are needed,
+    // together with the variables that occur in their conditions
+    auto const decls = ctx.decls();
+    std::vector<expr_t const*> hypotheses;
+    for (ctx_t::decl_t const& decl: decls)
+        if (is_true_t(decl.type))
+            hypotheses.push_back(&decl.type);
+    auto const is_needed = [&] (ctx_t::decl_t const& decl)
+    {
+        auto const occurs_in = [&] (expr_t const& x) { return ast::occurs_in(decl.var, x, ast::occurrence_style::free); };
+        return is_true_t(decl.type)
+            or occurs_in(result)
+            or std::ranges::any_of(hypotheses, [&] (expr_t const* h) { return occurs_in(*h); });
+    };
+    std::vector<std::pair<expr_t::var_t, expr_t>> free_vars;
+    for (ctx_t::decl_t const& decl: decls)
+        if (is_needed(decl))
+            free_vars.emplace_back(decl.var, decl.type);
+    m_entries[m_targets.intern(target)].push_back(
+        entry_t{result, is_mutable_allowed, usage_multiplier == ast::qty_t::zero, std::move(free_vars)});
+}
+
+} // namespace dep0::typecheck
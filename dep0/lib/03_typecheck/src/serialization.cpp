@@ -0,0 +1,804 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "dep0/typecheck/serialization.hpp"
+
+#include "private/derivation_rules.hpp"
+
+#include "dep0/typecheck/context.hpp"
+#include "dep0/typecheck/context_ref.hpp"
+#include "dep0/typecheck/environment_ref.hpp"
+
+#include "dep0/match.hpp"
+#include "dep0/mmap.hpp"
+
+#include <boost/multiprecision/cpp_int.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace dep0::typecheck {
+
+namespace {
+
+/**
+ * Every image starts with these bytes, followed by the format version in 4 bytes little-endian.
+ * Everything after that is encoded as a sequence of unsigned LEB128 integers, or raw bytes in a few places:
+ *   - first the string table, i.e. the number of strings followed by the length and the bytes of each one;
+ *   - then the module, where each name or source snippet is stored as its index in the string table;
+ *   - variants are stored as their index followed by the value of the active alternative;
+ *   - optionals and vectors are stored as their size followed by each element.
+ */
+std::string_view constexpr magic = "dep0.mod";
+std::size_t constexpr header_size = magic.size() + 4ul;
+
+template <typename T> struct tag_t {};
+
+template <typename T>
+concept binary_expr = requires (T const& x) { x.lhs; x.rhs; };
+
+void write_size(std::string& out, std::size_t x)
+{
+    for (; x >= 0x80ul; x >>= 7)
+        out.push_back(static_cast<char>((x & 0x7ful) | 0x80ul));
+    out.push_back(static_cast<char>(x));
+}
+
+class writer_t
+{
+    std::string m_body;
+    std::vector<std::string_view> m_strings;
+    std::unordered_map<std::string_view, std::size_t> m_string_ids;
+
+    void write_size(std::size_t const x) { typecheck::write_size(m_body, x); }
+
+public:
+    std::string finish() &&
+    {
+        std::string image(magic);
+        for (auto const i: {0u, 1u, 2u, 3u})
+            image.push_back(static_cast<char>((serialization_format_version >> (8u * i)) & 0xffu));
+        typecheck::write_size(image, m_strings.size());
+        for (auto const s: m_strings)
+        {
+            typecheck::write_size(image, s.size());
+            image.append(s);
+        }
+        image.append(m_body);
+        return image;
+    }
+
+    // generic types
+    template <typename T>
+    requires std::is_empty_v<T>
+    void write(T const&) { }
+
+    template <typename E>
+    requires std::is_enum_v<E>
+    void write(E const x) { write_size(static_cast<std::size_t>(x)); }
+
+    template <typename T>
+    void write(std::optional<T> const& x)
+    {
+        write_size(x ? 1ul : 0ul);
+        if (x)
+            write(*x);
+    }
+
+    template <typename T>
+    void write(std::vector<T> const& xs)
+    {
+        write_size(xs.size());
+        for (auto const& x: xs)
+            write(x);
+    }
+
+    template <typename... Ts>
+    void write(std::variant<Ts...> const& x)
+    {
+        write_size(x.index());
+        std::visit([this] (auto const& v) { write(v); }, x);
+    }
+
+    template <typename T>
+    void write(dep0::recursive_wrapper<T> const& x) { write(x.get()); }
+
+    void write(source_text const& x)
+    {
+        auto const [it, inserted] = m_string_ids.try_emplace(x.view(), m_strings.size());
+        if (inserted)
+            m_strings.push_back(x.view());
+        write_size(it->second);
+    }
+
+    void write(source_loc_t const& x)
+    {
+        write_size(x.line);
+        write_size(x.col);
+        write(x.txt);
+    }
+
+    void write_int(boost::multiprecision::cpp_int const& x)
+    {
+        std::vector<std::uint8_t> bytes;
+        boost::multiprecision::export_bits(x, std::back_inserter(bytes), 8);
+        write_size(x.sign() < 0 ? 1ul : 0ul);
+        write_size(bytes.size());
+        m_body.append(bytes.begin(), bytes.end());
+    }
+
+    // expressions
+    template <binary_expr T>
+    void write(T const& x)
+    {
+        write(x.lhs);
+        write(x.rhs);
+    }
+
+    void write(expr_t::boolean_constant_t const& x) { write_size(x.value ? 1ul : 0ul); }
+    void write(expr_t::numeric_constant_t const& x) { write_int(x.value); }
+    void write(expr_t::string_literal_t const& x) { write(x.value); }
+    void write(expr_t::boolean_expr_t::not_t const& x) { write(x.expr); }
+    void write(expr_t::boolean_expr_t const& x) { write(x.value); }
+    void write(expr_t::relation_expr_t const& x) { write(x.value); }
+    void write(expr_t::arith_expr_t const& x) { write(x.value); }
+
+    void write(expr_t::var_t const& x)
+    {
+        write(x.name);
+        write_size(x.idx);
+        write_size(x.shadow_id);
+    }
+
+    void write(expr_t::global_t const& x)
+    {
+        write(x.module_name);
+        write(x.name);
+    }
+
+    void write(expr_t::app_t const& x)
+    {
+        write(x.func);
+        write(x.args);
+    }
+
+    void write(expr_t::abs_t const& x)
+    {
+        write(x.is_mutable);
+        write(x.args);
+        write(x.ret_type);
+        write(x.body);
+    }
+
+    void write(expr_t::pi_t const& x)
+    {
+        write(x.is_mutable);
+        write(x.args);
+        write(x.ret_type);
+    }
+
+    void write(expr_t::sigma_t const& x) { write(x.args); }
+    void write(expr_t::addressof_t const& x) { write(x.expr); }
+    void write(expr_t::deref_t const& x) { write(x.expr); }
+
+    void write(expr_t::scopeof_t const& x)
+    {
+        write(x.expr);
+        write_size(x.scope_id);
+    }
+
+    void write(expr_t::init_list_t const& x) { write(x.values); }
+
+    void write(expr_t::member_t const& x)
+    {
+        write(x.object);
+        write(x.field);
+    }
+
+    void write(expr_t::subscript_t const& x)
+    {
+        write(x.object);
+        write(x.index);
+    }
+
+    void write(expr_t::because_t const& x)
+    {
+        write(x.value);
+        write(x.reason);
+    }
+
+    void write(expr_t const& x)
+    {
+        write(x.properties.sort);
+        write(x.value);
+    }
+
+    // function arguments and statements
+    void write(func_arg_t const& x)
+    {
+        write(x.qty);
+        write(x.type);
+        write(x.var);
+    }
+
+    void write(body_t const& x) { write(x.stmts); }
+
+    void write(stmt_t::if_else_t const& x)
+    {
+        write(x.cond);
+        write(x.true_branch);
+        write(x.false_branch);
+    }
+
+    void write(stmt_t::return_t const& x) { write(x.expr); }
+    void write(stmt_t::impossible_t const& x) { write(x.reason); }
+    void write(stmt_t const& x) { write(x.value); }
+
+    // module entries; names always come before types because `reader_t` needs them to rebuild environments
+    void write(ast::attribute_t const& x) { write(x.value); }
+
+    void write(type_def_t::integer_t const& x)
+    {
+        write(x.name);
+        write(x.sign);
+        write(x.width);
+    }
+
+    void write(type_def_t::struct_t::field_t const& x)
+    {
+        write(x.type);
+        write(x.var);
+    }
+
+    void write(type_def_t::struct_t const& x)
+    {
+        write(x.name);
+        write(x.fields);
+    }
+
+    void write(type_def_t const& x)
+    {
+        write(x.properties.origin);
+        write(x.value);
+    }
+
+    void write(axiom_t const& x)
+    {
+        write(x.properties.origin);
+        write(x.name);
+        write(x.properties.sort);
+        write(x.signature);
+    }
+
+    void write(extern_decl_t const& x)
+    {
+        write(x.properties.origin);
+        write(x.name);
+        write(x.properties.sort);
+        write(x.signature);
+    }
+
+    void write(func_decl_t const& x)
+    {
+        write(x.properties.origin);
+        write(x.name);
+        write(x.attribute);
+        write(x.properties.sort);
+        write(x.signature);
+    }
+
+    void write(func_def_t const& x)
+    {
+        write(x.properties.origin);
+        write(x.name);
+        write(x.attribute);
+        write(x.properties.sort);
+        write(x.value);
+    }
+
+    void write(module_t const& x) { write(x.entries); }
+};
+
+/** Thrown by `reader_t` if the image is malformed; it never escapes from `deserialize()`. */
+struct malformed_image_t
+{
+    dep0::error_t reason;
+};
+
+/**
+ * Rebuilds a legal module from its image, mirroring what `check()` does to the environment,
+ * so that every expression refers to the same environment in which it was originally typechecked.
+ */
+class reader_t
+{
+    source_text m_image;
+    std::size_t m_pos = header_size;
+    std::vector<source_text> m_strings;
+    std::optional<env_ref_t> m_env; // environment of the entry being read
+    ctx_ref_t m_ctx;
+
+    [[noreturn]] static void fail(std::string msg) { throw malformed_image_t{dep0::error_t(std::move(msg))}; }
+
+    static void ensure(dep0::expected<std::true_type> const& ok)
+    {
+        if (not ok)
+            throw malformed_image_t{ok.error()};
+    }
+
+    std::size_t remaining() const { return m_image.size() - m_pos; }
+
+    std::uint8_t read_byte()
+    {
+        if (m_pos >= m_image.size())
+            fail("unexpected end of image");
+        return static_cast<std::uint8_t>(m_image.view()[m_pos++]);
+    }
+
+    std::size_t read_size()
+    {
+        std::size_t x = 0ul;
+        for (std::size_t shift = 0ul; ; shift += 7ul)
+        {
+            if (shift >= 64ul)
+                fail("integer too large");
+            auto const b = read_byte();
+            x |= static_cast<std::size_t>(b & 0x7fu) << shift;
+            if ((b & 0x80u) == 0u)
+                return x;
+        }
+    }
+
+    std::size_t read_size(std::size_t const max_value, char const* const what)
+    {
+        auto const x = read_size();
+        if (x > max_value)
+            fail(std::string("invalid ") + what);
+        return x;
+    }
+
+    std::string_view read_bytes(std::size_t const n)
+    {
+        if (n > remaining())
+            fail("unexpected end of image");
+        auto const bytes = m_image.view().substr(m_pos, n);
+        m_pos += n;
+        return bytes;
+    }
+
+    // generic types
+    template <typename T>
+    requires std::is_empty_v<T>
+    T read(tag_t<T>) { return {}; }
+
+    ast::qty_t read(tag_t<ast::qty_t>) { return static_cast<ast::qty_t>(read_size(2ul, "quantity")); }
+    ast::sign_t read(tag_t<ast::sign_t>) { return static_cast<ast::sign_t>(read_size(1ul, "sign")); }
+    ast::width_t read(tag_t<ast::width_t>) { return static_cast<ast::width_t>(read_size(3ul, "width")); }
+
+    ast::is_mutable_t read(tag_t<ast::is_mutable_t>)
+    {
+        return static_cast<ast::is_mutable_t>(read_size(1ul, "mutability"));
+    }
+
+    template <typename T>
+    std::optional<T> read(tag_t<std::optional<T>>)
+    {
+        if (read_size(1ul, "optional") == 0ul)
+            return std::nullopt;
+        return read(tag_t<T>{});
+    }
+
+    template <typename T>
+    std::vector<T> read(tag_t<std::vector<T>>)
+    {
+        auto const n = read_size();
+        if (n > remaining()) // every element takes at least 1 byte
+            fail("vector too large");
+        std::vector<T> xs;
+        xs.reserve(n);
+        for (auto i = 0ul; i < n; ++i)
+            xs.push_back(read(tag_t<T>{}));
+        return xs;
+    }
+
+    template <typename... Ts>
+    std::variant<Ts...> read(tag_t<std::variant<Ts...>>)
+    {
+        using variant_t = std::variant<Ts...>;
+        static constexpr std::array readers{+[] (reader_t& r) -> variant_t { return r.read(tag_t<Ts>{}); }...};
+        return readers[read_size(readers.size() - 1ul, "variant index")](*this);
+    }
+
+    template <typename T>
+    dep0::recursive_wrapper<T> read(tag_t<dep0::recursive_wrapper<T>>) { return read(tag_t<T>{}); }
+
+    source_text read(tag_t<source_text>)
+    {
+        auto const i = read_size();
+        if (i >= m_strings.size())
+            fail("invalid string index");
+        return m_strings[i];
+    }
+
+    source_loc_t read(tag_t<source_loc_t>)
+    {
+        return source_loc_t{read_size(), read_size(), read(tag_t<source_text>{})};
+    }
+
+    boost::multiprecision::cpp_int read(tag_t<boost::multiprecision::cpp_int>)
+    {
+        auto const negative = read_size(1ul, "sign") == 1ul;
+        auto const bytes = read_bytes(read_size());
+        boost::multiprecision::cpp_int x;
+        boost::multiprecision::import_bits(
+            x,
+            reinterpret_cast<std::uint8_t const*>(bytes.data()),
+            reinterpret_cast<std::uint8_t const*>(bytes.data() + bytes.size()),
+            8);
+        if (negative)
+            x = -x;
+        return x;
+    }
+
+    // expressions
+    template <binary_expr T>
+    T read(tag_t<T>) { return T{read(tag_t<expr_t>{}), read(tag_t<expr_t>{})}; }
+
+    expr_t::boolean_constant_t read(tag_t<expr_t::boolean_constant_t>)
+    {
+        return {read_size(1ul, "boolean constant") == 1ul};
+    }
+
+    expr_t::numeric_constant_t read(tag_t<expr_t::numeric_constant_t>)
+    {
+        return {read(tag_t<boost::multiprecision::cpp_int>{})};
+    }
+
+    expr_t::string_literal_t read(tag_t<expr_t::string_literal_t>) { return {read(tag_t<source_text>{})}; }
+
+    expr_t::boolean_expr_t::not_t read(tag_t<expr_t::boolean_expr_t::not_t>) { return {read(tag_t<expr_t>{})}; }
+
+    expr_t::boolean_expr_t read(tag_t<expr_t::boolean_expr_t>)
+    {
+        return {read(tag_t<expr_t::boolean_expr_t::value_t>{})};
+    }
+
+    expr_t::relation_expr_t read(tag_t<expr_t::relation_expr_t>)
+    {
+        return {read(tag_t<expr_t::relation_expr_t::value_t>{})};
+    }
+
+    expr_t::arith_expr_t read(tag_t<expr_t::arith_expr_t>)
+    {
+        return {read(tag_t<expr_t::arith_expr_t::value_t>{})};
+    }
+
+    expr_t::var_t read(tag_t<expr_t::var_t>)
+    {
+        return expr_t::var_t{read(tag_t<source_text>{}), read_size(), read_size()};
+    }
+
+    expr_t::global_t read(tag_t<expr_t::global_t>)
+    {
+        return {read(tag_t<std::optional<source_text>>{}), read(tag_t<source_text>{})};
+    }
+
+    expr_t::app_t read(tag_t<expr_t::app_t>)
+    {
+        return {read(tag_t<expr_t>{}), read(tag_t<std::vector<expr_t>>{})};
+    }
+
+    expr_t::abs_t read(tag_t<expr_t::abs_t>)
+    {
+        return {
+            read(tag_t<ast::is_mutable_t>{}),
+            read(tag_t<std::vector<func_arg_t>>{}),
+            read(tag_t<expr_t>{}),
+            read(tag_t<body_t>{})
+        };
+    }
+
+    expr_t::pi_t read(tag_t<expr_t::pi_t>)
+    {
+        return {read(tag_t<ast::is_mutable_t>{}), read(tag_t<std::vector<func_arg_t>>{}), read(tag_t<expr_t>{})};
+    }
+
+    expr_t::sigma_t read(tag_t<expr_t::sigma_t>) { return {read(tag_t<std::vector<func_arg_t>>{})}; }
+    expr_t::addressof_t read(tag_t<expr_t::addressof_t>) { return {read(tag_t<expr_t>{})}; }
+    expr_t::deref_t read(tag_t<expr_t::deref_t>) { return {read(tag_t<expr_t>{})}; }
+
+    expr_t::scopeof_t read(tag_t<expr_t::scopeof_t>)
+    {
+        return expr_t::scopeof_t{read(tag_t<expr_t>{}), read_size()};
+    }
+
+    expr_t::init_list_t read(tag_t<expr_t::init_list_t>) { return {read(tag_t<std::vector<expr_t>>{})}; }
+
+    expr_t::member_t read(tag_t<expr_t::member_t>)
+    {
+        return {read(tag_t<expr_t>{}), read(tag_t<source_text>{})};
+    }
+
+    expr_t::subscript_t read(tag_t<expr_t::subscript_t>)
+    {
+        return {read(tag_t<expr_t>{}), read(tag_t<expr_t>{})};
+    }
+
+    expr_t::because_t read(tag_t<expr_t::because_t>)
+    {
+        return {read(tag_t<expr_t>{}), read(tag_t<expr_t>{})};
+    }
+
+    expr_t read(tag_t<expr_t>)
+    {
+        auto sort = read(tag_t<sort_t>{});
+        auto value = read(tag_t<expr_t::value_t>{});
+        return make_legal_expr(*m_env, m_ctx, std::move(sort), std::move(value));
+    }
+
+    // function arguments and statements
+    func_arg_t read(tag_t<func_arg_t>)
+    {
+        auto const qty = read(tag_t<ast::qty_t>{});
+        auto type = read(tag_t<expr_t>{});
+        auto var = read(tag_t<std::optional<expr_t::var_t>>{});
+        return make_legal_func_arg(qty, std::move(type), std::move(var));
+    }
+
+    body_t read(tag_t<body_t>) { return make_legal_body(read(tag_t<std::vector<stmt_t>>{})); }
+
+    stmt_t::if_else_t read(tag_t<stmt_t::if_else_t>)
+    {
+        return {read(tag_t<expr_t>{}), read(tag_t<body_t>{}), read(tag_t<std::optional<body_t>>{})};
+    }
+
+    stmt_t::return_t read(tag_t<stmt_t::return_t>) { return {read(tag_t<std::optional<expr_t>>{})}; }
+    stmt_t::impossible_t read(tag_t<stmt_t::impossible_t>) { return {read(tag_t<std::optional<expr_t>>{})}; }
+    stmt_t read(tag_t<stmt_t>) { return make_legal_stmt(read(tag_t<stmt_t::value_t>{})); }
+
+    // module entries
+    ast::attribute_t read(tag_t<ast::attribute_t>) { return {read(tag_t<source_text>{})}; }
+
+    type_def_t::struct_t::field_t read(tag_t<type_def_t::struct_t::field_t>)
+    {
+        return {read(tag_t<expr_t>{}), read(tag_t<expr_t::var_t>{})};
+    }
+
+    type_def_t read_type_def(env_t& env)
+    {
+        auto const origin = read(tag_t<source_loc_t>{});
+        auto result = [&]
+        {
+            if (read_size(1ul, "type definition") == 0ul)
+                return make_legal_type_def(
+                    origin,
+                    type_def_t::integer_t{
+                        read(tag_t<source_text>{}),
+                        read(tag_t<ast::sign_t>{}),
+                        read(tag_t<ast::width_t>{})});
+            // fields of a struct are typechecked in an environment where the struct itself is an incomplete type
+            auto const name = read(tag_t<source_text>{});
+            auto struct_env = env.extend();
+            ensure(struct_env.try_emplace(expr_t::global_t{std::nullopt, name}, env_t::incomplete_type_t{origin}));
+            m_env.emplace(struct_env);
+            auto fields = read(tag_t<std::vector<type_def_t::struct_t::field_t>>{});
+            return make_legal_type_def(origin, type_def_t::struct_t{name, std::move(fields)});
+        }();
+        auto const name = match(result.value, [] (auto const& x) { return x.name; });
+        ensure(env.try_emplace(expr_t::global_t{std::nullopt, name}, result));
+        return result;
+    }
+
+    template <typename T>
+    T read_decl(env_t& env)
+    {
+        m_env.emplace(env);
+        auto const origin = read(tag_t<source_loc_t>{});
+        auto const name = read(tag_t<source_text>{});
+        auto sort = read(tag_t<sort_t>{});
+        auto signature = read(tag_t<expr_t::pi_t>{});
+        auto result = [&]
+        {
+            if constexpr (std::is_same_v<T, axiom_t>)
+                return make_legal_axiom(origin, std::move(sort), name, std::move(signature));
+            else
+                return make_legal_extern_decl(origin, std::move(sort), name, std::move(signature));
+        }();
+        ensure(env.try_emplace(expr_t::global_t{std::nullopt, name}, result));
+        return result;
+    }
+
+    func_decl_t read_func_decl(env_t& env)
+    {
+        m_env.emplace(env);
+        auto const origin = read(tag_t<source_loc_t>{});
+        auto const name = read(tag_t<source_text>{});
+        auto attribute = read(tag_t<std::optional<ast::attribute_t>>{});
+        auto sort = read(tag_t<sort_t>{});
+        auto signature = read(tag_t<expr_t::pi_t>{});
+        auto result = make_legal_func_decl(origin, std::move(sort), name, std::move(attribute), std::move(signature));
+        ensure(env.try_emplace(expr_t::global_t{std::nullopt, name}, result));
+        return result;
+    }
+
+    func_def_t read_func_def(env_t& env)
+    {
+        m_env.emplace(env);
+        auto const origin = read(tag_t<source_loc_t>{});
+        auto const name = read(tag_t<source_text>{});
+        auto attribute = read(tag_t<std::optional<ast::attribute_t>>{});
+        auto sort = read(tag_t<sort_t>{});
+        auto const* const type = std::get_if<expr_t>(&sort);
+        auto const* const pi = type ? std::get_if<expr_t::pi_t>(&type->value) : nullptr;
+        if (not pi)
+            fail("function definition must have a pi-type");
+        // like `type_assign_abs()`, the body of a function is typechecked in an environment
+        // containing the declaration of the function itself, in order to support recursion
+        auto f_env = env.extend();
+        ensure(
+            f_env.try_emplace(
+                expr_t::global_t{std::nullopt, name},
+                make_legal_func_decl(origin, sort, name, std::nullopt, *pi)));
+        m_env.emplace(f_env);
+        auto value = read(tag_t<expr_t::abs_t>{});
+        auto result = make_legal_func_def(origin, std::move(sort), name, std::move(attribute), std::move(value));
+        ensure(env.try_emplace(expr_t::global_t{std::nullopt, name}, result));
+        return result;
+    }
+
+public:
+    explicit reader_t(source_text image) :
+        m_image(std::move(image)),
+        m_ctx(ctx_t{})
+    {
+        if (m_image.size() < header_size or m_image.view().substr(0ul, magic.size()) != magic)
+            fail("not a module image");
+        std::uint32_t version = 0u;
+        for (auto const i: {0u, 1u, 2u, 3u})
+        {
+            auto const byte = static_cast<std::uint8_t>(m_image.view()[magic.size() + i]);
+            version |= static_cast<std::uint32_t>(byte) << (8u * i);
+        }
+        if (version != serialization_format_version)
+        {
+            std::ostringstream err;
+            err << "module image has format version " << version
+                << " but version " << serialization_format_version << " was expected";
+            fail(err.str());
+        }
+        auto const n = read_size();
+        if (n > remaining()) // every string takes at least 1 byte, for its length
+            fail("string table too large");
+        m_strings.reserve(n);
+        for (auto i = 0ul; i < n; ++i)
+        {
+            auto const size = read_size();
+            if (size > remaining())
+                fail("unexpected end of image");
+            m_strings.push_back(m_image.substr(m_pos, size));
+            m_pos += size;
+        }
+    }
+
+    module_t read_module(env_t const& base_env)
+    {
+        auto env = base_env.extend();
+        auto const n = read_size();
+        if (n > remaining())
+            fail("too many module entries");
+        std::vector<module_t::entry_t> entries;
+        entries.reserve(n);
+        for (auto i = 0ul; i < n; ++i)
+            switch (read_size(std::variant_size_v<module_t::entry_t> - 1ul, "module entry"))
+            {
+            case 0ul: entries.push_back(read_type_def(env)); break;
+            case 1ul: entries.push_back(read_decl<axiom_t>(env)); break;
+            case 2ul: entries.push_back(read_decl<extern_decl_t>(env)); break;
+            case 3ul: entries.push_back(read_func_decl(env)); break;
+            default: entries.push_back(read_func_def(env)); break;
+            }
+        if (remaining() > 0ul)
+            fail("unexpected trailing bytes");
+        return make_legal_module(std::move(env), std::move(entries));
+    }
+};
+
+} // namespace
+
+std::string serialize(module_t const& m)
+{
+    writer_t writer;
+    writer.write(m);
+    return std::move(writer).finish();
+}
+
+dep0::expected<module_t> deserialize(env_t const& base_env, source_text const image)
+{
+    try
+    {
+        return reader_t(image).read_module(base_env);
+    }
+    catch (malformed_image_t& e)
+    {
+        return dep0::error_t("failed to load module image", {std::move(e.reason)});
+    }
+}
+
+/**
+ * Create a new empty file next to the given one, with the same permissions that `std::ofstream` would give it,
+ * and a name that no other thread or process is using, so that concurrent writers of the same image
+ * never write into the same temporary file.
+ */
+static dep0::expected<std::filesystem::path> create_temp_file_next_to(std::filesystem::path const& path)
+{
+    std::random_device random;
+    for (auto attempt = 0; attempt < 100; ++attempt)
+    {
+        auto tmp = path;
+        tmp += ".tmp-" + std::to_string(::getpid()) + "-" + std::to_string(random());
+        if (int const fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666); fd >= 0)
+        {
+            ::close(fd);
+            return tmp;
+        }
+        if (errno != EEXIST)
+            return dep0::error_t("failed to create " + tmp.string(), {dep0::error_t(std::strerror(errno))});
+    }
+    return dep0::error_t("failed to create a temporary file next to " + path.string());
+}
+
+dep0::expected<std::true_type> write_image(std::filesystem::path const& path, module_t const& m)
+{
+    auto const image = serialize(m);
+    auto temp_file = create_temp_file_next_to(path);
+    if (not temp_file)
+        return std::move(temp_file.error());
+    auto const& tmp = *temp_file;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(image.data(), static_cast<std::streamsize>(image.size()));
+        out.close();
+        if (not out)
+        {
+            std::error_code ec;
+            std::filesystem::remove(tmp, ec);
+            return dep0::error_t("failed to write module image to " + tmp.string());
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmp, ec);
+        return dep0::error_t("failed to write module image to " + path.string(), {dep0::error_t(ec.message())});
+    }
+    return {};
+}
+
+dep0::expected<module_t> read_image(env_t const& base_env, std::filesystem::path const& path)
+{
+    auto image = mmap(path);
+    if (not image)
+        return std::move(image.error());
+    return deserialize(base_env, std::move(*image));
+}
+
+} // namespace dep0::typecheck
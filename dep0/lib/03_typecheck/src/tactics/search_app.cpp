@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <optional>
 #include <ranges>
+#include <sstream>
 #include <vector>
 
 namespace dep0::typecheck {
@@ -188,50 +189,48 @@ static bool is_absurd(axiom_t const& axiom)
     return false;
 }
 
-void search_app(search_task_t& task)
+std::vector<std::pair<std::string, std::function<void(search_task_t&)>>>
+search_app_alternatives(
+    env_t const& env,
+    expr_t const& target,
+    ast::is_mutable_t const is_mutable_allowed,
+    ast::qty_t const usage_multiplier)
 {
-    std::vector<std::shared_ptr<search_task_t>> sub_tasks;
+    std::vector<std::pair<std::string, std::function<void(search_task_t&)>>> alternatives;
     auto const unifies_with = [&] (auto const& f)
     {
         auto const& pi = std::get<expr_t::pi_t>(std::get<expr_t>(f.properties.sort.get()).value);
-        return unify(pi.ret_type.get(), *task.target).has_value();
+        return unify(pi.ret_type.get(), target).has_value();
     };
-    for (auto const& name: task.env.globals())
+    for (auto const& name: env.globals())
     {
         bool const viable = match(
-            *task.env[name],
+            *env[name],
             [] (env_t::incomplete_type_t const&) { return false; },
             [] (type_def_t const&) { return false; },
             [&] (axiom_t const& axiom)
             {
                 // axioms are only viable in an erased context
-                return task.usage_multiplier == ast::qty_t::zero and unifies_with(axiom) and not is_absurd(axiom);
+                return usage_multiplier == ast::qty_t::zero and unifies_with(axiom) and not is_absurd(axiom);
             },
             [&] (extern_decl_t const& decl)
             {
                 using enum ast::is_mutable_t;
-                return task.is_mutable_allowed == yes and unifies_with(decl);
+                return is_mutable_allowed == yes and unifies_with(decl);
             },
             [&] (func_decl_t const& decl)
             {
                 using enum ast::is_mutable_t;
-                return (decl.signature.is_mutable == no or task.is_mutable_allowed == yes) and unifies_with(decl);
+                return (decl.signature.is_mutable == no or is_mutable_allowed == yes) and unifies_with(decl);
             },
             [&] (func_def_t const& def)
             {
                 using enum ast::is_mutable_t;
-                return (def.value.is_mutable == no or task.is_mutable_allowed == yes) and unifies_with(def);
+                return (def.value.is_mutable == no or is_mutable_allowed == yes) and unifies_with(def);
             });
         if (viable)
-            sub_tasks.push_back(search_task_t::create(
+            alternatives.emplace_back(
                 [&] { std::ostringstream os; ast::pretty_print<properties_t>(os, name); return os.str(); }(),
-                task.weak_from_this(),
-                task.state,
-                task.depth,
-                task.target,
-                task.is_mutable_allowed,
-                task.usage,
-                task.usage_multiplier,
                 [name] (search_task_t& t)
                 {
                     match(
@@ -243,8 +242,28 @@ void search_app(search_task_t& task)
                             // TODO pass result of unification to avoid duplicating work
                             try_apply(t, name, f.properties.sort.get());
                         });
-                }));
+                });
     }
+    return alternatives;
+}
+
+void search_app(search_task_t& task)
+{
+    auto alternatives =
+        search_app_alternatives(task.env, *task.target, task.is_mutable_allowed, task.usage_multiplier);
+    std::vector<std::shared_ptr<search_task_t>> sub_tasks;
+    sub_tasks.reserve(alternatives.size());
+    for (auto& [name, tactic]: alternatives)
+        sub_tasks.push_back(search_task_t::create(
+            std::move(name),
+            task.weak_from_this(),
+            task.state,
+            task.depth,
+            task.target,
+            task.is_mutable_allowed,
+            task.usage,
+            task.usage_multiplier,
+            std::move(tactic)));
     task.when_any(std::move(sub_tasks));
 }
 
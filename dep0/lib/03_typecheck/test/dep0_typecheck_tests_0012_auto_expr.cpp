@@ -9,6 +9,8 @@
 
 #include "typecheck_tests_fixture.hpp"
 
+#include <vector>
+
 using namespace dep0::testing;
 
 BOOST_FIXTURE_TEST_SUITE(dep0_typecheck_tests_0012_auto_expr, TypecheckTestsFixture)
@@ -269,5 +271,71 @@ BOOST_AUTO_TEST_CASE(typecheck_error_000) { BOOST_TEST(fail("0012_auto_expr/type
 BOOST_AUTO_TEST_CASE(typecheck_error_001) { BOOST_TEST(fail("0012_auto_expr/typecheck_error_001.depc")); }
 BOOST_AUTO_TEST_CASE(typecheck_error_002) { BOOST_TEST(fail("0012_auto_expr/typecheck_error_002.depc")); }
 BOOST_AUTO_TEST_CASE(typecheck_error_003) { BOOST_TEST(fail("0012_auto_expr/typecheck_error_003.depc")); }
+BOOST_AUTO_TEST_CASE(typecheck_error_004) { BOOST_TEST(fail("0012_auto_expr/typecheck_error_004.depc")); }
+BOOST_AUTO_TEST_CASE(typecheck_error_005) { BOOST_TEST(fail("0012_auto_expr/typecheck_error_005.depc")); }
+BOOST_AUTO_TEST_CASE(typecheck_error_006) { BOOST_TEST(fail("0012_auto_expr/typecheck_error_006.depc")); }
+
+BOOST_AUTO_TEST_CASE(out_of_fuel)
+{
+    options.proof_search.fuel = 0ul;
+    BOOST_TEST(fail("0012_auto_expr/pass_000.depc"));
+}
+
+BOOST_AUTO_TEST_CASE(fuel_override)
+{
+    // both `f` and `g` need proof search, for the array index and for the `auto` argument respectively
+    options.proof_search.fuel = 0ul;
+    options.proof_search_fuel_overrides["f"] = dep0::typecheck::proof_search_budget_t{}.fuel;
+    BOOST_TEST(fail("0012_auto_expr/pass_000.depc"));
+    options.proof_search_fuel_overrides["g"] = dep0::typecheck::proof_search_budget_t{}.fuel;
+    BOOST_TEST(pass("0012_auto_expr/pass_000.depc"));
+}
+
+BOOST_AUTO_TEST_CASE(parallel_search)
+{
+    // the proof found must be the same one found by a single thread, no matter how many threads are used
+    for (auto const threads: {2ul, 3ul, 8ul})
+    {
+        options.proof_search.threads = threads;
+        BOOST_TEST_REQUIRE(pass("0012_auto_expr/pass_000.depc"));
+        BOOST_TEST_REQUIRE(pass("0012_auto_expr/pass_007.depc"));
+        BOOST_TEST_REQUIRE(pass_result->entries.size() == 3ul);
+        auto const f = std::get_if<dep0::typecheck::func_def_t>(&pass_result->entries[2ul]);
+        BOOST_TEST_REQUIRE(f);
+        BOOST_TEST_REQUIRE(f->value.body.stmts.size() == 1ul);
+        BOOST_TEST(
+            is_return_of(f->value.body.stmts[0],
+            app_of(global("f2"), app_of(global("f1"), var("a"), var("b")))));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(profile)
+{
+    std::vector<dep0::typecheck::func_profile_t> profile;
+    options.profile = &profile;
+    BOOST_TEST_REQUIRE(pass("0012_auto_expr/pass_000.depc"));
+    BOOST_TEST_REQUIRE(profile.size() == 2ul);
+    BOOST_TEST(profile[0ul].name == "f");
+    BOOST_TEST(profile[1ul].name == "g");
+    // `g` must find a proof of `0 < n` to call `f`
+    BOOST_TEST(profile[1ul].proof_search_goals > 0ul);
+    BOOST_TEST(profile[1ul].proof_search_tasks > 0ul);
+    for (auto const& x: profile)
+        BOOST_TEST(x.time.count() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(profile_parallel_search)
+{
+    // searches run by the workers of a parallel search are part of the search that started them
+    std::vector<dep0::typecheck::func_profile_t> profile;
+    options.profile = &profile;
+    options.proof_search.threads = 8ul;
+    BOOST_TEST_REQUIRE(pass("0012_auto_expr/pass_007.depc"));
+    BOOST_TEST_REQUIRE(profile.size() == 3ul);
+    BOOST_TEST(profile[2ul].name == "f3");
+    BOOST_TEST(profile[2ul].proof_search_goals > 0ul);
+    for (auto const& x: profile)
+        BOOST_TEST(x.proof_search_time <= x.time);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
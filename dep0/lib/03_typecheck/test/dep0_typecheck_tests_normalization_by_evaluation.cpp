@@ -0,0 +1,297 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Compares the two beta-delta normalizers, `normalizer_t::substitution` and `normalizer_t::evaluation`.
+ * The corpus cases only require that both accept and reject the same files and that they produce alpha-equivalent
+ * functions; the other cases target the terms where the two algorithms take different paths,
+ * for example a function applied to free variables, which evaluation binds in an environment
+ * whereas substitution renames bound variables in place.
+ */
+#define BOOST_TEST_MODULE dep0_typecheck_tests_normalization_by_evaluation
+#include <boost/test/unit_test.hpp>
+
+#include "typecheck_tests_fixture.hpp"
+
+#include "dep0/typecheck/beta_delta_reduction.hpp"
+
+#include "dep0/parser/parse.hpp"
+
+#include "dep0/ast/alpha_equivalence.hpp"
+
+#include "dep0/match.hpp"
+#include "dep0/stats.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <vector>
+
+using namespace dep0::testing;
+
+using dep0::typecheck::normalizer_t;
+
+/** Return all test files whose name starts with the given prefix, relative to the given directory. */
+static std::vector<std::filesystem::path>
+find_testfiles(std::filesystem::path const& dir, std::string_view const prefix)
+{
+    std::vector<std::filesystem::path> result;
+    for (auto const& entry: std::filesystem::recursive_directory_iterator(dir))
+        if (entry.path().extension() == ".depc" and entry.path().filename().native().starts_with(prefix))
+            result.push_back(std::filesystem::relative(entry.path(), dir));
+    std::ranges::sort(result);
+    return result;
+}
+
+/** Collect, as expressions that can be compared, the types of all entries and the values of all functions. */
+static std::vector<dep0::typecheck::expr_t> collect_exprs(dep0::typecheck::module_t const& m)
+{
+    std::vector<dep0::typecheck::expr_t> result;
+    auto const add_sort = [&] (dep0::typecheck::sort_t const& sort)
+    {
+        if (auto const type = std::get_if<dep0::typecheck::expr_t>(&sort))
+            result.push_back(*type);
+    };
+    for (auto const& entry: m.entries)
+        dep0::match(
+            entry,
+            [&] (dep0::typecheck::axiom_t const& x) { add_sort(x.properties.sort.get()); },
+            [&] (dep0::typecheck::func_decl_t const& x) { add_sort(x.properties.sort.get()); },
+            [&] (dep0::typecheck::func_def_t const& x)
+            {
+                add_sort(x.properties.sort.get());
+                // alpha-equivalence ignores properties, so those of any expression will do
+                result.push_back(dep0::typecheck::expr_t{x.value.ret_type.get().properties, x.value});
+            },
+            [] (auto const&) { });
+    return result;
+}
+
+/** Typecheck the given source, which must not depend on the prelude, and normalize it with the given normalizer. */
+static std::optional<dep0::typecheck::module_t>
+check_and_normalize(dep0::source_text const& source, normalizer_t const normalizer)
+{
+    auto const parsed = dep0::parser::parse(source);
+    if (not parsed)
+        return std::nullopt;
+    auto options = dep0::typecheck::check_options_t{};
+    options.normalizer = normalizer;
+    auto checked = dep0::typecheck::check({}, *parsed, options);
+    if (not checked)
+        return std::nullopt;
+    auto const scope = dep0::typecheck::normalizer_scope_t(normalizer);
+    dep0::typecheck::beta_delta_normalize(*checked);
+    return std::move(*checked);
+}
+
+static boost::test_tools::predicate_result
+alpha_equivalent(dep0::typecheck::expr_t const& x, dep0::typecheck::expr_t const& y)
+{
+    auto const result = dep0::ast::is_alpha_equivalent(x, y);
+    if (result)
+        return true;
+    auto failed = boost::test_tools::predicate_result(false);
+    dep0::pretty_print(failed.message().stream(), result.error());
+    return failed;
+}
+
+/** Return the current value of the given statistic of the typechecker. */
+static std::uint64_t typecheck_stat(std::string_view const name)
+{
+    auto const stats = dep0::snapshot_stats();
+    auto const it = std::ranges::find_if(stats, [&] (dep0::stats_value_t const& x)
+    {
+        return x.component == "typecheck" and x.name == name;
+    });
+    return it == stats.end() ? 0ul : it->value;
+}
+
+BOOST_FIXTURE_TEST_SUITE(dep0_typecheck_tests_normalization_by_evaluation, TypecheckTestsFixture)
+
+BOOST_AUTO_TEST_CASE(pass_files)
+{
+    auto const files = find_testfiles(testfiles, "pass_");
+    BOOST_TEST_REQUIRE(not files.empty());
+    for (auto const& file: files)
+    {
+        BOOST_TEST_CONTEXT(file)
+        {
+            options.normalizer = normalizer_t::substitution;
+            BOOST_TEST(pass(file));
+            if (not pass_result)
+                continue;
+            auto expected = std::move(*pass_result);
+            pass_result.reset();
+            options.normalizer = normalizer_t::evaluation;
+            BOOST_TEST(pass(file));
+            if (not pass_result)
+                continue;
+            auto actual = std::move(*pass_result);
+            pass_result.reset();
+            {
+                auto const scope = dep0::typecheck::normalizer_scope_t(normalizer_t::substitution);
+                dep0::typecheck::beta_delta_normalize(expected);
+            }
+            {
+                auto const scope = dep0::typecheck::normalizer_scope_t(normalizer_t::evaluation);
+                dep0::typecheck::beta_delta_normalize(actual);
+            }
+            auto const xs = collect_exprs(expected);
+            auto const ys = collect_exprs(actual);
+            BOOST_TEST_REQUIRE(xs.size() == ys.size());
+            for (auto const i: std::views::iota(0ul, xs.size()))
+                BOOST_TEST(alpha_equivalent(xs[i], ys[i]));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(typecheck_files)
+{
+    auto const files = find_testfiles(testfiles, "typecheck_");
+    BOOST_TEST_REQUIRE(not files.empty());
+    for (auto const& file: files)
+    {
+        BOOST_TEST_CONTEXT(file)
+        {
+            options.normalizer = normalizer_t::substitution;
+            BOOST_TEST(fail(file));
+            options.normalizer = normalizer_t::evaluation;
+            BOOST_TEST(fail(file));
+        }
+    }
+}
+
+/**
+ * Once an application has been reduced, its function is an abstraction without arguments and so is its Pi-Type;
+ * the return type of the latter must not refer to the arguments that have just been consumed.
+ * The body of `f` has two return statements, so the call in `g` is still an application after normalization.
+ */
+BOOST_AUTO_TEST_CASE(function_type_after_application)
+{
+    auto const source = dep0::source_text::from_literal(R"(
+func f(typename t, bool_t b, t x, t y) -> t
+{
+    if (b)
+        return x;
+    return y;
+}
+
+func g(bool_t b) -> i32_t
+{
+    return f(i32_t, b, 1, 2);
+}
+)");
+    for (auto const normalizer: {normalizer_t::substitution, normalizer_t::evaluation})
+    {
+        BOOST_TEST_CONTEXT((normalizer == normalizer_t::substitution ? "substitution" : "evaluation"))
+        {
+            auto const checked = check_and_normalize(source, normalizer);
+            BOOST_TEST_REQUIRE(checked.has_value());
+            BOOST_TEST_REQUIRE(checked->entries.size() == 2ul);
+            auto const g = std::get_if<dep0::typecheck::func_def_t>(&checked->entries[1ul]);
+            BOOST_TEST_REQUIRE(g);
+            BOOST_TEST_REQUIRE(g->value.body.stmts.size() == 1ul);
+            auto const ret = std::get_if<dep0::typecheck::stmt_t::return_t>(&g->value.body.stmts[0ul].value);
+            BOOST_TEST_REQUIRE((ret and ret->expr));
+            auto const app = std::get_if<dep0::typecheck::expr_t::app_t>(&ret->expr->value);
+            BOOST_TEST_REQUIRE(app);
+            BOOST_TEST(app->args.empty());
+            auto const type = std::get_if<dep0::typecheck::expr_t>(&app->func.get().properties.sort.get());
+            BOOST_TEST_REQUIRE(type);
+            auto const pi = std::get_if<dep0::typecheck::expr_t::pi_t>(&type->value);
+            BOOST_TEST_REQUIRE(pi);
+            BOOST_TEST(pi->args.empty());
+            BOOST_TEST(is_i32(pi->ret_type.get()));
+        }
+    }
+}
+
+/**
+ * `make(u)` is an open term in `g`: the argument is the free variable `u`, which has the same name as the variable
+ * bound by the Pi-Type returned by `make`; so the bound variable must be renamed, whether it is substituted into
+ * or evaluated under a binding, and the free one must still refer to the argument of `g`.
+ */
+BOOST_AUTO_TEST_CASE(open_term_with_same_name_as_bound_variable)
+{
+    auto const source = dep0::source_text::from_literal(R"(
+func make(typename t) -> typename
+{
+    return (typename u, t) -> u;
+}
+
+func g(typename u) -> typename
+{
+    return make(u);
+}
+)");
+    std::vector<dep0::typecheck::expr_t> results;
+    for (auto const normalizer: {normalizer_t::substitution, normalizer_t::evaluation})
+    {
+        BOOST_TEST_CONTEXT((normalizer == normalizer_t::substitution ? "substitution" : "evaluation"))
+        {
+            auto const checked = check_and_normalize(source, normalizer);
+            BOOST_TEST_REQUIRE(checked.has_value());
+            BOOST_TEST_REQUIRE(checked->entries.size() == 2ul);
+            auto const g = std::get_if<dep0::typecheck::func_def_t>(&checked->entries[1ul]);
+            BOOST_TEST_REQUIRE(g);
+            BOOST_TEST_REQUIRE(g->value.args.size() == 1ul);
+            BOOST_TEST_REQUIRE(g->value.args[0ul].var.has_value());
+            auto const& u = *g->value.args[0ul].var;
+            BOOST_TEST_REQUIRE(g->value.body.stmts.size() == 1ul);
+            auto const ret = std::get_if<dep0::typecheck::stmt_t::return_t>(&g->value.body.stmts[0ul].value);
+            BOOST_TEST_REQUIRE((ret and ret->expr));
+            auto const pi = std::get_if<dep0::typecheck::expr_t::pi_t>(&ret->expr->value);
+            BOOST_TEST_REQUIRE(pi);
+            BOOST_TEST_REQUIRE(pi->args.size() == 2ul);
+            BOOST_TEST_REQUIRE(pi->args[0ul].var.has_value());
+            auto const& bound = *pi->args[0ul].var;
+            BOOST_TEST((bound != u));
+            auto const free = std::get_if<dep0::typecheck::expr_t::var_t>(&pi->args[1ul].type.value);
+            BOOST_TEST_REQUIRE(free);
+            BOOST_TEST((*free == u));
+            auto const ret_type = std::get_if<dep0::typecheck::expr_t::var_t>(&pi->ret_type.get().value);
+            BOOST_TEST_REQUIRE(ret_type);
+            BOOST_TEST((*ret_type == bound));
+            results.push_back(*ret->expr);
+        }
+    }
+    BOOST_TEST_REQUIRE(results.size() == 2ul);
+    BOOST_TEST(alpha_equivalent(results[0ul], results[1ul]));
+}
+
+/** Both normalizers must report the steps they take, so that `--stats` is meaningful whichever one is used. */
+BOOST_AUTO_TEST_CASE(steps_are_counted)
+{
+    auto const source = dep0::source_text::from_literal(R"(
+func f(i32_t x) -> i32_t
+{
+    return x;
+}
+
+func g() -> i32_t
+{
+    return f(1);
+}
+)");
+    for (auto const normalizer: {normalizer_t::substitution, normalizer_t::evaluation})
+    {
+        BOOST_TEST_CONTEXT((normalizer == normalizer_t::substitution ? "substitution" : "evaluation"))
+        {
+            dep0::reset_stats();
+            dep0::enable_stats();
+            BOOST_TEST(check_and_normalize(source, normalizer).has_value());
+            dep0::enable_stats(false);
+            BOOST_TEST(typecheck_stat("delta_steps") > 0ul);
+            BOOST_TEST(typecheck_stat("beta_steps") > 0ul);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,188 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Checks that every module that typechecks survives a round-trip through `serialize()` and `deserialize()`,
+ * also via files, and that images which are malformed or of a different format version are rejected.
+ */
+#define BOOST_TEST_MODULE dep0_typecheck_tests_serialization
+#include <boost/test/unit_test.hpp>
+
+#include "typecheck_tests_fixture.hpp"
+
+#include "dep0/typecheck/environment.hpp"
+#include "dep0/typecheck/serialization.hpp"
+
+#include "dep0/parser/parse.hpp"
+
+#include "dep0/ast/pretty_print.hpp"
+
+#include "dep0/source.hpp"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dep0::testing;
+
+static dep0::typecheck::env_t const& get_base_env()
+{
+    static auto const env = std::move(dep0::typecheck::make_base_env().value());
+    return env;
+}
+
+/** Return all test files that are expected to pass, relative to the given directory. */
+static std::vector<std::filesystem::path> find_pass_testfiles(std::filesystem::path const& dir)
+{
+    std::vector<std::filesystem::path> result;
+    for (auto const& entry: std::filesystem::recursive_directory_iterator(dir))
+        if (entry.path().extension() == ".depc" and entry.path().filename().native().starts_with("pass_"))
+            result.push_back(std::filesystem::relative(entry.path(), dir));
+    std::ranges::sort(result);
+    return result;
+}
+
+/** Wrap the given image in a `dep0::source_text`, which keeps it alive for as long as it is referred to. */
+static dep0::source_text to_source_text(std::string image)
+{
+    auto const buffer = std::make_shared<std::string const>(std::move(image));
+    return dep0::source_text(dep0::make_source_handle<std::shared_ptr<std::string const>>(buffer), *buffer);
+}
+
+static std::string to_string(dep0::typecheck::module_t const& m)
+{
+    std::ostringstream str;
+    dep0::ast::pretty_print(str, m);
+    return str.str();
+}
+
+static char const* const library_source = R"depc(
+func answer() -> i32_t
+{
+    return 42;
+}
+)depc";
+
+static char const* const user_source = R"depc(
+func question() -> i32_t
+{
+    return lib::answer();
+}
+)depc";
+
+BOOST_FIXTURE_TEST_SUITE(dep0_typecheck_tests_serialization, TypecheckTestsFixture)
+
+BOOST_AUTO_TEST_CASE(round_trip_all_files)
+{
+    auto const files = find_pass_testfiles(testfiles);
+    BOOST_TEST_REQUIRE(not files.empty());
+    for (auto const& file: files)
+    {
+        // some files only pass the parser but not the typechecker, so they are of no interest here
+        if (not pass(file))
+            continue;
+        BOOST_TEST_CONTEXT(file)
+        {
+            auto const image = dep0::typecheck::serialize(*pass_result);
+            auto const loaded = dep0::typecheck::deserialize(get_base_env(), to_source_text(image));
+            BOOST_TEST_REQUIRE(loaded.has_value());
+            BOOST_TEST(to_string(*pass_result) == to_string(*loaded));
+            // serializing again must produce exactly the same bytes, so nothing was lost or altered
+            BOOST_TEST((dep0::typecheck::serialize(*loaded) == image));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(import_from_file)
+{
+    auto const library = dep0::parser::parse(dep0::source_text::from_literal(library_source));
+    BOOST_TEST_REQUIRE(library.has_value());
+    auto const checked = dep0::typecheck::check(get_base_env(), *library);
+    BOOST_TEST_REQUIRE(checked.has_value());
+
+    auto const path = std::filesystem::temp_directory_path() / "dep0_typecheck_tests_serialization.dep0mod";
+    BOOST_TEST_REQUIRE(dep0::typecheck::write_image(path, *checked).has_value());
+    auto const loaded = dep0::typecheck::read_image(get_base_env(), path);
+    std::filesystem::remove(path);
+    BOOST_TEST_REQUIRE(loaded.has_value());
+    BOOST_TEST(to_string(*checked) == to_string(*loaded));
+
+    auto env = get_base_env().extend();
+    BOOST_TEST_REQUIRE(env.import(dep0::source_text::from_literal("lib"), *loaded).has_value());
+    auto const user = dep0::parser::parse(dep0::source_text::from_literal(user_source));
+    BOOST_TEST_REQUIRE(user.has_value());
+    BOOST_TEST(dep0::typecheck::check(env, *user).has_value());
+    BOOST_TEST(dep0::typecheck::check(get_base_env(), *user).has_error());
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_writes)
+{
+    auto const library = dep0::parser::parse(dep0::source_text::from_literal(library_source));
+    BOOST_TEST_REQUIRE(library.has_value());
+    auto const checked = dep0::typecheck::check(get_base_env(), *library);
+    BOOST_TEST_REQUIRE(checked.has_value());
+
+    // every writer uses its own temporary file, so the image is always one of them in full and none is left behind
+    auto const dir = std::filesystem::temp_directory_path() / "dep0_typecheck_tests_serialization_concurrent";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directory(dir);
+    auto const path = dir / "lib.dep0mod";
+    std::array<bool, 8ul> written{}; // not `std::vector<bool>`, whose elements cannot be written concurrently
+    {
+        std::vector<std::jthread> writers;
+        for (auto i = 0ul; i < written.size(); ++i)
+            writers.emplace_back([&, i]
+            {
+                bool ok = true;
+                for (auto j = 0; j < 10; ++j)
+                    ok = dep0::typecheck::write_image(path, *checked).has_value() and ok;
+                written[i] = ok;
+            });
+    }
+    BOOST_TEST(std::ranges::all_of(written, [] (bool const x) { return x; }));
+    auto const loaded = dep0::typecheck::read_image(get_base_env(), path);
+    BOOST_TEST_REQUIRE(loaded.has_value());
+    BOOST_TEST(to_string(*checked) == to_string(*loaded));
+    auto const num_files =
+        std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator());
+    std::filesystem::remove_all(dir);
+    BOOST_TEST(num_files == 1);
+}
+
+BOOST_AUTO_TEST_CASE(reject_bad_images)
+{
+    auto const library = dep0::parser::parse(dep0::source_text::from_literal(library_source));
+    BOOST_TEST_REQUIRE(library.has_value());
+    auto const checked = dep0::typecheck::check(get_base_env(), *library);
+    BOOST_TEST_REQUIRE(checked.has_value());
+    auto const image = dep0::typecheck::serialize(*checked);
+
+    auto other_version = image;
+    other_version[8] ^= 0xff; // the first byte of the format version, after the magic bytes `dep0.mod`
+    BOOST_TEST(dep0::typecheck::deserialize(get_base_env(), to_source_text(other_version)).has_error());
+
+    auto bad_magic = image;
+    bad_magic[0] = 'X';
+    BOOST_TEST(dep0::typecheck::deserialize(get_base_env(), to_source_text(bad_magic)).has_error());
+
+    for (auto const size: {0ul, 4ul, 12ul, image.size() / 2ul, image.size() - 1ul})
+        BOOST_TEST_CONTEXT("truncated to " << size << " bytes")
+        {
+            auto const truncated = image.substr(0ul, size);
+            BOOST_TEST(dep0::typecheck::deserialize(get_base_env(), to_source_text(truncated)).has_error());
+        }
+
+    BOOST_TEST(dep0::typecheck::read_image(get_base_env(), testfiles / "does_not_exist.dep0mod").has_error());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
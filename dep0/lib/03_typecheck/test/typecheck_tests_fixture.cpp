@@ -33,7 +33,7 @@ boost::test_tools::predicate_result TypecheckTestsFixture::pass(std::filesystem:
         dep0::pretty_print(res.message().stream(), parse_result.error());
         return res;
     }
-    auto check_result = dep0::typecheck::check(get_base_env(), *parse_result);
+    auto check_result = dep0::typecheck::check(get_base_env(), *parse_result, options);
     if (check_result.has_error())
     {
         auto res = boost::test_tools::predicate_result(false);
@@ -53,7 +53,7 @@ boost::test_tools::predicate_result TypecheckTestsFixture::fail(std::filesystem:
         dep0::pretty_print(res.message().stream(), parse_result.error());
         return res;
     }
-    auto check_result = dep0::typecheck::check(get_base_env(), *parse_result);
+    auto check_result = dep0::typecheck::check(get_base_env(), *parse_result, options);
     if (check_result.has_value())
     {
         auto res = boost::test_tools::predicate_result(false);
@@ -7,6 +7,7 @@
 #pragma ocne
 
 #include "dep0/typecheck/ast.hpp"
+#include "dep0/typecheck/check.hpp"
 #include "dep0/testing/ast_predicates.hpp"
 
 #include "dep0/error.hpp"
@@ -23,6 +24,8 @@ struct TypecheckTestsFixture
 {
     std::filesystem::path testfiles = std::getenv("DEP0_TESTFILES_DIR");
 
+    dep0::typecheck::check_options_t options;
+
     std::optional<dep0::typecheck::module_t> pass_result;
     std::optional<dep0::error_t> fail_result;
 
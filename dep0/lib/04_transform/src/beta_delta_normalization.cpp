@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -8,11 +8,18 @@
 
 #include "dep0/typecheck/beta_delta_reduction.hpp"
 
+#include "dep0/stats.hpp"
+
 namespace dep0::transform {
 
+static stats_counter_t num_runs("transform", "beta_delta_normalization_runs");
+static stats_counter_t num_changed("transform", "beta_delta_normalization_changed_modules");
+
 expected<std::true_type> beta_delta_normalization_t::operator()(typecheck::module_t& m) const
 {
-    beta_delta_normalize(m);
+    num_runs.add();
+    if (beta_delta_normalize(m))
+        num_changed.add();
     return std::true_type{};
 }
 
@@ -0,0 +1,48 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Declares `dep0::llvmgen::func_cache_t`.
+ */
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace dep0::llvmgen {
+
+/**
+ * @brief On-disk cache of the LLVM IR generated for individual functions, shared by all runs of the compiler.
+ *
+ * Each entry contains the LLVM bitcode of a single function definition and it is stored in its own file,
+ * whose name is a content hash of everything that the generated code depends on, as computed by `gen()`;
+ * so entries never need to be invalidated: if a function or any of its dependencies change, its key changes too.
+ *
+ * Entries are first written to a temporary file and then renamed,
+ * so that multiple compiler processes can safely share the same cache directory.
+ * Failing to read or write an entry is never an error: it is simply treated as a cache miss.
+ */
+class func_cache_t
+{
+    std::filesystem::path m_dir;
+
+public:
+    /** @brief Use the given directory for the cache; it is created on first store, if it does not exist yet. */
+    explicit func_cache_t(std::filesystem::path dir);
+
+    std::filesystem::path const& dir() const { return m_dir; }
+
+    /** @brief Return the content of the entry with the given key, or an empty optional if there is none. */
+    std::optional<std::string> load(std::string_view key) const;
+
+    /** @brief Store a new entry with the given key, replacing the old one if it already exists. */
+    void store(std::string_view key, std::string_view content) const;
+};
+
+} // namespace dep0::llvmgen
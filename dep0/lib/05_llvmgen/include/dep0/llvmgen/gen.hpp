@@ -10,6 +10,8 @@
  */
 #pragma once
 
+#include "dep0/llvmgen/func_cache.hpp"
+
 #include "dep0/typecheck/ast.hpp"
 
 #include "dep0/error.hpp"
@@ -29,6 +31,9 @@ namespace dep0::llvmgen {
  *
  * @param ctx           The LLVM context used during codegen; it holds LLVM types, the target machine, etc.
  * @param module_name   The name to assign to the generated LLVM module.
+ * @param cache
+ *      If not `nullptr`, the LLVM IR of each function definition is looked up in this cache first and,
+ *      if found, it is reused rather than generated again; functions not found are added to the cache.
  *
  * @remarks
  *      This function cannot simply return an `expected<llvm::Module>` because
@@ -36,7 +41,12 @@ namespace dep0::llvmgen {
  *      can be invalidated if the llvm module gets moved around.
  */
 expected<unique_ref<llvm::Module>>
-gen(llvm::LLVMContext& ctx, std::string_view module_name, typecheck::module_t const&, llvm::TargetMachine&) noexcept;
+gen(
+    llvm::LLVMContext& ctx,
+    std::string_view module_name,
+    typecheck::module_t const&,
+    llvm::TargetMachine&,
+    func_cache_t const* cache = nullptr) noexcept;
 
 /**
  * @brief Like `gen()` but the generated LLVM module is unverified so it may be invalid.
@@ -8,33 +8,8 @@
 
 #include "private/gen_array.hpp"
 
-#include "dep0/ast/alpha_equivalence.hpp"
-
 namespace dep0::llvmgen {
 
-// TODO duplicated from proof_search.cpp; should we extract something in common?
-bool global_ctx_t::eq_t::operator()(typecheck::expr_t const& x, typecheck::expr_t const& y) const
-{
-    // TODO should this be beta-delta equivalence instead? needs a test
-    return ast::is_alpha_equivalent(x, y).has_value()
-        and std::visit(
-            boost::hana::overload(
-                [] (typecheck::expr_t const& x_type, typecheck::expr_t const& y_type)
-                {
-                    return ast::is_alpha_equivalent(x_type, y_type).has_value();
-                },
-                [] (typecheck::kind_t, typecheck::kind_t)
-                {
-                    return true;
-                },
-                [] <typename T, typename U> requires (not std::is_same_v<T, U>)
-                (T const&, U const&)
-                {
-                    return false;
-                }),
-            x.properties.sort.get(), y.properties.sort.get());
-}
-
 global_ctx_t::global_ctx_t(typecheck::env_t const& env, llvm::Module& m) :
     llvm_ctx(m.getContext()),
     llvm_module(m),
@@ -53,34 +28,42 @@ global_ctx_t::value_t const* global_ctx_t::operator[](typecheck::expr_t::global_
     return values[k];
 }
 
-std::optional<llvm_func_t> global_ctx_t::get_destructor(typecheck::expr_t const& type) const
+typecheck::interned_expr_t global_ctx_t::intern_type(typecheck::expr_t const& type)
 {
-    std::optional<llvm_func_t> result;
     if (auto const because = std::get_if<typecheck::expr_t::because_t>(&type.value))
-        result = get_destructor(because->value.get());
-    else if (auto const properties = get_properties_if_array(type))
-    {
-        auto const it = array_destructors.find(properties->element_type);
-        if (it != array_destructors.end())
-            result.emplace(it->second);
-    }
-    else
+        return intern_type(because->value.get());
+    auto const old_size = destructor_types.size();
+    auto const id = destructor_types.intern(type);
+    if (destructor_types.size() > old_size)
+        if (auto const properties = get_properties_if_array(destructor_types[id]))
+            array_element_types.emplace(id, intern_type(properties->element_type));
+    return id;
+}
+
+typecheck::expr_t const& global_ctx_t::interned_type(typecheck::interned_expr_t const type) const
+{
+    return destructor_types[type];
+}
+
+std::optional<llvm_func_t> global_ctx_t::get_destructor(typecheck::interned_expr_t const type) const
+{
+    std::optional<llvm_func_t> result;
+    if (auto const element = array_element_types.find(type); element != array_element_types.end())
     {
-        auto const it = non_array_destructors.find(type);
-        if (it != non_array_destructors.end())
+        if (auto const it = array_destructors.find(element->second); it != array_destructors.end())
             result.emplace(it->second);
     }
+    else if (auto const it = non_array_destructors.find(type); it != non_array_destructors.end())
+        result.emplace(it->second);
     return result;
 }
 
-void global_ctx_t::store_destructor(typecheck::expr_t type, llvm_func_t func)
+void global_ctx_t::store_destructor(typecheck::interned_expr_t const type, llvm_func_t const func)
 {
-    if (auto const because = std::get_if<typecheck::expr_t::because_t>(&type.value))
-        store_destructor(std::move(because->value.get()), func);
-    else if (auto const properties = get_properties_if_array(type))
-        array_destructors.emplace(properties->element_type, std::move(func));
+    if (auto const element = array_element_types.find(type); element != array_element_types.end())
+        array_destructors.emplace(element->second, func);
     else
-        non_array_destructors.emplace(std::move(type), std::move(func));
+        non_array_destructors.emplace(type, func);
 }
 
 llvm::Constant* global_ctx_t::get_string_literal(typecheck::expr_t::string_literal_t const& s) const
@@ -0,0 +1,51 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "dep0/llvmgen/func_cache.hpp"
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace dep0::llvmgen {
+
+func_cache_t::func_cache_t(std::filesystem::path dir) :
+    m_dir(std::move(dir))
+{ }
+
+std::optional<std::string> func_cache_t::load(std::string_view const key) const
+{
+    auto buffer = llvm::MemoryBuffer::getFile((m_dir / key).native());
+    if (not buffer)
+        return std::nullopt;
+    return std::string((*buffer)->getBuffer());
+}
+
+void func_cache_t::store(std::string_view const key, std::string_view const content) const
+{
+    if (llvm::sys::fs::create_directories(m_dir.native()))
+        return;
+    int fd;
+    llvm::SmallString<128> tmp;
+    if (llvm::sys::fs::createUniqueFile((m_dir / key).native() + ".tmp-%%%%%%%%", fd, tmp))
+        return;
+    {
+        llvm::raw_fd_ostream os(fd, /*shouldClose*/ true);
+        os << llvm::StringRef(content.data(), content.size());
+        os.close();
+        if (os.has_error())
+        {
+            os.clear_error();
+            llvm::sys::fs::remove(tmp);
+            return;
+        }
+    }
+    if (llvm::sys::fs::rename(tmp, (m_dir / key).native()))
+        llvm::sys::fs::remove(tmp);
+}
+
+} // namespace dep0::llvmgen
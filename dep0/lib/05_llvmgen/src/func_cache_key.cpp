@@ -0,0 +1,71 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "private/func_cache_key.hpp"
+
+#include "dep0/ast/globals_in.hpp"
+#include "dep0/ast/pretty_print.hpp"
+
+#include "dep0/match.hpp"
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/SHA1.h>
+
+#include <set>
+#include <sstream>
+
+namespace dep0::llvmgen {
+
+std::string func_cache_key(
+    typecheck::env_t const& env,
+    typecheck::func_def_t const& def,
+    llvm::Module const& llvm_module)
+{
+    using globals_t = std::set<typecheck::expr_t::global_t>;
+    std::ostringstream os;
+    // generated by the llvmgen build, so that cache entries produced by a different code generator are never used
+    os << "llvmgen " << DEP0_LLVMGEN_BUILD_ID << '\n';
+    os << "llvm " << LLVM_VERSION_STRING << '\n';
+    os << llvm_module.getTargetTriple() << '\n' << llvm_module.getDataLayoutStr() << '\n';
+    ast::pretty_print<typecheck::properties_t>(os, def) << '\n';
+    globals_t pending, visited;
+    ast::globals_in<typecheck::properties_t>(
+        def.value.args.begin(), def.value.args.end(), def.value.ret_type.get(), &def.value.body, pending);
+    // both sets are ordered, so dependencies are always visited in the same order and the key is reproducible
+    while (not pending.empty())
+    {
+        auto const g = std::move(pending.extract(pending.begin()).value());
+        if (not visited.insert(g).second)
+            continue;
+        ast::pretty_print<typecheck::properties_t>(os, g) << " = ";
+        if (auto const x = env[g])
+            match(
+                *x,
+                [&] (typecheck::env_t::incomplete_type_t const&)
+                {
+                    os << "<incomplete type>";
+                },
+                [&] (typecheck::type_def_t const& t)
+                {
+                    ast::pretty_print<typecheck::properties_t>(os, t);
+                    if (auto const s = std::get_if<typecheck::type_def_t::struct_t>(&t.value))
+                        ast::globals_in<typecheck::properties_t>(s->fields.begin(), s->fields.end(), pending);
+                },
+                [&] (auto const& f)
+                {
+                    auto const& type = std::get<typecheck::expr_t>(f.properties.sort.get());
+                    ast::pretty_print<typecheck::properties_t>(os, type);
+                    ast::globals_in(type, pending);
+                });
+        else
+            os << "<unknown>";
+        os << '\n';
+    }
+    return llvm::toHex(llvm::SHA1::hash(llvm::arrayRefFromStringRef(os.str())), /*LowerCase*/ true);
+}
+
+} // namespace dep0::llvmgen
@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -8,19 +8,52 @@
 
 #include "private/context.hpp"
 #include "private/first_order_types.hpp"
+#include "private/func_cache_key.hpp"
 #include "private/gen_func.hpp"
 #include "private/gen_type.hpp"
 #include "private/proto.hpp"
 
 #include "dep0/fmap.hpp"
 #include "dep0/match.hpp"
+#include "dep0/stats.hpp"
 
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace dep0::llvmgen {
 
+static stats_counter_t num_modules("llvmgen", "modules");
+static stats_counter_t num_funcs("llvmgen", "funcs");
+static stats_counter_t num_instructions("llvmgen", "instructions");
+static stats_maximum_t max_instructions_per_func("llvmgen", "max_instructions_per_func");
+static stats_counter_t num_cache_hits("llvmgen", "func_cache_hits");
+static stats_counter_t num_cache_misses("llvmgen", "func_cache_misses");
+
+/** Record the size of all functions defined in the given module. */
+static void record_stats(llvm::Module const& llvm_module)
+{
+    if (not stats_enabled())
+        return;
+    num_modules.add();
+    for (auto const& f: llvm_module)
+        if (not f.isDeclaration())
+        {
+            auto const n = f.getInstructionCount();
+            num_funcs.add();
+            num_instructions.add(n);
+            max_instructions_per_func.record(n);
+        }
+}
+
 static unique_ref<llvm::Module>
 build_empty_module(
     llvm::LLVMContext& llvm_ctx,
@@ -33,7 +66,67 @@ build_empty_module(
     return m;
 }
 
-static expected<std::true_type> gen_impl(llvm::Module& llvm_module, typecheck::module_t const& m) noexcept
+/** Keeps track of the functions that `gen_impl()` found in the cache and of those that must be added to it. */
+struct cache_usage_t
+{
+    func_cache_t const* cache;
+    std::vector<std::unique_ptr<llvm::Module>> hits; /**< One module for each function found in the cache. */
+    std::vector<std::pair<std::string, std::string>> misses; /**< Key and LLVM name of each function not found. */
+};
+
+static std::unique_ptr<llvm::Module>
+load_cached_func(func_cache_t const& cache, std::string const& key, llvm::LLVMContext& llvm_ctx)
+{
+    auto const content = cache.load(key);
+    if (not content)
+        return nullptr;
+    auto m = llvm::parseBitcodeFile(llvm::MemoryBufferRef(*content, key), llvm_ctx);
+    if (not m)
+    {
+        // a corrupted entry is just a cache miss, it will be overwritten with a good one
+        llvm::consumeError(m.takeError());
+        return nullptr;
+    }
+    return std::move(*m);
+}
+
+/**
+ * Return the bitcode of a copy of the given module that only contains the definition of the given function,
+ * together with the private helpers used by it, for example anonymous functions and string literals;
+ * all other functions are only declared.
+ */
+static std::string extract_func(llvm::Module const& llvm_module, llvm::StringRef const name)
+{
+    auto const clone = llvm::CloneModule(llvm_module);
+    for (auto& f: clone->functions())
+        if (not f.isDeclaration() and not f.hasLocalLinkage() and f.getName() != name)
+            f.deleteBody();
+    // removing the private helpers of other functions may leave more helpers unused, so repeat until none is left
+    for (bool erased = true; erased;)
+    {
+        erased = false;
+        for (auto& f: llvm::make_early_inc_range(clone->functions()))
+            if (f.hasLocalLinkage() and (f.removeDeadConstantUsers(), f.use_empty()))
+            {
+                f.eraseFromParent();
+                erased = true;
+            }
+        for (auto& g: llvm::make_early_inc_range(clone->globals()))
+            if (g.hasLocalLinkage() and (g.removeDeadConstantUsers(), g.use_empty()))
+            {
+                g.eraseFromParent();
+                erased = true;
+            }
+    }
+    std::string bitcode;
+    llvm::raw_string_ostream os(bitcode);
+    llvm::WriteBitcodeToFile(*clone, os);
+    os.flush();
+    return bitcode;
+}
+
+static expected<std::true_type>
+gen_impl(llvm::Module& llvm_module, typecheck::module_t const& m, cache_usage_t& cache_usage) noexcept
 {
     global_ctx_t global(m.properties.env.get(), llvm_module);
     for (auto const& x: m.entries)
@@ -85,26 +178,55 @@ static expected<std::true_type> gen_impl(llvm::Module& llvm_module, typecheck::m
             },
             [&] (typecheck::func_def_t const& def)
             {
-                if (auto proto = llvm_func_proto_t::from_abs(def.value))
-                    gen_func(global, typecheck::expr_t::global_t{std::nullopt, def.name}, *proto, def.value);
+                auto proto = llvm_func_proto_t::from_abs(def.value);
+                if (not proto)
+                    return;
+                auto const name = typecheck::expr_t::global_t{std::nullopt, def.name};
+                if (cache_usage.cache)
+                {
+                    auto key = func_cache_key(global.env, def, llvm_module);
+                    if (auto hit = load_cached_func(*cache_usage.cache, key, global.llvm_ctx))
+                    {
+                        // only declare it for now, its definition is linked in from the cache at the end
+                        gen_func_decl(global, name, *proto);
+                        cache_usage.hits.push_back(std::move(hit));
+                        num_cache_hits.add();
+                        return;
+                    }
+                    cache_usage.misses.emplace_back(std::move(key), def.name.view());
+                    num_cache_misses.add();
+                }
+                gen_func(global, name, *proto, def.value);
             });
     }
     return {};
 }
 
 expected<unique_ref<llvm::Module>>
-gen(llvm::LLVMContext& llvm_ctx, std::string_view const name, typecheck::module_t const& m,
-    llvm::TargetMachine& machine) noexcept
+gen(
+    llvm::LLVMContext& llvm_ctx,
+    std::string_view const name,
+    typecheck::module_t const& m,
+    llvm::TargetMachine& machine,
+    func_cache_t const* const cache) noexcept
 {
     auto result = build_empty_module(llvm_ctx, name, machine);
-    if (auto ok = gen_impl(*result, m); not ok)
+    auto cache_usage = cache_usage_t{cache};
+    if (auto ok = gen_impl(*result, m, cache_usage); not ok)
         return std::move(ok.error());
+    // Linking replaces the declarations emitted by `gen_impl()` with new functions,
+    // which would leave dangling pointers inside the global context; so it can only be done here, once it is gone.
+    for (auto& hit: cache_usage.hits)
+        if (llvm::Linker::linkModules(*result, std::move(hit)))
+            return error_t{"failed to link function loaded from cache directory " + cache->dir().native()};
     std::string err;
     llvm::raw_string_ostream ostream(err);
     if (llvm::verifyModule(*result, &ostream)) // yes true means false...
         return error_t{err};
-    else
-        return std::move(result);
+    for (auto const& [key, func_name]: cache_usage.misses)
+        cache->store(key, extract_func(*result, func_name));
+    record_stats(*result);
+    return std::move(result);
 }
 
 expected<unique_ref<llvm::Module>>
@@ -115,8 +237,10 @@ gen_unverified(
     llvm::TargetMachine& machine) noexcept
 {
     auto result = build_empty_module(llvm_ctx, name, machine);
-    if (auto ok = gen_impl(*result, m); not ok)
+    auto cache_usage = cache_usage_t{nullptr};
+    if (auto ok = gen_impl(*result, m, cache_usage); not ok)
         return std::move(ok.error());
+    record_stats(*result);
     return std::move(result);
 }
 
@@ -43,8 +43,10 @@ static llvm_func_t gen_destructor(global_ctx_t&, typecheck::expr_t const&);
  *
  * @remarks If this is the first time this function is called for the given type,
  * a new destructor function will be emitted and registered in the global context.
+ * The type must have been interned via `global_ctx_t::intern_type()`.
  */
-static void gen_destructor_call(global_ctx_t&, local_ctx_t&, llvm::IRBuilder<>&, llvm::Value*, typecheck::expr_t const&);
+static void gen_destructor_call(
+    global_ctx_t&, local_ctx_t&, llvm::IRBuilder<>&, llvm::Value*, typecheck::interned_expr_t);
 
 /**
  * @brief Generate IR code for a DepC statement.
@@ -182,12 +184,13 @@ static llvm_func_t gen_destructor(global_ctx_t& global, typecheck::expr_t const&
                                 {
                                     auto const element_ptr = builder.CreateLoad(gen_type(global, ty), gep(i));
                                     if (not is_trivially_destructible(global, ty))
-                                        gen_destructor_call(global, struct_ctx, builder, element_ptr, ty);
+                                        gen_destructor_call(
+                                            global, struct_ctx, builder, element_ptr, global.intern_type(ty));
                                     auto const free = llvm::CallInst::CreateFree(element_ptr, builder.GetInsertBlock());
                                     builder.GetInsertBlock()->getInstList().push_back(free);
                                 }
                                 else if (not is_trivially_destructible(global, ty))
-                                    gen_destructor_call(global, struct_ctx, builder, gep(i), ty);
+                                    gen_destructor_call(global, struct_ctx, builder, gep(i), global.intern_type(ty));
                             }
                             assert(struct_ctx.destructors.empty() and "destructors must not allocate");
                         });
@@ -203,7 +206,7 @@ static llvm_func_t gen_destructor(global_ctx_t& global, typecheck::expr_t const&
                 llvm_f->getArg(1),
                 builder.getInt64(0),
                 [
-                    &element_type=properties->element_type,
+                    element_type=global.intern_type(properties->element_type),
                     llvm_type=gen_type(global, properties->element_type),
                     array=value
                 ]
@@ -235,12 +238,13 @@ static llvm_func_t gen_destructor(global_ctx_t& global, typecheck::expr_t const&
                 {
                     auto const element_ptr = builder.CreateLoad(gen_type(global, x.args[i].type), gep(i));
                     if (not is_trivially_destructible(global, x.args[i].type))
-                        gen_destructor_call(global, sigma_ctx, builder, element_ptr, x.args[i].type);
+                        gen_destructor_call(
+                            global, sigma_ctx, builder, element_ptr, global.intern_type(x.args[i].type));
                     auto const free = llvm::CallInst::CreateFree(element_ptr, builder.GetInsertBlock());
                     builder.GetInsertBlock()->getInstList().push_back(free);
                 }
                 else if (not is_trivially_destructible(global, x.args[i].type))
-                    gen_destructor_call(global, sigma_ctx, builder, gep(i), x.args[i].type);
+                    gen_destructor_call(global, sigma_ctx, builder, gep(i), global.intern_type(x.args[i].type));
             }
             assert(sigma_ctx.destructors.empty() and "destructors must not allocate");
         },
@@ -268,13 +272,14 @@ static void gen_destructor_call(
     local_ctx_t& local,
     llvm::IRBuilder<>& builder,
     llvm::Value* const value,
-    typecheck::expr_t const& type)
+    typecheck::interned_expr_t const type_id)
 {
-    auto destructor = global.get_destructor(type);
+    auto const& type = global.interned_type(type_id);
+    auto destructor = global.get_destructor(type_id);
     if (not destructor)
     {
         destructor = gen_destructor(global, type);
-        global.store_destructor(type, *destructor);
+        global.store_destructor(type_id, *destructor);
     }
     if (auto const properties = get_properties_if_array(type))
     {
@@ -1047,7 +1047,7 @@ llvm::Value* gen_func_call(
     // Conversely, if the constructed value is a result, it will be passed to the caller;
     // it is their responsibility to invoke the destructor when the returned value is no longer needed.
     if (value_category == value_category_t::temporary and not is_trivially_destructible(global, proto.ret_type()))
-        local.destructors.emplace_back(result, proto.ret_type());
+        local.destructors.emplace_back(result, global.intern_type(proto.ret_type()));
     return result;
 }
 
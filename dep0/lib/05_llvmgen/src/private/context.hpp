@@ -14,14 +14,15 @@
 
 #include "dep0/typecheck/ast.hpp"
 #include "dep0/typecheck/environment.hpp"
+#include "dep0/typecheck/expr_interner.hpp"
 
-#include "dep0/ast/hash_code.hpp"
 #include "dep0/scope_map.hpp"
 
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
 
+#include <unordered_map>
 #include <variant>
 
 #ifndef NDEBUG
@@ -77,11 +78,20 @@ struct global_ctx_t
     value_t* operator[](typecheck::expr_t::global_t const&);
     value_t const* operator[](typecheck::expr_t::global_t const&) const;
 
+    /**
+     * @brief Intern the given type, so that its destructor can then be looked up in constant time.
+     * @remarks A because-type is interned as its underlying value type, because they share the same destructor.
+     */
+    typecheck::interned_expr_t intern_type(typecheck::expr_t const&);
+
+    /** @brief Returns the type that was interned with the given ID. */
+    typecheck::expr_t const& interned_type(typecheck::interned_expr_t) const;
+
     /** @brief Returns the destructor for the given type, if one exists; otherwise `nullopt`. */
-    std::optional<llvm_func_t> get_destructor(typecheck::expr_t const& type) const;
+    std::optional<llvm_func_t> get_destructor(typecheck::interned_expr_t type) const;
 
-    /** @brief Store a new destructor for the given type and overwrites the old one if one already exists. */
-    void store_destructor(typecheck::expr_t type, llvm_func_t);
+    /** @brief Store a new destructor for the given type, unless one already exists. */
+    void store_destructor(typecheck::interned_expr_t type, llvm_func_t);
 
     /**
      * @brief Look up the LLVM global value stored for the given string literal.
@@ -120,8 +130,6 @@ struct global_ctx_t
     }
 
 private:
-    struct eq_t { bool operator()(typecheck::expr_t const&, typecheck::expr_t const&) const; };
-
     std::size_t next_id = 0ul; /**< @brief Next unique ID returned from `get_next_id()`. */
     scope_map<typecheck::expr_t::global_t, value_t> values; /**< @brief Global functions, type definitions, etc. */
 
@@ -134,11 +142,17 @@ private:
      */
     std::map<typecheck::expr_t::string_literal_t, llvm::Constant*> string_literals;
 
+    /** @brief Interns all types that might need a destructor, so that equivalent types share the same key. */
+    typecheck::expr_interner_t destructor_types;
+
+    /** @brief The interned element type of each interned array type, computed once when the array is interned. */
+    std::unordered_map<typecheck::interned_expr_t, typecheck::interned_expr_t> array_element_types;
+
     /** @brief Stores the destructor to invoke for a non-array type. */
-    std::unordered_map<typecheck::expr_t, llvm_func_t, std::hash<typecheck::expr_t>, eq_t> non_array_destructors;
+    std::unordered_map<typecheck::interned_expr_t, llvm_func_t> non_array_destructors;
 
     /** @brief Dedupe array destructors by passing the length as second argument and store them by element type. */
-    std::unordered_map<typecheck::expr_t, llvm_func_t, std::hash<typecheck::expr_t>, eq_t> array_destructors;
+    std::unordered_map<typecheck::interned_expr_t, llvm_func_t> array_destructors;
 };
 
 /**
@@ -187,10 +201,11 @@ struct local_ctx_t
     /**
      * @brief Values that need to be destructed before leaving the scope associated to this object.
      *
-     * Each value is stored alongside its original type and new values are appended at the end.
+     * Each value is stored alongside its type, interned by `global_ctx_t::intern_type()`,
+     * and new values are appended at the end.
      * If values need to be destroyed in reverse order it is the user responsibility to do so.
      */
-    std::vector<std::pair<llvm::Value*, typecheck::expr_t>> destructors;
+    std::vector<std::pair<llvm::Value*, typecheck::interned_expr_t>> destructors;
 
 private:
     struct entry_t
@@ -0,0 +1,33 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Single-function header declaring `dep0::llvmgen::func_cache_key()`.
+ */
+#pragma once
+
+#include "dep0/typecheck/ast.hpp"
+#include "dep0/typecheck/environment.hpp"
+
+#include <llvm/IR/Module.h>
+
+#include <string>
+
+namespace dep0::llvmgen {
+
+/**
+ * @brief Return the key under which the LLVM IR of the given function definition is stored in a `func_cache_t`.
+ *
+ * The key is a content hash of the function definition itself, of the llvmgen and LLVM builds that generate code,
+ * of the target of the given LLVM module and of everything else that the generated code depends on;
+ * that is the definition of all types and
+ * the signature of all functions that it refers to, either directly or indirectly via other types or signatures.
+ * The body of other functions is not part of the key, because calling a function only depends on its signature.
+ */
+std::string func_cache_key(typecheck::env_t const&, typecheck::func_def_t const&, llvm::Module const&);
+
+} // namespace dep0::llvmgen
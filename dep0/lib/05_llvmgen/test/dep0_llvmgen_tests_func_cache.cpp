@@ -0,0 +1,107 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_MODULE dep0_llvmgen_tests_func_cache
+#include <boost/test/included/unit_test.hpp>
+
+#include "llvmgen_tests_fixture.hpp"
+#include "llvm_helpers.hpp"
+#include "llvm_predicates.hpp"
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <filesystem>
+#include <iterator>
+#include <string>
+
+using namespace dep0::llvmgen::testing;
+
+static std::string make_cache_dir()
+{
+    llvm::SmallString<128> dir;
+    BOOST_TEST_REQUIRE(not llvm::sys::fs::createUniqueDirectory("dep0_llvmgen_tests_func_cache", dir));
+    return dir.str().str();
+}
+
+static long num_entries(std::string const& dir)
+{
+    return std::distance(std::filesystem::directory_iterator(dir), {});
+}
+
+BOOST_FIXTURE_TEST_SUITE(dep0_llvmgen_tests_func_cache, LLVMGenTestsFixture)
+
+BOOST_AUTO_TEST_CASE(hit_from_previous_run)
+{
+    auto const dir = make_cache_dir();
+    {
+        // populate the cache from a different LLVM context, as if it was a previous run of the compiler
+        LLVMGenTestsFixture previous_run;
+        previous_run.func_cache.emplace(dir);
+        BOOST_TEST_REQUIRE(previous_run.pass("0022_structs/pass_000.depc"));
+    }
+    BOOST_TEST(num_entries(dir) == 4l);
+    func_cache.emplace(dir);
+    BOOST_TEST_REQUIRE(pass("0022_structs/pass_000.depc"));
+    BOOST_TEST(num_entries(dir) == 4l);
+    std::filesystem::remove_all(dir);
+    auto const u = get_struct("u");
+    auto const v = get_struct("v");
+    BOOST_TEST(is_struct(v, "v", is_i32, exactly(u)));
+    for (auto const name: {"f0", "f1", "f2"})
+    {
+        auto const f = get_function(name);
+        BOOST_TEST_REQUIRE(f);
+        BOOST_TEST(not f->isDeclaration());
+    }
+    {
+        auto const f = get_function("f3");
+        BOOST_TEST_REQUIRE(is_function_of(f, std::tuple{ret_ptr_to(exactly(v))}, is_void));
+        BOOST_TEST_REQUIRE(f->size() == 1ul);
+        auto const inst = get_instructions(f->getEntryBlock());
+        BOOST_TEST_REQUIRE(inst.size() == 5ul);
+        BOOST_TEST(is_gep_of(inst[0], exactly(v), exactly(f->getArg(0)), constant(0), constant(0)));
+        BOOST_TEST(is_store_of(inst[1], is_i32, constant(2), exactly(inst[0]), align_of(4)));
+        BOOST_TEST(is_gep_of(inst[2], exactly(v), exactly(f->getArg(0)), constant(0), constant(1)));
+        BOOST_TEST(is_direct_call(inst[3], exactly(get_function("f1")), call_arg(exactly(inst[2]))));
+        BOOST_TEST(is_return_of_void(inst[4]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(hit_in_same_context)
+{
+    auto const dir = make_cache_dir();
+    func_cache.emplace(dir);
+    BOOST_TEST_REQUIRE(pass("0022_structs/pass_000.depc"));
+    BOOST_TEST(num_entries(dir) == 4l);
+    // by now the global context that produced the entries is gone, but its module and LLVM context are still alive
+    auto const first_module = std::move(pass_result.value());
+    pass_result.reset();
+    BOOST_TEST_REQUIRE(pass("0022_structs/pass_000.depc"));
+    BOOST_TEST(num_entries(dir) == 4l);
+    std::filesystem::remove_all(dir);
+    BOOST_TEST(not llvm::verifyModule(*pass_result.value(), &llvm::errs()));
+    for (auto const name: {"f0", "f1", "f2", "f3"})
+    {
+        auto const f = get_function(name);
+        BOOST_TEST_REQUIRE(f);
+        BOOST_TEST(not f->isDeclaration());
+        BOOST_TEST(f->getParent() == &*pass_result.value());
+    }
+    {
+        // the cached body must call the function of the new module, not the one of the first module
+        auto const f = get_function("f3");
+        BOOST_TEST_REQUIRE(f->size() == 1ul);
+        auto const inst = get_instructions(f->getEntryBlock());
+        BOOST_TEST_REQUIRE(inst.size() == 5ul);
+        BOOST_TEST(is_direct_call(inst[3], exactly(get_function("f1")), call_arg(exactly(inst[2]))));
+        BOOST_TEST(first_module->getFunction("f1") != get_function("f1"));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
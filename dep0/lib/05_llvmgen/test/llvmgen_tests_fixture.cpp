@@ -75,7 +75,8 @@ boost::test_tools::predicate_result LLVMGenTestsFixture::pass(std::filesystem::p
             return res;
         }
     }
-    auto gen_result = dep0::llvmgen::gen(llvm_ctx, "test.depc", *check_result, *machine);
+    auto gen_result =
+        dep0::llvmgen::gen(llvm_ctx, "test.depc", *check_result, *machine, func_cache ? &*func_cache : nullptr);
     if (gen_result.has_error())
     {
         auto res = boost::test_tools::predicate_result(false);
@@ -6,6 +6,8 @@
  */
 #pragma once
 
+#include "dep0/llvmgen/func_cache.hpp"
+
 #include "dep0/unique_ref.hpp"
 
 #include "dep0/testing/predicate.hpp"
@@ -26,6 +28,7 @@ struct LLVMGenTestsFixture
     llvm::LLVMContext llvm_ctx;
     std::optional<dep0::unique_ref<llvm::Module>> pass_result;
     bool apply_beta_delta_normalization = false;
+    std::optional<dep0::llvmgen::func_cache_t> func_cache;
     LLVMGenTestsFixture();
 
     boost::test_tools::predicate_result pass(std::filesystem::path);
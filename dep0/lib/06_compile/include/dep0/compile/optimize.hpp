@@ -0,0 +1,37 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Declares `dep0::compile::optimize()` and the optimization levels it supports.
+ */
+#pragma once
+
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+namespace dep0::compile {
+
+/** @brief Optimization levels, with the same meaning of the command line arguments `-O0`, `-O1`, etc. */
+enum class opt_level_t
+{
+    O0, /**< @brief Do not optimize at all. */
+    O1, /**< @brief Optimize quickly without destroying debuggability. */
+    O2, /**< @brief Optimize for fast execution as much as possible without triggering significant compile-time. */
+    O3  /**< @brief Optimize for fast execution as much as possible. */
+};
+
+/**
+ * @brief Run the standard LLVM optimization pipeline of the given level on the given module.
+ *
+ * The new pass manager is used with all target-specific analyses of the given target machine.
+ * Optimizing at level `O0` leaves the module untouched.
+ *
+ * @warning The module must have been verified, otherwise LLVM may crash.
+ */
+void optimize(llvm::Module&, llvm::TargetMachine&, opt_level_t) noexcept;
+
+} // namespace dep0::compile
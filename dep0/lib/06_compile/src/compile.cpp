@@ -1,11 +1,13 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
  */
 #include "dep0/compile/compile.hpp"
 
+#include "dep0/stats.hpp"
+
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/Support/CodeGen.h>
 #include <llvm/Support/FileSystem.h>
@@ -13,6 +15,10 @@
 
 namespace dep0::compile {
 
+static stats_counter_t num_assembly_files("compile", "assembly_files");
+static stats_counter_t num_object_files("compile", "object_files");
+static stats_counter_t num_bytes("compile", "bytes");
+
 static expected<temp_file_t>
 compile(llvm::Module& module, llvm::TargetMachine& machine, llvm::CodeGenFileType const output_file_type) noexcept
 {
@@ -28,6 +34,11 @@ compile(llvm::Module& module, llvm::TargetMachine& machine, llvm::CodeGenFileTyp
     if (machine.addPassesToEmitFile(pass_manager, ostream, nullptr, output_file_type))
         return dep0::error_t("cannot emit the desired file type for the target machine");
     pass_manager.run(module);
+    if (output_file_type == llvm::CodeGenFileType::CGFT_AssemblyFile)
+        num_assembly_files.add();
+    else
+        num_object_files.add();
+    num_bytes.add(ostream.tell());
     return temp_file;
 }
 
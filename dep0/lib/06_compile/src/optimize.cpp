@@ -0,0 +1,42 @@
+/*
+ * Copyright Raffaele Rossi 2023 - 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "dep0/compile/optimize.hpp"
+
+#include <llvm/Passes/PassBuilder.h>
+
+namespace dep0::compile {
+
+static llvm::PassBuilder::OptimizationLevel to_llvm(opt_level_t const level)
+{
+    switch (level)
+    {
+    case opt_level_t::O0: return llvm::PassBuilder::OptimizationLevel::O0;
+    case opt_level_t::O1: return llvm::PassBuilder::OptimizationLevel::O1;
+    case opt_level_t::O2: return llvm::PassBuilder::OptimizationLevel::O2;
+    default: return llvm::PassBuilder::OptimizationLevel::O3;
+    }
+}
+
+void optimize(llvm::Module& module, llvm::TargetMachine& machine, opt_level_t const level) noexcept
+{
+    if (level == opt_level_t::O0)
+        return;
+    // the order of declaration matters: analysis managers must be destroyed in the opposite order
+    llvm::LoopAnalysisManager lam;
+    llvm::FunctionAnalysisManager fam;
+    llvm::CGSCCAnalysisManager cgam;
+    llvm::ModuleAnalysisManager mam;
+    llvm::PassBuilder builder(&machine);
+    builder.registerModuleAnalyses(mam);
+    builder.registerCGSCCAnalyses(cgam);
+    builder.registerFunctionAnalyses(fam);
+    builder.registerLoopAnalyses(lam);
+    builder.crossRegisterProxies(lam, fam, cgam, mam);
+    builder.buildPerModuleDefaultPipeline(to_llvm(level)).run(module, mam);
+}
+
+} // namespace dep0::compile
@@ -0,0 +1,91 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_MODULE dep0_compile_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "dep0/compile/optimize.hpp"
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <memory>
+#include <string>
+
+struct fixture
+{
+    llvm::Triple const host = llvm::Triple(llvm::sys::getProcessTriple());
+    std::unique_ptr<llvm::TargetMachine> machine;
+    llvm::LLVMContext ctx;
+    llvm::Module module{"test", ctx};
+
+    fixture()
+    {
+        llvm::InitializeNativeTarget();
+        std::string err;
+        auto const target = llvm::TargetRegistry::lookupTarget(host.getTriple(), err);
+        BOOST_TEST_REQUIRE(target, err);
+        machine.reset(
+            target->createTargetMachine(
+                host.getTriple(), "generic", "", llvm::TargetOptions{}, llvm::Optional<llvm::Reloc::Model>()));
+        BOOST_TEST_REQUIRE(machine);
+        module.setTargetTriple(host.getTriple());
+        module.setDataLayout(machine->createDataLayout());
+        // internal function `i32 one()` returning 1, called by external function `i32 main()`
+        auto const i32 = llvm::Type::getInt32Ty(ctx);
+        auto const type = llvm::FunctionType::get(i32, false);
+        auto const one = llvm::Function::Create(type, llvm::Function::InternalLinkage, "one", module);
+        llvm::IRBuilder<> builder(llvm::BasicBlock::Create(ctx, "entry", one));
+        builder.CreateRet(llvm::ConstantInt::get(i32, 1));
+        auto const main = llvm::Function::Create(type, llvm::Function::ExternalLinkage, "main", module);
+        builder.SetInsertPoint(llvm::BasicBlock::Create(ctx, "entry", main));
+        builder.CreateRet(builder.CreateCall(one));
+        BOOST_TEST_REQUIRE(not llvm::verifyModule(module, &llvm::errs()));
+    }
+
+    std::string print() const
+    {
+        std::string str;
+        llvm::raw_string_ostream os(str);
+        module.print(os, nullptr);
+        return os.str();
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(dep0_compile_tests, fixture)
+
+BOOST_AUTO_TEST_CASE(O0_leaves_module_untouched)
+{
+    auto const before = print();
+    dep0::compile::optimize(module, *machine, dep0::compile::opt_level_t::O0);
+    BOOST_TEST(print() == before);
+}
+
+BOOST_AUTO_TEST_CASE(O2_folds_trivial_function)
+{
+    dep0::compile::optimize(module, *machine, dep0::compile::opt_level_t::O2);
+    BOOST_TEST_REQUIRE(not llvm::verifyModule(module, &llvm::errs()));
+    BOOST_TEST(module.getFunction("one") == nullptr); // inlined and then removed because internal and unused
+    auto const main = module.getFunction("main");
+    BOOST_TEST_REQUIRE(main);
+    BOOST_TEST_REQUIRE(main->size() == 1ul);
+    auto const ret = llvm::dyn_cast<llvm::ReturnInst>(main->getEntryBlock().getTerminator());
+    BOOST_TEST_REQUIRE(ret);
+    auto const value = llvm::dyn_cast_or_null<llvm::ConstantInt>(ret->getReturnValue());
+    BOOST_TEST_REQUIRE(value);
+    BOOST_TEST(value->getSExtValue() == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
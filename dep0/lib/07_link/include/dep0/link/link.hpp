@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -20,18 +20,39 @@
 
 namespace dep0::link {
 
+/** @brief Selects which linker is used by `link()`. */
+enum class linker_t
+{
+    /**
+     * @brief Link inside the compiler process itself, using the LLD library, which avoids spawning a new process.
+     * Only available if the compiler was built with LLD, see `has_in_process_linker()`.
+     */
+    in_process,
+
+    /** @brief Spawn the system linker `ld`, which must be found on the `PATH`. */
+    external
+};
+
+/** @brief Return true if the compiler was built with support for `linker_t::in_process`. */
+bool has_in_process_linker() noexcept;
+
+/** @brief Return `linker_t::in_process` if the compiler was built with LLD; otherwise `linker_t::external`. */
+linker_t default_linker() noexcept;
+
 /**
  * @brief Link all given object files into the final executable file.
  * @param object_files The paths to all object files to link together.
  * @param target The cpu-vendor-platform triple of the machine on which the executable will be run.
  * @param host The cpu-vendor-platform triple of the machine on which compilation is happening.
+ * @param linker Which linker to use; it is an error to request `linker_t::in_process` if it is not available.
  * @return A temporary file containing the final executable code.
  * @remarks It is the caller responsibility to keep the temporary file if required.
  */
 expected<temp_file_t> link(
     std::vector<std::filesystem::path> const& object_files,
     llvm::Triple target,
-    llvm::Triple host
+    llvm::Triple host,
+    linker_t linker = default_linker()
 ) noexcept;
 
 } // namespace dep0::link
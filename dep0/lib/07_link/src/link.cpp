@@ -1,5 +1,5 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
@@ -10,19 +10,36 @@
 
 namespace dep0::link {
 
+bool has_in_process_linker() noexcept
+{
+#ifdef DEP0_LINK_WITH_LLD
+    return true;
+#else
+    return false;
+#endif
+}
+
+linker_t default_linker() noexcept
+{
+    return has_in_process_linker() ? linker_t::in_process : linker_t::external;
+}
+
 expected<temp_file_t> link(
     std::vector<std::filesystem::path> const& object_files,
     llvm::Triple const target,
-    llvm::Triple const host
+    llvm::Triple const host,
+    linker_t const linker
 ) noexcept
 {
     using enum llvm::Triple::ArchType;
     using enum llvm::Triple::OSType;
     if (target != host)
         return error_t("cross-compilation not yet supported");
+    if (linker == linker_t::in_process and not has_in_process_linker())
+        return error_t("in-process linker not available, because the compiler was built without LLD");
     auto const arch_os = std::pair{target.getArch(), target.getOS()};
     if (arch_os == std::pair{x86_64, Linux})
-        return x86_64_linux::link(object_files);
+        return x86_64_linux::link(object_files, linker);
     return error_t("target triple not yet supported");
 }
 
@@ -10,6 +10,8 @@
  */
 #pragma once
 
+#include "dep0/link/link.hpp"
+
 #include "dep0/error.hpp"
 #include "dep0/temp_file.hpp"
 
@@ -18,7 +20,10 @@
 
 namespace dep0::link::x86_64_linux {
 
-/** @brief Link all given object files into a final executable for `x86_64-linux`. */
-expected<temp_file_t> link(std::vector<std::filesystem::path> const& object_files) noexcept;
+/**
+ * @brief Link all given object files into a final executable for `x86_64-linux`.
+ * @param linker Must be `linker_t::external` unless `has_in_process_linker()` is true.
+ */
+expected<temp_file_t> link(std::vector<std::filesystem::path> const& object_files, linker_t) noexcept;
 
 } // namespace dep0::link::x86_64_linux
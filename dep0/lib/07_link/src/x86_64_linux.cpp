@@ -1,39 +1,65 @@
 /*
- * Copyright Raffaele Rossi 2023 - 2024.
+ * Copyright Raffaele Rossi 2023 - 2025.
  *
  * Distributed under the Boost Software License, Version 1.0.
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
  */
 #include "private/x86_64_linux.hpp"
 
+#ifdef DEP0_LINK_WITH_LLD
+#include <lld/Common/Driver.h>
+#include <llvm/Support/raw_ostream.h>
+#endif
+
 #include <boost/process/v2/environment.hpp>
 #include <boost/process/v2/execute.hpp>
 #include <boost/process/v2/process.hpp>
 
 #include <algorithm>
+#include <cassert>
 #include <iomanip>
 #include <iterator>
 #include <sstream>
 #include <string>
 
+#ifdef DEP0_LINK_WITH_LLD
+#include <mutex>
+#endif
+
 namespace dep0::link::x86_64_linux {
 
-expected<temp_file_t> link(std::vector<std::filesystem::path> const& object_files) noexcept
+#ifdef DEP0_LINK_WITH_LLD
+/**
+ * Run LLD inside the current process with the given arguments, which do not include the program name.
+ * LLD keeps its state in global variables, so only one thread at a time can link.
+ */
+static expected<std::true_type> link_in_process(std::vector<std::string> const& args)
+{
+    static std::mutex mutex;
+    std::vector<char const*> argv;
+    argv.reserve(args.size() + 1ul);
+    argv.push_back("ld.lld");
+    for (auto const& x: args)
+        argv.push_back(x.c_str());
+    std::string out, err;
+    llvm::raw_string_ostream out_stream(out), err_stream(err);
+    bool ok;
+    {
+        auto const lock = std::scoped_lock(mutex);
+        ok = lld::elf::link(argv, /*canExitEarly*/ false, out_stream, err_stream);
+    }
+    if (not ok)
+        return error_t("in-process linker failed: " + err_stream.str());
+    return std::true_type{};
+}
+#endif
+
+/** Spawn the system linker with the given arguments, which do not include the program name. */
+static expected<std::true_type> link_external(std::vector<std::string> const& args)
 {
-    auto temp_file = make_temp_file();
     auto const ld = boost::process::v2::environment::find_executable("ld");
     if (ld.empty())
         return error_t("linker not found");
-    std::vector<std::string> args;
-    args.push_back("-o");
-    args.emplace_back(temp_file->path().native());
-    args.push_back("-dynamic-linker");
-    args.push_back("/lib64/ld-linux-x86-64.so.2");
-    args.push_back("/lib/x86_64-linux-gnu/crt1.o");
-    args.push_back("/lib/x86_64-linux-gnu/crti.o");
-    args.push_back("/lib/x86_64-linux-gnu/crtn.o");
-    std::ranges::copy(object_files, std::back_inserter(args));
-    args.push_back("-lc");
     auto const link_error = [&] (std::vector<error_t> reasons = {})
     {
         std::ostringstream err;
@@ -60,7 +86,36 @@ expected<temp_file_t> link(std::vector<std::filesystem::path> const& object_file
     else if (0 != *linker_result)
         return link_error();
     else
-        return temp_file;
+        return std::true_type{};
+}
+
+expected<temp_file_t> link(std::vector<std::filesystem::path> const& object_files, linker_t const linker) noexcept
+{
+    auto temp_file = make_temp_file();
+    std::vector<std::string> args;
+    args.push_back("-o");
+    args.emplace_back(temp_file->path().native());
+    args.push_back("-dynamic-linker");
+    args.push_back("/lib64/ld-linux-x86-64.so.2");
+    args.push_back("/lib/x86_64-linux-gnu/crt1.o");
+    args.push_back("/lib/x86_64-linux-gnu/crti.o");
+    args.push_back("/lib/x86_64-linux-gnu/crtn.o");
+    std::ranges::copy(object_files, std::back_inserter(args));
+#ifdef DEP0_LINK_WITH_LLD
+    // unlike `ld`, LLD does not know where the system libraries are, so we must tell it
+    if (linker == linker_t::in_process)
+        args.push_back("-L/lib/x86_64-linux-gnu");
+#endif
+    args.push_back("-lc");
+#ifdef DEP0_LINK_WITH_LLD
+    auto result = linker == linker_t::in_process ? link_in_process(args) : link_external(args);
+#else
+    assert(linker == linker_t::external and "built without support for in-process linking");
+    auto result = link_external(args);
+#endif
+    if (not result)
+        return std::move(result.error());
+    return temp_file;
 }
 
 } // namespace dep0::link::x86_64_linux
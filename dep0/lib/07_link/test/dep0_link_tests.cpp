@@ -0,0 +1,112 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_MODULE dep0_link_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "dep0/link/link.hpp"
+
+#include "dep0/compile/compile.hpp"
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include <sys/wait.h>
+
+struct fixture
+{
+    llvm::Triple const host = llvm::Triple(llvm::sys::getProcessTriple());
+    std::unique_ptr<llvm::TargetMachine> machine;
+
+    fixture()
+    {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        std::string err;
+        auto const target = llvm::TargetRegistry::lookupTarget(host.getTriple(), err);
+        BOOST_TEST_REQUIRE(target, err);
+        machine.reset(
+            target->createTargetMachine(
+                host.getTriple(), "generic", "", llvm::TargetOptions{}, llvm::Optional<llvm::Reloc::Model>()));
+        BOOST_TEST_REQUIRE(machine);
+    }
+
+    /** Return an object file whose only function is `int main()`, returning the given exit code. */
+    dep0::expected<dep0::temp_file_t> make_object_file(int const exit_code)
+    {
+        llvm::LLVMContext ctx;
+        llvm::Module module("main", ctx);
+        module.setTargetTriple(host.getTriple());
+        module.setDataLayout(machine->createDataLayout());
+        auto const i32 = llvm::Type::getInt32Ty(ctx);
+        auto const f =
+            llvm::Function::Create(
+                llvm::FunctionType::get(i32, false),
+                llvm::Function::ExternalLinkage,
+                "main",
+                module);
+        llvm::IRBuilder<> builder(llvm::BasicBlock::Create(ctx, "entry", f));
+        builder.CreateRet(llvm::ConstantInt::get(i32, exit_code));
+        return dep0::compile::compile_and_assemble(module, *machine);
+    }
+
+    /** Link a program that exits with the given code using the given linker, run it and return its exit status. */
+    dep0::expected<int> link_and_run(int const exit_code, dep0::link::linker_t const linker)
+    {
+        auto obj = make_object_file(exit_code);
+        if (not obj)
+            return std::move(obj.error());
+        auto exe = dep0::link::link({obj->path()}, host, host, linker);
+        if (not exe)
+            return std::move(exe.error());
+        auto const status = std::system(exe->path().c_str());
+        if (status == -1 or not WIFEXITED(status))
+            return dep0::error_t("executable did not exit normally");
+        return WEXITSTATUS(status);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(dep0_link_tests, fixture)
+
+BOOST_AUTO_TEST_CASE(external)
+{
+    auto const result = link_and_run(42, dep0::link::linker_t::external);
+    BOOST_TEST_REQUIRE(result.has_value());
+    BOOST_TEST(*result == 42);
+}
+
+BOOST_AUTO_TEST_CASE(in_process)
+{
+    auto const result = link_and_run(42, dep0::link::linker_t::in_process);
+    if (dep0::link::has_in_process_linker())
+    {
+        BOOST_TEST_REQUIRE(result.has_value());
+        BOOST_TEST(*result == 42);
+    }
+    else
+        BOOST_TEST(not result.has_value());
+}
+
+BOOST_AUTO_TEST_CASE(default_linker)
+{
+    auto const expected =
+        dep0::link::has_in_process_linker() ? dep0::link::linker_t::in_process : dep0::link::linker_t::external;
+    BOOST_TEST((dep0::link::default_linker() == expected));
+    auto const result = link_and_run(7, dep0::link::default_linker());
+    BOOST_TEST_REQUIRE(result.has_value());
+    BOOST_TEST(*result == 7);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,55 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+/**
+ * @file
+ * @brief Entry-point of the JIT stage, an alternative to the compile and link stages that runs the programme in-process.
+ */
+#pragma once
+
+#include "dep0/error.hpp"
+#include "dep0/unique_ref.hpp"
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dep0::jit {
+
+/**
+ * @brief An LLVM module together with the context it was generated in.
+ *
+ * The JIT may compile functions on a different thread than the one that generated them,
+ * so it must take ownership of the context as well, which cannot be shared with any other module.
+ */
+struct module_t
+{
+    std::unique_ptr<llvm::LLVMContext> context;
+    unique_ref<llvm::Module> module;
+};
+
+/**
+ * @brief JIT-compile all given modules inside the current process and call their `main` function.
+ *
+ * Functions are compiled lazily, only when they are first called, with the same target and options of `machine`,
+ * which must describe the host machine.
+ * Symbols that none of the modules define, for example those of `extern` declarations like `puts`,
+ * are resolved against the current process, which includes the C standard library.
+ *
+ * @param args The command line arguments passed to `main`, starting with the name of the programme.
+ * @return The value returned by `main` or an error if the modules could not be JIT-compiled or `main` is missing.
+ */
+expected<int> run(
+    std::vector<module_t>,
+    llvm::TargetMachine const& machine,
+    std::vector<std::string> const& args
+) noexcept;
+
+} // namespace dep0::jit
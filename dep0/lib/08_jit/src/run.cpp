@@ -0,0 +1,67 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "dep0/jit/run.hpp"
+
+#include <llvm/ExecutionEngine/JITSymbol.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/MC/SubtargetFeature.h>
+#include <llvm/Support/Error.h>
+
+#include <cstdint>
+
+namespace dep0::jit {
+
+static error_t to_error(std::string msg, llvm::Error err)
+{
+    return error_t(std::move(msg), {error_t(llvm::toString(std::move(err)))});
+}
+
+expected<int> run(
+    std::vector<module_t> modules,
+    llvm::TargetMachine const& machine,
+    std::vector<std::string> const& args
+) noexcept
+{
+    // generate code for the same target and options that the modules were generated and optimized for
+    auto target = llvm::orc::JITTargetMachineBuilder(machine.getTargetTriple());
+    target.setCPU(machine.getTargetCPU().str());
+    target.getFeatures() = llvm::SubtargetFeatures(machine.getTargetFeatureString());
+    target.setOptions(machine.Options);
+    target.setCodeGenOptLevel(machine.getOptLevel());
+    auto jit = llvm::orc::LLLazyJITBuilder().setJITTargetMachineBuilder(std::move(target)).create();
+    if (not jit)
+        return to_error("failed to create JIT", jit.takeError());
+    auto host = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+        (*jit)->getDataLayout().getGlobalPrefix());
+    if (not host)
+        return to_error("failed to load symbols of the current process", host.takeError());
+    (*jit)->getMainJITDylib().addGenerator(std::move(*host));
+    for (auto& m: modules)
+    {
+        auto module = llvm::orc::ThreadSafeModule(std::move(m.module).release(), std::move(m.context));
+        if (auto err = (*jit)->addLazyIRModule(std::move(module)))
+            return to_error("failed to add module to JIT", std::move(err));
+    }
+    auto main_symbol = (*jit)->lookup("main");
+    if (not main_symbol)
+        return to_error("cannot find function `main`", main_symbol.takeError());
+    // `main` takes either no arguments or `u64_t argc` and `array_t(cstr_t, argc) argv`;
+    // either way it is safe to pass both, as the C runtime does when running a linked executable
+    auto const main_func =
+        llvm::jitTargetAddressToFunction<std::int32_t (*)(std::uint64_t, char**)>(main_symbol->getAddress());
+    auto arg_storage = args;
+    std::vector<char*> argv;
+    for (auto& x: arg_storage)
+        argv.push_back(x.data());
+    argv.push_back(nullptr);
+    return main_func(arg_storage.size(), argv.data());
+}
+
+} // namespace dep0::jit
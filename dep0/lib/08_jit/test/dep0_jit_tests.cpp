@@ -0,0 +1,134 @@
+/*
+ * Copyright Raffaele Rossi 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_MODULE dep0_jit_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "dep0/jit/run.hpp"
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct fixture
+{
+    llvm::Triple const host = llvm::Triple(llvm::sys::getProcessTriple());
+    std::unique_ptr<llvm::TargetMachine> machine;
+
+    fixture()
+    {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        std::string err;
+        auto const target = llvm::TargetRegistry::lookupTarget(host.getTriple(), err);
+        BOOST_TEST_REQUIRE(target, err);
+        machine.reset(
+            target->createTargetMachine(
+                host.getTriple(), "generic", "", llvm::TargetOptions{}, llvm::Optional<llvm::Reloc::Model>()));
+        BOOST_TEST_REQUIRE(machine);
+    }
+
+    /** Return an empty module for the host machine, together with its own context. */
+    dep0::jit::module_t make_module(std::string const& name)
+    {
+        auto context = std::make_unique<llvm::LLVMContext>();
+        auto module = dep0::make_ref<llvm::Module>(name, *context);
+        module->setTargetTriple(host.getTriple());
+        module->setDataLayout(machine->createDataLayout());
+        return dep0::jit::module_t{std::move(context), std::move(module)};
+    }
+
+    /** Add to the given module a function `int main(u64_t argc, char** argv)` whose body is built by the given one. */
+    template <typename F>
+    void add_main(dep0::jit::module_t& m, F&& body)
+    {
+        auto& ctx = *m.context;
+        auto const i32 = llvm::Type::getInt32Ty(ctx);
+        auto const i64 = llvm::Type::getInt64Ty(ctx);
+        auto const argv_type = llvm::Type::getInt8PtrTy(ctx)->getPointerTo();
+        auto const f =
+            llvm::Function::Create(
+                llvm::FunctionType::get(i32, {i64, argv_type}, false),
+                llvm::Function::ExternalLinkage,
+                "main",
+                *m.module);
+        llvm::IRBuilder<> builder(llvm::BasicBlock::Create(ctx, "entry", f));
+        builder.CreateRet(body(builder, f->getArg(0), f->getArg(1)));
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(dep0_jit_tests, fixture)
+
+BOOST_AUTO_TEST_CASE(exit_code)
+{
+    auto m = make_module("main");
+    add_main(m, [] (llvm::IRBuilder<>& builder, llvm::Value*, llvm::Value*)
+    {
+        return builder.getInt32(42);
+    });
+    std::vector<dep0::jit::module_t> modules;
+    modules.push_back(std::move(m));
+    auto const result = dep0::jit::run(std::move(modules), *machine, {"test"});
+    BOOST_TEST_REQUIRE(result.has_value());
+    BOOST_TEST(*result == 42);
+}
+
+BOOST_AUTO_TEST_CASE(arguments_and_extern)
+{
+    // return `argc + atoi(argv[1])`, where `atoi` must be resolved from the current process
+    auto m = make_module("main");
+    add_main(m, [&] (llvm::IRBuilder<>& builder, llvm::Value* const argc, llvm::Value* const argv)
+    {
+        auto& ctx = builder.getContext();
+        auto const i8_ptr = llvm::Type::getInt8PtrTy(ctx);
+        auto const atoi =
+            m.module->getOrInsertFunction("atoi", llvm::FunctionType::get(builder.getInt32Ty(), {i8_ptr}, false));
+        auto const arg1 = builder.CreateLoad(i8_ptr, builder.CreateConstGEP1_64(i8_ptr, argv, 1ul));
+        return builder.CreateAdd(builder.CreateTrunc(argc, builder.getInt32Ty()), builder.CreateCall(atoi, {arg1}));
+    });
+    std::vector<dep0::jit::module_t> modules;
+    modules.push_back(std::move(m));
+    auto const result = dep0::jit::run(std::move(modules), *machine, {"test", "40"});
+    BOOST_TEST_REQUIRE(result.has_value());
+    BOOST_TEST(*result == 42);
+}
+
+BOOST_AUTO_TEST_CASE(function_of_another_module)
+{
+    auto lib = make_module("lib");
+    auto const i32 = llvm::Type::getInt32Ty(*lib.context);
+    auto const f =
+        llvm::Function::Create(llvm::FunctionType::get(i32, false), llvm::Function::ExternalLinkage, "f", *lib.module);
+    llvm::IRBuilder<>(llvm::BasicBlock::Create(*lib.context, "entry", f)).CreateRet(llvm::ConstantInt::get(i32, 7));
+    auto m = make_module("main");
+    add_main(m, [&] (llvm::IRBuilder<>& builder, llvm::Value*, llvm::Value*)
+    {
+        return builder.CreateCall(m.module->getOrInsertFunction("f", builder.getInt32Ty()));
+    });
+    std::vector<dep0::jit::module_t> modules;
+    modules.push_back(std::move(lib));
+    modules.push_back(std::move(m));
+    auto const result = dep0::jit::run(std::move(modules), *machine, {"test"});
+    BOOST_TEST_REQUIRE(result.has_value());
+    BOOST_TEST(*result == 7);
+}
+
+BOOST_AUTO_TEST_CASE(missing_main)
+{
+    std::vector<dep0::jit::module_t> modules;
+    modules.push_back(make_module("main"));
+    BOOST_TEST(not dep0::jit::run(std::move(modules), *machine, {"test"}).has_value());
+}
+
+BOOST_AUTO_TEST_SUITE_END()